@@ -0,0 +1,96 @@
+/*!
+    \file "GatCrc16Bench.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Microbenchmark of the GAT CRC-16 implementations (reports GB/s, and checks they agree).
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatCrc16.hpp"
+#include <QElapsedTimer>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+
+size_t const bulkSize = 64u << 20; // Bytes (a captured traffic archive).
+uint const bulkRepetitions = 8;
+uint const packetRepetitions = 200000;
+
+
+static double
+measure(gat_crc16_function_type crc16, uint8_t const *data, size_t dataSize, uint repetitions, uint16_t &crc)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (uint idx = 0; repetitions > idx; ++idx)
+    {
+        crc = crc16(data, dataSize, static_cast<uint16_t>(0xffff ^ crc)); // Chained so it cannot be hoisted.
+    }
+    qint64 const nanoseconds = (std::max)(static_cast<qint64>(1), timer.nsecsElapsed());
+    return static_cast<double>(dataSize) * repetitions / nanoseconds; // Bytes per nanosecond (GB/s).
+}
+
+
+int
+main(int /*argc*/, char * /*argv*/[])
+{
+    std::vector<uint8_t> data(bulkSize);
+    srand(1);
+    for (size_t idx = 0; data.size() > idx; ++idx)
+    {
+        data[idx] = static_cast<uint8_t>(rand());
+    }
+
+    printf("Selected: %s\n", gatCrc16ImplName(gatCrc16SelectedImpl()));
+    printf("%-12s %14s %14s\n", "impl", "64MiB GB/s", "255B GB/s");
+
+    int result = EXIT_SUCCESS;
+    uint16_t reference[2] = { 0, 0 };
+    for (size_t idx = 0; gatCrc16Impl_Count - 1 > idx; ++idx)
+    {
+        GatCrc16Impl const impl = static_cast<GatCrc16Impl>(idx);
+        gat_crc16_function_type const crc16 = gatCrc16Function(impl);
+        if (nullptr == crc16)
+        {
+            printf("%-12s %14s\n", gatCrc16ImplName(impl), "unsupported");
+            continue;
+        }
+
+        uint16_t crc[2] = { 0, 0 };
+        double const bulkRate = measure(crc16, &data[0], data.size(), bulkRepetitions, crc[0]);
+        double const packetRate = measure(crc16, &data[1], GAT_MAX_PACKET_SIZE, packetRepetitions, crc[1]);
+        printf("%-12s %14.3f %14.3f\n", gatCrc16ImplName(impl), bulkRate, packetRate);
+
+        // Every implementation must be bit-exact with the byte table (the first one).
+        if (GatCrc16Impl::Bytewise == impl)
+        {
+            reference[0] = crc[0];
+            reference[1] = crc[1];
+        }
+        else if (reference[0] != crc[0] || reference[1] != crc[1])
+        {
+            printf("%-12s MISMATCH (%04x %04x, expected %04x %04x)\n", gatCrc16ImplName(impl), crc[0], crc[1],
+                   reference[0], reference[1]);
+            result = EXIT_FAILURE;
+        }
+    }
+
+    return result;
+}
+
+
+/*
+    End of "GatCrc16Bench.cpp"
+*/
@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# GAT CRC-16 microbenchmark (console; not part of GatHost): qmake && make && ./GatCrc16Bench
+#
+#-------------------------------------------------
+
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = GatCrc16Bench
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+QMAKE_CXXFLAGS += -std=c++0x -O2
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    GatCrc16Bench.cpp \
+    ../GatCrc16.cpp
+
+HEADERS += \
+    ../Defs.hpp \
+    ../GatCrc16.hpp
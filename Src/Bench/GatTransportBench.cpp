@@ -0,0 +1,342 @@
+/*!
+    \file "GatTransportBench.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Benchmark of the serial transports (QSerialPort, termios/epoll, io_uring) over many ports: each port opens the
+    slave of a pseudo terminal whose master is answered by a simulated GM in a child process, so the CPU time, context
+    switches and system calls measured here are those of the host alone.  Reports them per packet (requests and
+    replies).  Usage: GatTransportBench [ports [rounds]]
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatHost.hpp"
+#include "GatPktCodec.hpp"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <vector>
+#include <linux/perf_event.h>
+#include <poll.h>
+#include <pty.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+
+uint const defaultPortCount = 32;
+uint const defaultRoundCount = 100;
+uint const roundTimeoutInMilliseconds = 5000; // Far beyond any GAT deadline.
+
+
+/*!
+    Simulated GMs (child process): answers each SQ on any of the masters with an idle SR, at once.  Never returns.
+*/
+static void
+runFakeGms(std::vector<int> const &masterFds)
+{
+    std::vector<pollfd> pollFds(masterFds.size());
+    std::vector<std::vector<uint8_t> > received(masterFds.size());
+    for (size_t idx = 0; masterFds.size() > idx; ++idx)
+    {
+        pollFds[idx].fd = masterFds[idx];
+        pollFds[idx].events = POLLIN;
+    }
+
+    for (;;) // Until killed.
+    {
+        if (0 >= poll(&pollFds[0], pollFds.size(), -1)) { continue; }
+        for (size_t idx = 0; pollFds.size() > idx; ++idx)
+        {
+            if (0 == (POLLIN & pollFds[idx].revents)) { continue; }
+
+            uint8_t buffer[GAT_MAX_PACKET_SIZE];
+            ssize_t const byteCount = read(masterFds[idx], buffer, sizeof(buffer));
+            if (0 >= byteCount) { continue; }
+            std::vector<uint8_t> &requests = received[idx];
+            requests.insert(requests.end(), buffer, buffer + byteCount);
+
+            while (2 <= requests.size() && requests[1] <= requests.size())
+            {
+                size_t const requestSize = requests[1];
+                if (GatPktFrameCodec::overhead > requestSize) { requests.clear(); break; }
+                if (GatRqstCmd::SQ == requests[0])
+                {
+                    uint8_t const payload[] = { 0x01, 0x00, 0x00, 0x00 }; // Version 1.00, idle, no data formats.
+                    uint8_t packet[GAT_MAX_PACKET_SIZE];
+                    size_t const packetSize = GatPktFrameCodec::encode(packet, GatPktDesc_SR::command,
+                                                                       payload, sizeof(payload));
+                    if (static_cast<ssize_t>(packetSize) != write(masterFds[idx], packet, packetSize)) { _exit(1); }
+                }
+                requests.erase(requests.begin(), requests.begin() + requestSize);
+            }
+        }
+    }
+}
+
+
+/*!
+    \brief Counts the system calls of this process (all threads created after 'open()') with a perf tracepoint.
+
+    Needs a kernel that lets this user trace (see /proc/sys/kernel/perf_event_paranoid); otherwise not 'isOpen()',
+    and 'strace -f -c' is the way to count them.
+*/
+class SyscallCounter
+{
+public:
+    bool open();
+    bool isOpen() const { return 0 <= fd_; }
+    void start();
+    void stop();
+    quint64 count() const; //!< Read once the threads counted have ended (their counts are added as they end).
+
+    SyscallCounter() : fd_(-1) {}
+    ~SyscallCounter() { if (isOpen()) { close(fd_); } }
+
+private:
+    int fd_;
+};
+
+
+bool
+SyscallCounter::open()
+{
+    char const *idPathnames[] = { "/sys/kernel/tracing/events/raw_syscalls/sys_enter/id",
+                                  "/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id" };
+    unsigned long long tracepointId = 0;
+    for (size_t idx = 0; arycap(idPathnames) > idx && 0 == tracepointId; ++idx)
+    {
+        FILE *file = fopen(idPathnames[idx], "r");
+        if (nullptr == file) { continue; }
+        if (1 != fscanf(file, "%llu", &tracepointId)) { tracepointId = 0; }
+        fclose(file);
+    }
+    if (0 == tracepointId) { return false; }
+
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_TRACEPOINT;
+    attr.config = tracepointId;
+    attr.disabled = 1;
+    attr.inherit = 1; // The host thread, and any it starts.
+    fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    return isOpen();
+}
+
+
+void
+SyscallCounter::start()
+{
+    if (!isOpen()) { return; }
+    ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+
+void
+SyscallCounter::stop()
+{
+    if (isOpen()) { ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0); }
+}
+
+
+quint64
+SyscallCounter::count() const
+{
+    quint64 value = 0;
+    if (!isOpen() || static_cast<ssize_t>(sizeof(value)) != read(fd_, &value, sizeof(value))) { return 0; }
+    return value;
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+static char const *
+transportName(GatPort::Transport transport)
+{
+    switch (transport)
+    {
+    case GatPort::Transport::QtSerialPort: return "QSerialPort";
+    case GatPort::Transport::TermiosEpoll: return "termios/epoll";
+    case GatPort::Transport::IoUring: return "io_uring";
+    default: return "?";
+    }
+}
+
+
+static qint64
+cpuTimeInMicroseconds(rusage const &usage)
+{
+    return (static_cast<qint64>(usage.ru_utime.tv_sec) + usage.ru_stime.tv_sec) * 1000000
+            + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+
+//! One status query on every port, run concurrently; returns whether all completed.
+static bool
+runRound(GatHost &host)
+{
+    GatCmdFuture::futures_type futures;
+    for (size_t idx = 0; host.portCount() > idx; ++idx)
+    {
+        futures.push_back(host.schedule(GatHost::gat_host_cmd_ptr_type(new GatHostStatusQueryCmd(host.port(idx)))));
+    }
+    GatCmdFuture const all = GatCmdFuture::whenAll(futures);
+    return all.wait(roundTimeoutInMilliseconds) && GatHostCmd::CmdState::Completed == all.result();
+}
+
+
+static bool
+bench(GatPort::Transport transport, QStringList const &serialDevicePathnames, uint roundCount)
+{
+    SyscallCounter syscalls;
+    syscalls.open(); // Before the host thread starts (so it is counted).
+
+    GatHost host;
+    host.createPorts(static_cast<size_t>(serialDevicePathnames.size()));
+    for (size_t idx = 0; host.portCount() > idx; ++idx)
+    {
+        host.port(idx).setTransport(transport);
+    }
+    host.startup(serialDevicePathnames);
+
+    if (!runRound(host)) // Warm up (opens the ports, calibrates the reply timing); not measured.
+    {
+        host.shutdown(true);
+        printf("%-14s unavailable (not built in, or the ports failed to open)\n", transportName(transport));
+        return false;
+    }
+
+    rusage usageBefore, usageAfter;
+    QElapsedTimer timer;
+    bool completed = true;
+    syscalls.start();
+    getrusage(RUSAGE_SELF, &usageBefore);
+    timer.start();
+    for (uint round = 0; roundCount > round && completed; ++round)
+    {
+        completed = runRound(host);
+    }
+    qint64 const elapsedInMilliseconds = timer.elapsed();
+    getrusage(RUSAGE_SELF, &usageAfter);
+    syscalls.stop();
+    host.shutdown(true);
+
+    if (!completed)
+    {
+        printf("%-14s failed (a status query did not complete)\n", transportName(transport));
+        return false;
+    }
+
+    double const packetCount = 2.0 * host.portCount() * roundCount; // Each SQ and its SR.
+    qint64 const contextSwitches = (usageAfter.ru_nvcsw - usageBefore.ru_nvcsw)
+                                   + (usageAfter.ru_nivcsw - usageBefore.ru_nivcsw);
+    char syscallsPerPacket[32] = "n/a";
+    if (syscalls.isOpen())
+    {
+        snprintf(syscallsPerPacket, sizeof(syscallsPerPacket), "%.2f", syscalls.count() / packetCount);
+    }
+    char submitsPerPacket[32] = "-";
+    if (GatPort::Transport::IoUring == transport) // Includes the warm up round.
+    {
+        GatUringEngine::Statistics const &statistics = host.uringEngine().statistics();
+        snprintf(submitsPerPacket, sizeof(submitsPerPacket), "%.2f",
+                 statistics.submitCallCount_ / (packetCount * (roundCount + 1) / roundCount));
+    }
+
+    printf("%-14s %10.1f %10.2f %10s %10s %10.1f\n", transportName(transport),
+           (cpuTimeInMicroseconds(usageAfter) - cpuTimeInMicroseconds(usageBefore)) / packetCount,
+           contextSwitches / packetCount, syscallsPerPacket, submitsPerPacket,
+           packetCount * 1000.0 / (std::max)(static_cast<qint64>(1), elapsedInMilliseconds));
+    return true;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    uint const portCount = (1 < argc) ? static_cast<uint>(atoi(argv[1])) : defaultPortCount;
+    uint const roundCount = (2 < argc) ? static_cast<uint>(atoi(argv[2])) : defaultRoundCount;
+    if (0 == portCount || 0 == roundCount)
+    {
+        fprintf(stderr, "Usage: %s [ports [rounds]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Every pseudo terminal is opened before the simulated GMs fork off (the slaves stay open here throughout, so a
+    // port closing one between transports does not hang it up).
+    std::vector<int> masterFds, slaveFds;
+    QStringList serialDevicePathnames;
+    for (uint idx = 0; portCount > idx; ++idx)
+    {
+        int masterFd = -1, slaveFd = -1;
+        char slaveName[128];
+        termios tty;
+        if (0 != openpty(&masterFd, &slaveFd, slaveName, nullptr, nullptr) || 0 != tcgetattr(slaveFd, &tty))
+        {
+            fprintf(stderr, "No pseudo terminal for port %u\n", idx);
+            return EXIT_FAILURE;
+        }
+        cfmakeraw(&tty);
+        tcsetattr(slaveFd, TCSANOW, &tty);
+        masterFds.push_back(masterFd);
+        slaveFds.push_back(slaveFd);
+        serialDevicePathnames << QString::fromLocal8Bit(slaveName);
+    }
+
+    pid_t const fakeGmsPid = fork();
+    if (0 > fakeGmsPid) { return EXIT_FAILURE; }
+    if (0 == fakeGmsPid)
+    {
+        runFakeGms(masterFds);
+    }
+    for (size_t idx = 0; masterFds.size() > idx; ++idx)
+    {
+        close(masterFds[idx]);
+    }
+
+    QCoreApplication application(argc, argv);
+
+    printf("%u ports, %u rounds (one status query per port per round)\n", portCount, roundCount);
+    printf("%-14s %10s %10s %10s %10s %10s\n", "transport", "CPU us/pkt", "csw/pkt", "sys/pkt", "submit/pkt",
+           "pkt/s");
+
+    int result = EXIT_SUCCESS;
+    GatPort::Transport const transports[] = { GatPort::Transport::QtSerialPort, GatPort::Transport::TermiosEpoll,
+                                              GatPort::Transport::IoUring };
+    for (size_t idx = 0; arycap(transports) > idx; ++idx)
+    {
+        if (!bench(transports[idx], serialDevicePathnames, roundCount)) { result = EXIT_FAILURE; }
+    }
+
+    kill(fakeGmsPid, SIGTERM);
+    waitpid(fakeGmsPid, nullptr, 0);
+    for (size_t idx = 0; slaveFds.size() > idx; ++idx)
+    {
+        close(slaveFds[idx]);
+    }
+    return result;
+}
+
+
+/*
+    End of "GatTransportBench.cpp"
+*/
@@ -0,0 +1,76 @@
+#-------------------------------------------------
+#
+# Serial transport benchmark over many pseudo terminals (console; not part of GatHost):
+# qmake CONFIG+=gat_io_uring && make && ./GatTransportBench [ports [rounds]]
+#
+#-------------------------------------------------
+
+QT       += core gui xml
+
+lessThan(QT_MAJOR_VERSION, 5): CONFIG += serialport
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets serialport
+
+TARGET = GatTransportBench
+TEMPLATE = app
+CONFIG += console thread
+CONFIG -= app_bundle
+
+QMAKE_CXXFLAGS += -std=c++0x -O2
+LIBS += -pthread -lutil
+
+INCLUDEPATH += ..
+
+# io_uring serial transport (GatPort::Transport::IoUring) requires liburing: qmake CONFIG+=gat_io_uring
+gat_io_uring {
+    DEFINES += ENABLE_GAT_IO_URING
+    LIBS += -luring
+}
+
+SOURCES += \
+    GatTransportBench.cpp \
+    ../GatHost.cpp \
+    ../GatLinkLayer.cpp \
+    ../GatBuffer.cpp \
+    ../GatCoroutine.cpp \
+    ../Defs.cpp \
+    ../GatCrc16.cpp \
+    ../GatMultipktRply.cpp \
+    ../GatSpecialFunctionExec.cpp \
+    ../GatSpecialFunctionsDecoder.cpp \
+    ../GatStatusPollPolicy.cpp \
+    ../GatStatusQueryCoalescer.cpp \
+    ../GatCalcDurationModel.cpp \
+    ../GatPkt_StatusQueryRslt_SR81.cpp \
+    ../GatPktCodec.cpp \
+    ../GatReplyTimingModel.cpp \
+    ../GatSerialLineSettings.cpp \
+    ../GatSerialLowLatency.cpp \
+    ../GatEpollReactor.cpp \
+    ../GatTermiosSerialPort.cpp \
+    ../GatTimerFd.cpp \
+    ../GatUringEngine.cpp \
+    ../GatUringSerialPort.cpp
+
+HEADERS += \
+    ../Defs.hpp \
+    ../GatHost.hpp \
+    ../GatLinkLayer.hpp \
+    ../GatBuffer.hpp \
+    ../GatCoroutine.hpp \
+    ../GatCrc16.hpp \
+    ../GatMultipktRply.hpp \
+    ../GatSpecialFunctionExec.hpp \
+    ../GatSpecialFunctionsDecoder.hpp \
+    ../GatStatusPollPolicy.hpp \
+    ../GatStatusQueryCoalescer.hpp \
+    ../GatCalcDurationModel.hpp \
+    ../GatPkt_StatusQueryRslt_SR81.hpp \
+    ../GatPktCodec.hpp \
+    ../GatReplyTimingModel.hpp \
+    ../GatSerialLineSettings.hpp \
+    ../GatSerialLowLatency.hpp \
+    ../GatEpollReactor.hpp \
+    ../GatTermiosSerialPort.hpp \
+    ../GatTimerFd.hpp \
+    ../GatUringEngine.hpp \
+    ../GatUringSerialPort.hpp
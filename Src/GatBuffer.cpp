@@ -0,0 +1,241 @@
+/*!
+    \file "GatBuffer.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Reference counted packet buffers (slab pool), and views/chains of their content.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatBuffer.hpp"
+#include <QMutexLocker>
+#include <string.h>
+
+
+GatBufferPool&
+GatBufferPool::instance()
+{
+    // Never destroyed: buffers may still be released while static objects are being destroyed at exit.
+    static GatBufferPool *pool = new GatBufferPool;
+    return *pool;
+}
+
+
+GatBuffer
+GatBufferPool::allocate()
+{
+    QMutexLocker guardLock(&guard_);
+
+    if (nullptr == freeList_)
+    {
+        std::unique_ptr<Block[]> slab(new Block[blocksPerSlab]);
+        for (size_t index = 0; blocksPerSlab > index; ++index)
+        {
+            slab[index].nextFree_ = freeList_;
+            freeList_ = &slab[index];
+        }
+        slabs_.push_back(std::move(slab));
+        freeBlockCount_ += blocksPerSlab;
+    }
+
+    Block *block = freeList_;
+    freeList_ = block->nextFree_;
+    --freeBlockCount_;
+    block->nextFree_ = nullptr;
+    block->refCount_.ref();
+
+    return GatBuffer(block);
+}
+
+
+void
+GatBufferPool::release(Block *block)
+{
+    QMutexLocker guardLock(&guard_);
+
+    block->nextFree_ = freeList_;
+    freeList_ = block;
+    ++freeBlockCount_;
+}
+
+
+uint
+GatBufferPool::blockCount() const
+{
+    QMutexLocker guardLock(&guard_);
+
+    return static_cast<uint>(slabs_.size() * blocksPerSlab);
+}
+
+
+uint
+GatBufferPool::freeBlockCount() const
+{
+    QMutexLocker guardLock(&guard_);
+
+    return freeBlockCount_;
+}
+
+
+GatBufferPool::GatBufferPool()
+    : freeList_(nullptr)
+    , freeBlockCount_(0)
+{
+    // Do nothing.
+}
+
+
+GatBufferPool::~GatBufferPool()
+{
+    // Do nothing.
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+GatBuffer::GatBuffer(GatBuffer const &other)
+    : block_(other.block_)
+{
+    if (nullptr != block_) { block_->refCount_.ref(); }
+}
+
+
+GatBuffer::~GatBuffer()
+{
+    if (nullptr != block_ && !block_->refCount_.deref()) { GatBufferPool::instance().release(block_); }
+}
+
+
+GatBuffer&
+GatBuffer::operator=(GatBuffer const &other)
+{
+    GatBuffer copy(other);
+    std::swap(block_, copy.block_);
+    return *this;
+}
+
+
+GatBuffer&
+GatBuffer::operator=(GatBuffer &&other)
+{
+    std::swap(block_, other.block_);
+    return *this;
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+GatByteView
+GatByteView::mid(uint offset, uint size) const
+{
+    offset = (std::min)(offset, size_);
+    size = (std::min)(size, size_ - offset);
+    return GatByteView(buffer_, offset_ + offset, size);
+}
+
+
+QByteArray
+GatByteView::toByteArray() const
+{
+    Q_ASSERT(sizeof(char) == sizeof(uint8_t));
+    return isEmpty() ? QByteArray() : QByteArray(reinterpret_cast<char const *>(data()), static_cast<int>(size_));
+}
+
+
+GatByteView::GatByteView(GatBuffer const &buffer, uint offset, uint size)
+    : buffer_(buffer)
+    , offset_((std::min)(static_cast<size_t>(offset), GatBuffer::capacity()))
+    , size_((std::min)(static_cast<size_t>(size), GatBuffer::capacity() - offset_))
+{
+    if (buffer_.isNull()) { offset_ = size_ = 0; }
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+void
+GatByteChain::append(GatByteView const &view)
+{
+    if (view.isEmpty()) { return; }
+    views_.push_back(view);
+    size_ += view.size();
+}
+
+
+void
+GatByteChain::append(GatByteChain const &chain)
+{
+    views_.insert(views_.end(), chain.views_.begin(), chain.views_.end());
+    size_ += chain.size_;
+}
+
+
+void
+GatByteChain::clear()
+{
+    views_.clear();
+    size_ = 0;
+}
+
+
+size_t
+GatByteChain::copyTo(void *destination, size_t capacity) const
+{
+    uint8_t *out = static_cast<uint8_t *>(destination);
+    size_t copied = 0;
+    for (views_type::const_iterator view = views_.begin(); views_.end() != view && capacity > copied; ++view)
+    {
+        size_t const count = (std::min)(static_cast<size_t>(view->size()), capacity - copied);
+        memcpy(out + copied, view->data(), count);
+        copied += count;
+    }
+    return copied;
+}
+
+
+QByteArray
+GatByteChain::toByteArray() const
+{
+    if (1 == views_.size()) { return views_.front().toByteArray(); }
+
+    QByteArray result;
+    result.resize(static_cast<int>(size_));
+    copyTo(result.data(), size_);
+    return result;
+}
+
+
+GatByteChain
+GatByteChain::fromData(void const *data, size_t dataSize)
+{
+    GatByteChain chain;
+    uint8_t const *in = static_cast<uint8_t const *>(data);
+    while (nullptr != in && 0 < dataSize)
+    {
+        GatBuffer buffer(GatBufferPool::instance().allocate());
+        uint const count = static_cast<uint>((std::min)(dataSize, GatBuffer::capacity()));
+        memcpy(buffer.data(), in, count);
+        chain.append(GatByteView(buffer, 0, count));
+        in += count;
+        dataSize -= count;
+    }
+    return chain;
+}
+
+
+/*
+    End of "GatBuffer.cpp"
+*/
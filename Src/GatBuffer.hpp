@@ -0,0 +1,172 @@
+/*!
+    \file "GatBuffer.hpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Reference counted packet buffers (slab pool), and views/chains of their content.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#ifndef GATBUFFER_HPP__D2FCA503_6FF3_49DF_AE3D_D90364EB4527__INCLUDED
+#define GATBUFFER_HPP__D2FCA503_6FF3_49DF_AE3D_D90364EB4527__INCLUDED
+
+
+#pragma once
+
+
+#include "Defs.hpp"
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QMutex>
+#include <memory>
+#include <vector>
+
+
+class GatBuffer;
+
+
+/*!
+    \brief Pool of packet sized blocks, allocated a slab (of blocks) at a time and never returned to the heap.
+
+    Received data is written once, into a block, and everything downstream holds a reference to the block (via
+    'GatBuffer' or 'GatByteView') instead of a copy.  A block returns to the pool when its last reference goes away,
+    which may happen on any thread (e.g. the UI thread releasing a command's results).
+*/
+class GatBufferPool
+{
+public:
+    static size_t const blockSize = GAT_MAX_PACKET_SIZE;
+    static size_t const blocksPerSlab = 32;
+
+    static GatBufferPool& instance(); //!< Process wide pool.
+
+    GatBuffer allocate();
+
+    uint blockCount() const; //!< Allocated from the heap (in use + free).
+    uint freeBlockCount() const;
+
+    GatBufferPool();
+    ~GatBufferPool();
+
+private:
+    friend class GatBuffer;
+
+    struct Block
+    {
+        QAtomicInt refCount_;
+        Block *nextFree_;
+        uint8_t data_[blockSize];
+    };
+
+    void release(Block *block); //!< Last reference went away.
+
+    mutable QMutex guard_;
+    std::vector<std::unique_ptr<Block[]>> slabs_;
+    Block *freeList_;
+    uint freeBlockCount_;
+
+    GatBufferPool(GatBufferPool const&) = delete; //!< No cloning; leave unimplemented!
+    GatBufferPool& operator=(GatBufferPool const&) = delete; //!< No cloning; leave unimplemented!
+};
+
+
+/*!
+    \brief Reference to one block of a 'GatBufferPool' (like a shared pointer); null by default.
+*/
+class GatBuffer
+{
+public:
+    bool isNull() const { return nullptr == block_; }
+    bool isShared() const { return nullptr != block_ && 1 < block_->refCount_.load(); } //!< Not safe to write.
+    uint8_t * data() { return nullptr != block_ ? block_->data_ : nullptr; }
+    uint8_t const * data() const { return nullptr != block_ ? block_->data_ : nullptr; }
+    static size_t capacity() { return GatBufferPool::blockSize; }
+
+    GatBuffer() : block_(nullptr) {}
+    GatBuffer(GatBuffer const &other);
+    GatBuffer(GatBuffer &&other) : block_(other.block_) { other.block_ = nullptr; }
+    ~GatBuffer();
+
+    GatBuffer& operator=(GatBuffer const &other);
+    GatBuffer& operator=(GatBuffer &&other);
+
+private:
+    friend class GatBufferPool;
+
+    explicit GatBuffer(GatBufferPool::Block *block) : block_(block) {} // Adopts the (first) reference.
+
+    GatBufferPool::Block *block_;
+};
+
+
+/*!
+    \brief Read only view of part of a 'GatBuffer' (keeps the buffer alive).
+*/
+class GatByteView
+{
+public:
+    uint8_t const * data() const { return buffer_.data() + offset_; }
+    uint size() const { return size_; }
+    bool isEmpty() const { return 0 == size_; }
+    GatByteView mid(uint offset, uint size) const; //!< Clipped to this view.
+    QByteArray toByteArray() const; //!< Copy.
+
+    GatByteView() : offset_(0), size_(0) {}
+    GatByteView(GatBuffer const &buffer, uint offset, uint size);
+
+private:
+    GatBuffer buffer_;
+    uint offset_;
+    uint size_;
+};
+
+
+/*!
+    \brief Sequence of views, i.e. content spread across packets (e.g. the frames of a multi-packet reply).
+
+    Appending a view or another chain copies references, not bytes.  The content is only made contiguous by
+    'toByteArray()' (or 'copyTo()'), once, by whoever finally needs it that way.
+*/
+class GatByteChain
+{
+public:
+    typedef std::vector<GatByteView> views_type;
+
+    void append(GatByteView const &view);
+    void append(GatByteChain const &chain);
+    void clear();
+
+    size_t size() const { return size_; } //!< Total number of bytes.
+    bool isEmpty() const { return 0 == size_; }
+    views_type const & views() const { return views_; }
+
+    size_t copyTo(void *destination, size_t capacity) const; //!< Returns the number of bytes copied.
+    QByteArray toByteArray() const; //!< Contiguous copy (the one copy).
+
+    static GatByteChain fromData(void const *data, size_t dataSize); //!< Copies 'data' into pool buffers.
+
+    GatByteChain() : size_(0) {}
+    explicit GatByteChain(GatByteView const &view) : size_(0) { append(view); }
+
+private:
+    views_type views_;
+    size_t size_;
+};
+
+
+#endif // #ifndef GATBUFFER_HPP__D2FCA503_6FF3_49DF_AE3D_D90364EB4527__INCLUDED
+
+
+/*
+    End of "GatBuffer.hpp"
+*/
@@ -0,0 +1,311 @@
+/*!
+    \file "GatCalcDurationModel.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Historical (persistent) authentication calculation durations, per GAT version and special function.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatCalcDurationModel.hpp"
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <algorithm>
+
+
+quint32 const fileMagic = 0x47434444; // "GCDD"
+quint16 const fileVersion = 1;
+uint const deadlinePercentile = 99;
+uint const minDeadlineMarginInMilliseconds = 30u/* sec */ * 1000u/* ms */;
+
+
+class GatCalcDurationModel::IoTask
+    : public QRunnable
+{
+public:
+    virtual void run() { model_.runIo(); }
+
+    explicit IoTask(GatCalcDurationModel &model) : model_(model) {} // Auto deleted (by the pool).
+
+private:
+    GatCalcDurationModel &model_;
+};
+
+
+GatCalcDurationModel&
+GatCalcDurationModel::instance()
+{
+    static GatCalcDurationModel *model = nullptr;
+    static QMutex modelGuard;
+
+    QMutexLocker modelLock(&modelGuard);
+    if (nullptr == model)
+    {
+        // Never destroyed (like the buffer pool): commands may still finish while statics are being destroyed.
+        model = new GatCalcDurationModel;
+        model->loadLater(defaultPathname());
+    }
+    return *model;
+}
+
+
+QString
+GatCalcDurationModel::defaultPathname()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/CalcDurations.dat";
+}
+
+
+QString
+GatCalcDurationModel::key(uint gatVersionInBcd, QString const &specialFunction)
+{
+    return QString("%1\t%2").arg(gatVersionInBcd, 4, 16, QLatin1Char('0')).arg(specialFunction);
+}
+
+
+bool
+GatCalcDurationModel::load(QString const &pathname)
+{
+    samples_by_key_type samples;
+    bool result = false;
+    {
+        QMutexLocker fileLock(&fileGuard_);
+        result = readFile(pathname, samples);
+    }
+
+    QMutexLocker guardLock(&guard_);
+    samples_.swap(samples);
+    pathname_ = pathname;
+    loadPending_ = false;
+    return result;
+}
+
+
+void
+GatCalcDurationModel::loadLater(QString const &pathname)
+{
+    QMutexLocker guardLock(&guard_);
+
+    pathname_ = pathname;
+    loadPending_ = !pathname.isEmpty();
+    scheduleIo();
+}
+
+
+bool
+GatCalcDurationModel::save() const
+{
+    samples_by_key_type samples;
+    QString pathname;
+    {
+        QMutexLocker guardLock(&guard_);
+        samples = samples_;
+        pathname = pathname_;
+    }
+    if (pathname.isEmpty()) { return false; }
+
+    QMutexLocker fileLock(&fileGuard_);
+    return writeFile(pathname, samples);
+}
+
+
+void
+GatCalcDurationModel::scheduleIo()
+{
+    if (ioScheduled_ || (!loadPending_ && !savePending_)) { return; }
+
+    ioScheduled_ = true;
+    QThreadPool::globalInstance()->start(new IoTask(*this));
+}
+
+
+void
+GatCalcDurationModel::runIo()
+{
+    QMutexLocker fileLock(&fileGuard_);
+
+    for (;;)
+    {
+        QString pathname;
+        bool load = false;
+        samples_by_key_type samples;
+        {
+            QMutexLocker guardLock(&guard_);
+            pathname = pathname_;
+            load = loadPending_;
+            if (!load)
+            {
+                if (!savePending_ || pathname.isEmpty()) { ioScheduled_ = false; return; }
+                samples = samples_; // Saved as of now; later additions are saved by the next pass.
+                savePending_ = false;
+            }
+        }
+
+        if (load)
+        {
+            // Read before anything is saved, so the recorded samples are not replaced by only the new ones.
+            if (!readFile(pathname, samples))
+            {
+                qWarning("Failed to load calculation durations in GatCalcDurationModel::runIo(). " STRINGIZE(__LINE__));
+            }
+
+            QMutexLocker guardLock(&guard_);
+            if (pathname_ != pathname) { continue; } // Loaded again (elsewhere) meanwhile.
+            for (samples_by_key_type::const_iterator entry = samples_.constBegin(); samples_.constEnd() != entry;
+                 ++entry)
+            {
+                // Added while loading: newer than those recorded.
+                samples_type &merged = samples[entry.key()];
+                merged.insert(merged.end(), entry.value().begin(), entry.value().end());
+                if (maxSampleCount < merged.size()) { merged.erase(merged.begin(), merged.end() - maxSampleCount); }
+            }
+            samples_.swap(samples);
+            loadPending_ = false;
+        }
+        else if (!writeFile(pathname, samples))
+        {
+            qWarning("Failed to save calculation durations in GatCalcDurationModel::runIo(). " STRINGIZE(__LINE__));
+        }
+    }
+}
+
+
+bool
+GatCalcDurationModel::readFile(QString const &pathname, samples_by_key_type &samples)
+{
+    samples.clear();
+
+    QFile file(pathname);
+    if (!file.exists()) { return true; } // Nothing recorded yet.
+    if (!file.open(QIODevice::ReadOnly)) { return false; }
+
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint32 keyCount = 0;
+    stream >> magic >> version >> keyCount;
+    if (fileMagic != magic || fileVersion != version) { return false; }
+
+    for (quint32 keyIdx = 0; keyCount > keyIdx && QDataStream::Ok == stream.status(); ++keyIdx)
+    {
+        QString key;
+        quint8 sampleCount = 0;
+        stream >> key >> sampleCount;
+
+        samples_type keySamples;
+        for (quint8 sampleIdx = 0; sampleCount > sampleIdx && QDataStream::Ok == stream.status(); ++sampleIdx)
+        {
+            quint32 sample = 0;
+            stream >> sample;
+            keySamples.push_back(sample);
+        }
+        if (maxSampleCount < keySamples.size())
+        {
+            keySamples.erase(keySamples.begin(), keySamples.end() - maxSampleCount);
+        }
+        if (QDataStream::Ok == stream.status() && !keySamples.empty()) { samples.insert(key, keySamples); }
+    }
+
+    return QDataStream::Ok == stream.status();
+}
+
+
+bool
+GatCalcDurationModel::writeFile(QString const &pathname, samples_by_key_type const &samples)
+{
+    QDir().mkpath(QFileInfo(pathname).absolutePath());
+    QSaveFile file(pathname); // Replaced only once completely written.
+    if (!file.open(QIODevice::WriteOnly)) { return false; }
+
+    QDataStream stream(&file);
+    stream << fileMagic << fileVersion << static_cast<quint32>(samples.size());
+    for (samples_by_key_type::const_iterator entry = samples.constBegin(); samples.constEnd() != entry; ++entry)
+    {
+        stream << entry.key() << static_cast<quint8>(entry.value().size());
+        for (uint sample : entry.value()) { stream << static_cast<quint32>(sample); }
+    }
+
+    return QDataStream::Ok == stream.status() && file.commit();
+}
+
+
+void
+GatCalcDurationModel::addDuration(QString const &key, uint milliseconds)
+{
+    QMutexLocker guardLock(&guard_);
+
+    samples_type &samples = samples_[key];
+    if (maxSampleCount <= samples.size()) { samples.erase(samples.begin()); }
+    samples.push_back(milliseconds);
+
+    savePending_ = true;
+    scheduleIo();
+}
+
+
+uint
+GatCalcDurationModel::sampleCount(QString const &key) const
+{
+    QMutexLocker guardLock(&guard_);
+
+    return static_cast<uint>(samples_.value(key).size());
+}
+
+
+uint
+GatCalcDurationModel::percentile(QString const &key, uint percent) const
+{
+    samples_type samples;
+    {
+        QMutexLocker guardLock(&guard_);
+        samples = samples_.value(key);
+    }
+    if (samples.empty()) { return 0; }
+
+    // Nearest rank: the smallest sample that 'percent' percent of the samples do not exceed.
+    size_t const rank = ((std::min)(percent, 100u) * samples.size() + 99) / 100;
+    size_t const index = 0 < rank ? rank - 1 : 0;
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+
+uint
+GatCalcDurationModel::deadline(QString const &key) const
+{
+    if (minSampleCountForDeadline > sampleCount(key)) { return 0; }
+
+    uint const worst = percentile(key, deadlinePercentile);
+    return worst + (std::max)(worst / 2, minDeadlineMarginInMilliseconds);
+}
+
+
+GatCalcDurationModel::GatCalcDurationModel()
+    : loadPending_(false)
+    , savePending_(false)
+    , ioScheduled_(false)
+{
+    // Do nothing.
+}
+
+
+/*
+    End of "GatCalcDurationModel.cpp"
+*/
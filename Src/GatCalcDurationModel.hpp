@@ -0,0 +1,101 @@
+/*!
+    \file "GatCalcDurationModel.hpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Historical (persistent) authentication calculation durations, per GAT version and special function.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#ifndef GATCALCDURATIONMODEL_HPP__E9D621D3_EB3D_4919_B8AD_D92B33853B44__INCLUDED
+#define GATCALCDURATIONMODEL_HPP__E9D621D3_EB3D_4919_B8AD_D92B33853B44__INCLUDED
+
+
+#pragma once
+
+
+#include "Defs.hpp"
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <vector>
+
+
+/*!
+    \brief Durations of authentication calculations (IACQ accepted until SR Finished), and their percentiles.
+
+    The most recent 'maxSampleCount' durations are kept per key (GAT version and special function; see 'key()'), and
+    saved to a small binary file, so the model survives restarts.  Percentiles are by nearest rank over those
+    samples.  Thread safe.
+
+    GAT has GMs report only the version of the protocol they implement (in the SR), not their make or model, so the
+    durations of every GM implementing the same version are pooled.
+
+    The process wide model is loaded, and additions are saved, by a pool thread (see 'loadLater()'): callers include
+    the thread of the host, which must not wait on the file system (or on a lock held while something else does).
+    Additions that arrive while a save is being written are saved together once it is done.
+*/
+class GatCalcDurationModel
+{
+public:
+    static uint const maxSampleCount = 64; // Per key.
+    static uint const minSampleCountForDeadline = 5;
+
+    static GatCalcDurationModel& instance(); //!< Process wide model; being loaded from 'defaultPathname()'.
+    static QString defaultPathname(); //!< In the application's data directory.
+    static QString key(uint gatVersionInBcd, QString const &specialFunction); //!< See the SR's 'versionInBcd()'.
+
+    bool load(QString const &pathname); //!< Replaces the samples (blocks); later additions are saved to 'pathname'.
+    void loadLater(QString const &pathname); //!< By a pool thread; samples added meanwhile are kept (as the newest).
+    bool save() const; //!< To the pathname last loaded (or nothing); blocks.
+
+    void addDuration(QString const &key, uint milliseconds); //!< Saved later, by a pool thread.
+    uint sampleCount(QString const &key) const;
+    uint percentile(QString const &key, uint percent) const; //!< Milliseconds; 0 when there is no sample.
+
+    //! Milliseconds beyond which the calculation is not going to finish; 0 until there are enough samples.
+    uint deadline(QString const &key) const;
+
+    GatCalcDurationModel();
+
+private:
+    typedef std::vector<uint> samples_type; // Milliseconds, oldest first.
+    typedef QHash<QString, samples_type> samples_by_key_type;
+
+    class IoTask;
+
+    void scheduleIo(); //!< With 'guard_' held.
+    void runIo(); //!< In a pool thread; the pending load, then the pending save (repeatedly, until none).
+    static bool readFile(QString const &pathname, samples_by_key_type &samples);
+    static bool writeFile(QString const &pathname, samples_by_key_type const &samples);
+
+    mutable QMutex guard_; // Never held while the file is read or written.
+    samples_by_key_type samples_;
+    QString pathname_;
+    bool loadPending_;
+    bool savePending_;
+    bool ioScheduled_; // A pool thread runs (or is about to run) 'runIo()'.
+
+    mutable QMutex fileGuard_; // Serializes the reads and writes of the file (never taken with 'guard_' held).
+
+    GatCalcDurationModel(GatCalcDurationModel const&) = delete; //!< No cloning; leave unimplemented!
+    GatCalcDurationModel& operator=(GatCalcDurationModel const&) = delete; //!< No cloning; leave unimplemented!
+};
+
+
+#endif // #ifndef GATCALCDURATIONMODEL_HPP__E9D621D3_EB3D_4919_B8AD_D92B33853B44__INCLUDED
+
+
+/*
+    End of "GatCalcDurationModel.hpp"
+*/
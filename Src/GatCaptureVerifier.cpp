@@ -0,0 +1,269 @@
+/*!
+    \file "GatCaptureVerifier.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Bulk (multi-core) CRC verification of captured GAT traffic.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatCaptureVerifier.hpp"
+#include "GatPktCodec.hpp"
+#include <QFile>
+#include <sys/mman.h>
+#include <thread>
+
+
+bool
+GatCaptureVerifier::verifyFile(QString const &pathname, uint threadCount)
+{
+    errorString_.clear();
+
+    QFile file(pathname);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        errorString_ = file.errorString();
+        return false;
+    }
+
+    qint64 const fileSize = file.size();
+    if (0 >= fileSize)
+    {
+        verify(nullptr, 0, threadCount);
+        return true;
+    }
+
+    uchar *data = file.map(0, fileSize);
+    if (nullptr == data)
+    {
+        errorString_ = file.errorString();
+        return false;
+    }
+    madvise(data, static_cast<size_t>(fileSize), MADV_WILLNEED); // Start read-ahead of the whole file.
+
+    verify(data, static_cast<quint64>(fileSize), threadCount);
+
+    file.unmap(data);
+    return true;
+}
+
+
+void
+GatCaptureVerifier::verify(uint8_t const *data, quint64 dataSize, uint threadCount)
+{
+    frames_.clear();
+    frameValid_.clear();
+    packetCount_ = 0;
+    byteCount_ = dataSize;
+    corruptRegions_.clear();
+
+    if (nullptr == data || 0 == dataSize) { return; }
+
+    if (0 == threadCount) { threadCount = static_cast<uint>((std::max)(1, QThread::idealThreadCount())); }
+
+    frame(data, dataSize);
+    checkCrcs(data, threadCount);
+    resynchronize(data, dataSize);
+
+    // Release the (large) per frame bookkeeping; only the results are kept.
+    frames_type().swap(frames_);
+    std::vector<uint8_t>().swap(frameValid_);
+}
+
+
+bool
+GatCaptureVerifier::isPlausibleHeader(uint8_t const *data, quint64 available)
+{
+    if (GatPktFrameCodec::payloadOffset > available) { return false; }
+
+    uint const command = GatPktFrameCodec::Command::decode(data);
+    uint const length = GatPktFrameCodec::Length::decode(data);
+    uint const requestCommand = command & 0x7f;
+    return GatRqstCmd::SQ <= requestCommand && GatRqstCmd::IACQ >= requestCommand &&
+           GatPktFrameCodec::overhead <= length && available >= length;
+}
+
+
+void
+GatCaptureVerifier::frame(uint8_t const *data, quint64 dataSize)
+{
+    frames_.reserve(static_cast<size_t>(dataSize / 16)); // A guess (typical packets are short).
+
+    quint64 offset = 0;
+    while (dataSize > offset)
+    {
+        if (isPlausibleHeader(data + offset, dataSize - offset))
+        {
+            Frame const frame = { offset, GatPktFrameCodec::Length::decode(data + offset) };
+            frames_.push_back(frame);
+            offset += frame.size_;
+        }
+        else
+        {
+            ++offset; // Unframed; pass 3 reports it.
+        }
+    }
+}
+
+
+void
+GatCaptureVerifier::checkCrcs(uint8_t const *data, uint threadCount)
+{
+    frameValid_.assign(frames_.size(), 0);
+
+    size_t const frameCount = frames_.size();
+    threadCount = static_cast<uint>((std::min)(static_cast<size_t>(threadCount), (std::max)(frameCount, size_t(1))));
+    size_t const framesPerThread = (frameCount + threadCount - 1) / threadCount;
+
+    auto const checkRange = [this, data](size_t first, size_t last)
+    {
+        for (size_t idx = first; last > idx; ++idx)
+        {
+            Frame const &frame = frames_[idx];
+            frameValid_[idx] = GatPktFrameCodec::crcIsValid(data + frame.offset_, frame.size_) ? 1 : 0;
+        }
+    };
+
+    // This thread checks the first range while the others check theirs.
+    std::vector<std::thread> threads;
+    for (uint thread = 1; threadCount > thread; ++thread)
+    {
+        size_t const first = (std::min)(frameCount, thread * framesPerThread);
+        size_t const last = (std::min)(frameCount, first + framesPerThread);
+        threads.push_back(std::thread(checkRange, first, last));
+    }
+    checkRange(0, (std::min)(frameCount, framesPerThread));
+    for (std::vector<std::thread>::iterator thread = threads.begin(); threads.end() != thread; ++thread)
+    {
+        thread->join();
+    }
+}
+
+
+quint64
+GatCaptureVerifier::findValidPacket(uint8_t const *data, quint64 dataSize, quint64 offset)
+{
+    for (; dataSize > offset; ++offset)
+    {
+        if (isPlausibleHeader(data + offset, dataSize - offset) &&
+            GatPktFrameCodec::crcIsValid(data + offset, GatPktFrameCodec::Length::decode(data + offset)))
+        {
+            break;
+        }
+    }
+    return offset;
+}
+
+
+void
+GatCaptureVerifier::resynchronize(uint8_t const *data, quint64 dataSize)
+{
+    quint64 offset = 0;
+    size_t idx = 0;
+    while (frames_.size() > idx && dataSize > offset)
+    {
+        Frame const &frame = frames_[idx];
+        if (offset > frame.offset_) { ++idx; continue; } // Inside a region already accounted for.
+
+        if (offset < frame.offset_)
+        {
+            addCorruptRegion(offset, frame.offset_ - offset, Region::Reason::Unframed);
+            offset = frame.offset_;
+        }
+
+        if (0 != frameValid_[idx])
+        {
+            ++packetCount_;
+            offset += frame.size_;
+            ++idx;
+            continue;
+        }
+
+        // Bad CRC: its length may be corrupt too, so find the next valid packet the hard way, and frame from there
+        // until a packet starts where pass 1 framed one.
+        quint64 next = findValidPacket(data, dataSize, offset + 1);
+        addCorruptRegion(offset, next - offset, Region::Reason::BadCrc);
+        offset = next;
+        while (dataSize > offset)
+        {
+            Frame const key = { offset, 0 };
+            frames_type::const_iterator const aligned =
+                std::lower_bound(frames_.begin(), frames_.end(), key,
+                                 [](Frame const &lhs, Frame const &rhs) { return lhs.offset_ < rhs.offset_; });
+            idx = static_cast<size_t>(aligned - frames_.begin());
+            if (frames_.end() != aligned && offset == aligned->offset_) { break; } // In sync with pass 1 again.
+
+            uint const length = GatPktFrameCodec::Length::decode(data + offset); // Valid ('findValidPacket()').
+            ++packetCount_;
+            offset += length;
+            next = findValidPacket(data, dataSize, offset);
+            if (offset < next)
+            {
+                addCorruptRegion(offset, next - offset, Region::Reason::Unframed);
+                offset = next;
+            }
+        }
+    }
+
+    if (dataSize > offset)
+    {
+        addCorruptRegion(offset, dataSize - offset, Region::Reason::Unframed);
+    }
+}
+
+
+void
+GatCaptureVerifier::addCorruptRegion(quint64 offset, quint64 size, Region::Reason reason)
+{
+    if (0 == size) { return; }
+
+    // Merge with the previous region when adjacent (one report per burst of noise).
+    if (!corruptRegions_.empty())
+    {
+        Region &last = corruptRegions_.back();
+        if (last.offset_ + last.size_ == offset && last.reason_ == reason)
+        {
+            last.size_ += size;
+            return;
+        }
+    }
+
+    Region const region = { offset, size, reason };
+    corruptRegions_.push_back(region);
+}
+
+
+char const *
+GatCaptureVerifier::reasonName(Region::Reason reason)
+{
+    static char const * const names[] = {
+        "bad CRC",   // Region::Reason::BadCrc
+        "unframed",  // Region::Reason::Unframed
+        "undefined", // Region::Reason::Undefined
+    };
+    size_t const idx = (std::min)(static_cast<size_t>(reason), arycap(names) - 1);
+    return names[idx];
+}
+
+
+GatCaptureVerifier::GatCaptureVerifier()
+    : packetCount_(0)
+    , byteCount_(0)
+{
+    // Do nothing.
+}
+
+
+/*
+    End of "GatCaptureVerifier.cpp"
+*/
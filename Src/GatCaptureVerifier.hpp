@@ -0,0 +1,102 @@
+/*!
+    \file "GatCaptureVerifier.hpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Bulk (multi-core) CRC verification of captured GAT traffic.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#ifndef GATCAPTUREVERIFIER_HPP__CAD4CA16_82FF_4CD3_AC84_E3B57E356EC3__INCLUDED
+#define GATCAPTUREVERIFIER_HPP__CAD4CA16_82FF_4CD3_AC84_E3B57E356EC3__INCLUDED
+
+
+#pragma once
+
+
+#include "Defs.hpp"
+#include <vector>
+
+
+/*!
+    \brief Bulk (multi-core) CRC verification of captured GAT traffic.
+
+    A capture is the raw byte stream of a GAT serial line (requests and replies back to back, as framed by
+    'GatLinkLayer').  Verification runs in three passes:
+      1. Framing: hop from length byte to length byte (one read per packet), skipping bytes that cannot start
+         a packet.
+      2. CRC: the frames are split evenly across threads, each of which checks the CRC of its frames.
+      3. Resynchronization: a frame whose CRC fails may have had its length corrupted, so the frames after it are
+         re-framed (scanning forward for a header whose CRC is valid, as 'GatLinkLayer' does) until the framing
+         agrees with pass 1 again.
+    Every byte that is not part of a valid packet is reported, as regions (offset and size).
+*/
+class GatCaptureVerifier
+{
+public:
+    struct Region
+    {
+        enum class Reason : size_t {
+            BadCrc,    //!< Framed, but its CRC does not match.
+            Unframed,  //!< Cannot start a packet (noise, truncated packet, lost sync).
+            Undefined  // Must always be last.
+        };
+
+        quint64 offset_;
+        quint64 size_;
+        Reason reason_;
+    };
+    typedef std::vector<Region> regions_type;
+
+    bool verifyFile(QString const &pathname, uint threadCount = 0); //!< Memory maps the file; 0 = all cores.
+    void verify(uint8_t const *data, quint64 dataSize, uint threadCount = 0); //!< 0 = all cores.
+
+    quint64 packetCount() const { return packetCount_; } //!< Valid packets.
+    quint64 byteCount() const { return byteCount_; }
+    regions_type const & corruptRegions() const { return corruptRegions_; }
+    QString errorString() const { return errorString_; } //!< When 'verifyFile()' fails.
+
+    static bool isPlausibleHeader(uint8_t const *data, quint64 available); //!< Could start a packet.
+    static char const * reasonName(Region::Reason reason);
+
+    GatCaptureVerifier();
+
+private:
+    struct Frame
+    {
+        quint64 offset_;
+        uint size_;
+    };
+    typedef std::vector<Frame> frames_type;
+
+    void frame(uint8_t const *data, quint64 dataSize); //!< Pass 1.
+    void checkCrcs(uint8_t const *data, uint threadCount); //!< Pass 2.
+    void resynchronize(uint8_t const *data, quint64 dataSize); //!< Pass 3.
+    static quint64 findValidPacket(uint8_t const *data, quint64 dataSize, quint64 offset); //!< 'dataSize' if none.
+    void addCorruptRegion(quint64 offset, quint64 size, Region::Reason reason);
+
+    frames_type frames_;
+    std::vector<uint8_t> frameValid_; // Per 'frames_' item; bytes (not bits) so no two threads write one location.
+    quint64 packetCount_;
+    quint64 byteCount_;
+    regions_type corruptRegions_;
+    QString errorString_;
+};
+
+
+#endif // #ifndef GATCAPTUREVERIFIER_HPP__CAD4CA16_82FF_4CD3_AC84_E3B57E356EC3__INCLUDED
+
+
+/*
+    End of "GatCaptureVerifier.hpp"
+*/
@@ -0,0 +1,329 @@
+/*!
+    \file "GatCoroutine.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    GAT operations written as C++20 coroutines (qmake CONFIG+=gat_coroutines).
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatCoroutine.hpp"
+
+
+#ifdef ENABLE_GAT_COROUTINES
+
+
+#include "GatCalcDurationModel.hpp"
+#include "GatPktCodec.hpp"
+#include "GatPkt_StatusQueryRslt_SR81.hpp"
+#include "GatSpecialFunctionExec.hpp"
+#include <QTimer>
+
+
+std::coroutine_handle<>
+GatTask::FinalAwaiter::await_suspend(handle_type coroutine) noexcept
+{
+    promise_type &promise = coroutine.promise();
+    if (promise.continuation_) { return promise.continuation_; } // Resume the awaiting task.
+
+    completion_type completion;
+    completion.swap(promise.completion_);
+    if (completion)
+    {
+        try { completion(promise.result_); } catch (...) { qWarning("Unexpected exception caught and discarded in GatTask::FinalAwaiter::await_suspend(). " STRINGIZE(__LINE__)); }
+    }
+    return std::noop_coroutine();
+}
+
+
+void
+GatTask::promise_type::unhandled_exception()
+{
+    qWarning("Unexpected exception caught and discarded in GatTask::promise_type::unhandled_exception(). " STRINGIZE(__LINE__));
+    result_ = result_type::Undefined;
+}
+
+
+void
+GatTask::start(completion_type completion)
+{
+    if (!isValid() || coroutine_.done()) { return; }
+
+    coroutine_.promise().completion_ = completion;
+    coroutine_.resume();
+}
+
+
+std::coroutine_handle<>
+GatTask::await_suspend(std::coroutine_handle<> awaiting) noexcept
+{
+    coroutine_.promise().continuation_ = awaiting;
+    return coroutine_; // Run this task (it resumes 'awaiting' when done).
+}
+
+
+GatTask&
+GatTask::operator=(GatTask &&other) noexcept
+{
+    if (this != &other)
+    {
+        if (coroutine_) { coroutine_.destroy(); }
+        coroutine_ = other.coroutine_;
+        other.coroutine_ = handle_type();
+    }
+    return *this;
+}
+
+
+GatTask::~GatTask()
+{
+    if (coroutine_) { coroutine_.destroy(); }
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+auto
+GatCallbackAwaiter::beginSuspend(GatTask::handle_type coroutine) -> lifetime_type
+{
+    coroutine_ = coroutine;
+    suspending_ = true;
+    completed_ = false;
+    return coroutine.promise().lifetime_;
+}
+
+
+bool
+GatCallbackAwaiter::endSuspend()
+{
+    suspending_ = false;
+    return !completed_; // Completed already: do not suspend.
+}
+
+
+void
+GatCallbackAwaiter::complete()
+{
+    completed_ = true;
+    if (!suspending_) { coroutine_.resume(); }
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+bool
+GatLinkRequest::await_suspend(GatTask::handle_type coroutine)
+{
+    lifetime_type const lifetime = beginSuspend(coroutine);
+    GatLinkLayer::RequestResult const result = linkLayer_.sendRequest(request_, data_.constData(),
+        static_cast<uint>(data_.size()),
+        [this, lifetime](GatLinkLayer &host, GatLinkLayer::ResultType resultType) {
+            if (lifetime.expired()) { return; }
+            reply_.resultType_ = resultType;
+            reply_.reply_ = GatLinkLayer::ResultType::Reply == resultType ? host.replyView() : GatByteView();
+            complete();
+        });
+    if (GatLinkLayer::RequestResult::Success != result && GatLinkLayer::RequestResult::Pending != result)
+    {
+        reply_.resultType_ = GatLinkLayer::ResultType::Undefined;
+        reply_.reply_ = GatByteView();
+        endSuspend();
+        return false;
+    }
+    return endSuspend();
+}
+
+
+GatLinkRequest::GatLinkRequest(GatLinkLayer &linkLayer, GatRqst request, QByteArray const &data)
+    : linkLayer_(linkLayer)
+    , request_(request)
+    , data_(data)
+{
+    reply_.resultType_ = GatLinkLayer::ResultType::Undefined;
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+bool
+GatStatusQuery::await_suspend(GatTask::handle_type coroutine)
+{
+    lifetime_type const lifetime = beginSuspend(coroutine);
+    // A shared reply is delivered before 'query()' returns (and then there is no subscription).
+    subscription_ = statusQueries_.query(
+        [this, lifetime](GatLinkLayer::ResultType resultType, GatByteView const &reply) {
+            if (lifetime.expired()) { return; }
+            subscription_ = 0;
+            reply_.resultType_ = resultType;
+            reply_.reply_ = reply;
+            complete();
+        },
+        maxAgeInMilliseconds_);
+    return endSuspend();
+}
+
+
+GatStatusQuery::GatStatusQuery(GatStatusQueryCoalescer &statusQueries, uint maxAgeInMilliseconds)
+    : statusQueries_(statusQueries)
+    , maxAgeInMilliseconds_(maxAgeInMilliseconds)
+    , subscription_(0)
+{
+    reply_.resultType_ = GatLinkLayer::ResultType::Undefined;
+}
+
+
+GatStatusQuery::~GatStatusQuery()
+{
+    // Destroyed with its coroutine while waiting: the reply would otherwise be delivered to this (destroyed) query.
+    if (0 != subscription_) { statusQueries_.unsubscribe(subscription_); }
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+bool
+GatDelay::await_suspend(GatTask::handle_type coroutine)
+{
+    lifetime_type const lifetime = beginSuspend(coroutine);
+    QTimer::singleShot(static_cast<int>(milliseconds_), [this, lifetime]() {
+        if (lifetime.expired()) { return; }
+        complete();
+    });
+    return endSuspend();
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+GatTask
+gatPollUntilReady(GatStatusQueryCoalescer &statusQueries, GatStatusPollPolicy policy, QString durationKey)
+{
+    uint32_t const startTime = monotonicClock32();
+    uint32_t replyTime = startTime;
+    uint deadline = GatSpecialFunctionExec::maxStatusPollDuration(); // Until the history of this calculation is known.
+    QString historyKey; // Until the GM reports its GAT version (in the first poll response).
+    policy.setExpectedDuration(0);
+    policy.start();
+
+    for (;;)
+    {
+        // Never accept a reply older than the last one seen here: that status is already known.
+        GatLinkReply const poll = co_await GatStatusQuery(statusQueries, monotonicClock32() - replyTime);
+        replyTime = monotonicClock32();
+        if (GatLinkLayer::ResultType::Reply != poll.resultType_) { co_return poll.resultType_; }
+
+        GatPkt_StatusQueryRslt_SR81 statusQueryResult;
+        if (!statusQueryResult.parseResultPacket(poll.reply_.data(), poll.reply_.size()))
+        {
+            co_return GatLinkLayer::ResultType::InvalidResponse;
+        }
+
+        // Aim the polls at the typical (median) end of such calculations on GMs of this GAT version, and give up
+        // once well past the slowest of them (as 'GatSpecialFunctionExec' does).
+        if (historyKey.isEmpty())
+        {
+            GatCalcDurationModel const &durations = GatCalcDurationModel::instance();
+            historyKey = GatCalcDurationModel::key(statusQueryResult.versionInBcd(), durationKey);
+            policy.setExpectedDuration(durations.percentile(historyKey, 50));
+            uint const historyDeadline = durations.deadline(historyKey);
+            if (0 < historyDeadline) { deadline = historyDeadline; }
+        }
+
+        GatPkt_StatusQueryRslt_SR81::CalculationStatus const calculationStatus = statusQueryResult.calculationStatus();
+        bool const calculating = statusQueryResult.calculationInProgress() ||
+                                 GatPkt_StatusQueryRslt_SR81::CalculationStatus::Calculating == calculationStatus ||
+                                 GatPkt_StatusQueryRslt_SR81::CalculationStatus::Requested == calculationStatus;
+        if (!calculating)
+        {
+            bool const ready = statusQueryResult.authResultsReady() &&
+                               GatPkt_StatusQueryRslt_SR81::CalculationStatus::Finished == calculationStatus;
+            if (!ready) { co_return GatLinkLayer::ResultType::InvalidResponse; }
+
+            GatCalcDurationModel::instance().addDuration(historyKey, monotonicClock32() - startTime);
+            co_return GatLinkLayer::ResultType::Reply;
+        }
+
+        uint const elapsed = monotonicClock32() - startTime;
+        if (elapsed >= deadline) { co_return GatLinkLayer::ResultType::Timeout; }
+        co_await GatDelay((std::min)(policy.nextPeriod(elapsed), deadline - elapsed));
+    }
+}
+
+
+GatTask
+gatReadFrames(GatLinkLayer &linkLayer, GatDataFormat dataFormat, GatByteChain &frames, uint frameRetryLimit)
+{
+    frames.clear();
+
+    GatFrameRetries frameRetries(frameRetryLimit);
+    for (uint frameNumber = 1; ; )
+    {
+        GatLinkReply const larrReply = co_await GatLinkRequest(linkLayer, GatRqst::LARQ_03,
+                                                               GatMultipktRply::larqPayload(dataFormat, frameNumber));
+        if (GatLinkLayer::ResultType::Undefined == larrReply.resultType_) { co_return larrReply.resultType_; }
+
+        GatMultipktRply::FrameCheck const frameCheck = GatMultipktRply::checkFrame(larrReply.resultType_,
+                                                                                   larrReply.reply_, frameNumber);
+        if (GatMultipktRply::FrameCheck::Retry == frameCheck)
+        {
+            // Request the same frame again (the frames already received are kept).
+            if (frameRetries.retry()) { continue; }
+            co_return GatLinkLayer::ResultType::Timeout == larrReply.resultType_
+                      ? GatLinkLayer::ResultType::Timeout : GatLinkLayer::ResultType::InvalidResponse;
+        }
+
+        // The GM reported an error (not noise); asking again will not help.
+        if (GatMultipktRply::FrameCheck::Accept != frameCheck) { co_return GatLinkLayer::ResultType::InvalidResponse; }
+
+        GatPktView_LARR const larr(larrReply.reply_.data(), larrReply.reply_.size());
+        frames.append(larrReply.reply_.mid(larr.dataOffset(), larr.dataSize()));
+        if (larr.lastFrame()) { co_return GatLinkLayer::ResultType::Reply; }
+
+        ++frameNumber;
+        frameRetries.nextFrame();
+    }
+}
+
+
+GatTask
+gatSpecialFunction(GatLinkLayer &linkLayer, GatStatusQueryCoalescer &statusQueries, QStringList params,
+                   GatByteChain &reply)
+{
+    reply.clear();
+
+    QByteArray const request(GatSpecialFunctionExec::requestPayload(params));
+    if (request.isEmpty()) { co_return GatLinkLayer::ResultType::Undefined; }
+
+    GatLinkReply const iacr = co_await GatLinkRequest(linkLayer, GatRqst::IACQ_04, request);
+    if (GatLinkLayer::ResultType::Reply != iacr.resultType_) { co_return iacr.resultType_; }
+
+    GatLinkLayer::ResultType const ready = co_await gatPollUntilReady(statusQueries,
+                                                                      GatSpecialFunctionExec::defaultStatusPollPolicy(),
+                                                                      GatSpecialFunctionExec::durationKey(params));
+    if (GatLinkLayer::ResultType::Reply != ready) { co_return ready; }
+
+    co_return co_await gatReadFrames(linkLayer, GatDataFormat::Xml, reply);
+}
+
+
+#endif // #ifdef ENABLE_GAT_COROUTINES
+
+
+/*
+    End of "GatCoroutine.cpp"
+*/
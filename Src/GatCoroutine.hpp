@@ -0,0 +1,238 @@
+/*!
+    \file "GatCoroutine.hpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    GAT operations written as C++20 coroutines (qmake CONFIG+=gat_coroutines).
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#ifndef GATCOROUTINE_HPP__27E9545F_9FD0_4983_86EE_208B8C21E709__INCLUDED
+#define GATCOROUTINE_HPP__27E9545F_9FD0_4983_86EE_208B8C21E709__INCLUDED
+
+
+#pragma once
+
+
+#ifdef ENABLE_GAT_COROUTINES
+
+
+#include "Defs.hpp"
+#include "GatBuffer.hpp"
+#include "GatLinkLayer.hpp"
+#include "GatMultipktRply.hpp"
+#include "GatStatusPollPolicy.hpp"
+#include "GatStatusQueryCoalescer.hpp"
+#include <QByteArray>
+#include <QStringList>
+#include <coroutine>
+#include <functional>
+#include <memory>
+
+
+/*!
+    \brief A GAT operation written as a coroutine, e.g. 'co_await GatLinkRequest(linkLayer, GatRqst::IACQ_04, ...)'.
+
+    A task starts suspended.  A top level task is run by 'start()' (see 'GatHostCoroutineCmd'), and a task awaited
+    by another task runs from the 'co_await', which resumes once the task 'co_return's.  The awaitables below are
+    resumed directly from the callbacks that complete them (link layer request completions, status query replies,
+    timers), i.e. in the thread of the link layer, with no signal or event in between.  Destroying a task destroys
+    its coroutine (and the tasks it awaits) wherever it is suspended; the callbacks still pending are then ignored.
+*/
+class GatTask
+{
+public:
+    typedef GatLinkLayer::ResultType result_type; // How the operation ended; 'Reply' is success.
+    typedef std::function<void (result_type result)> completion_type;
+
+    struct promise_type;
+    typedef std::coroutine_handle<promise_type> handle_type;
+
+    struct FinalAwaiter
+    {
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(handle_type coroutine) noexcept;
+        void await_resume() const noexcept {}
+    };
+
+    struct promise_type
+    {
+        GatTask get_return_object() { return GatTask(handle_type::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_value(result_type value) { result_ = value; }
+        void unhandled_exception();
+
+        result_type result_ = result_type::Undefined;
+        std::coroutine_handle<> continuation_; // The task awaiting this one (if any).
+        completion_type completion_; // Of a started (top level) task.
+        std::shared_ptr<int> lifetime_ = std::make_shared<int>(0); // Expires with the coroutine.
+    };
+
+    //! \name Top Level
+    //! @{
+public:
+    void start(completion_type completion); //!< 'completion' is called once the task 'co_return's.
+    bool isValid() const { return static_cast<bool>(coroutine_); }
+    bool done() const { return isValid() && coroutine_.done(); }
+    result_type result() const { return done() ? coroutine_.promise().result_ : result_type::Undefined; }
+    //! @}
+
+    //! \name Awaited (by another task)
+    //! @{
+public:
+    bool await_ready() const noexcept { return !isValid() || coroutine_.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept;
+    result_type await_resume() const { return isValid() ? coroutine_.promise().result_ : result_type::Undefined; }
+    //! @}
+
+    //! \name Construction, Destruction, and Assignment
+    //! @{
+public:
+    GatTask() {}
+    GatTask(GatTask &&other) noexcept : coroutine_(other.coroutine_) { other.coroutine_ = handle_type(); }
+    GatTask& operator=(GatTask &&other) noexcept;
+    ~GatTask();
+
+private:
+    explicit GatTask(handle_type coroutine) : coroutine_(coroutine) {}
+
+    handle_type coroutine_;
+
+    GatTask(GatTask const&) = delete; //!< No cloning; leave unimplemented!
+    GatTask& operator=(GatTask const&) = delete; //!< No cloning; leave unimplemented!
+    //! @}
+};
+
+
+/*!
+    \brief Base of the awaitables completed by a callback.
+
+    The callback may come before 'await_suspend()' returns (the coroutine then does not suspend at all), or after
+    the coroutine was destroyed (the callback must check the lifetime returned by 'beginSuspend()' first).
+*/
+class GatCallbackAwaiter
+{
+public:
+    bool await_ready() const noexcept { return false; }
+
+protected:
+    typedef std::weak_ptr<int> lifetime_type;
+
+    lifetime_type beginSuspend(GatTask::handle_type coroutine);
+    bool endSuspend(); //!< Returns the result of 'await_suspend()'.
+    void complete(); //!< From the callback; resumes the coroutine (unless not suspended yet).
+
+private:
+    GatTask::handle_type coroutine_;
+    bool suspending_ = false;
+    bool completed_ = false;
+};
+
+
+struct GatLinkReply
+{
+    GatLinkLayer::ResultType resultType_; // 'Undefined' when the request could not be sent.
+    GatByteView reply_; // The reply packet when 'Reply', else empty.
+};
+
+
+/*!
+    \brief Sends one request through the link layer (queued like any other) and resumes with its reply.
+*/
+class GatLinkRequest
+    : public GatCallbackAwaiter
+{
+public:
+    bool await_suspend(GatTask::handle_type coroutine);
+    GatLinkReply await_resume() const { return reply_; }
+
+    GatLinkRequest(GatLinkLayer &linkLayer, GatRqst request, QByteArray const &data = QByteArray());
+
+private:
+    GatLinkLayer &linkLayer_;
+    GatRqst request_;
+    QByteArray data_;
+    GatLinkReply reply_;
+};
+
+
+/*!
+    \brief Status query (SQ/SR) through a 'GatStatusQueryCoalescer'; resumes with the SR.
+
+    A query still waiting for its reply when the coroutine is destroyed is unsubscribed.
+*/
+class GatStatusQuery
+    : public GatCallbackAwaiter
+{
+public:
+    bool await_suspend(GatTask::handle_type coroutine);
+    GatLinkReply await_resume() const { return reply_; }
+
+    GatStatusQuery(GatStatusQueryCoalescer &statusQueries, uint maxAgeInMilliseconds);
+    ~GatStatusQuery();
+
+private:
+    GatStatusQueryCoalescer &statusQueries_;
+    uint maxAgeInMilliseconds_;
+    uint subscription_; // 0 when not waiting for a reply.
+    GatLinkReply reply_;
+
+    GatStatusQuery(GatStatusQuery const&) = delete; //!< No cloning; leave unimplemented!
+    GatStatusQuery& operator=(GatStatusQuery const&) = delete; //!< No cloning; leave unimplemented!
+};
+
+
+/*!
+    \brief Resumes after 'milliseconds' (from the event loop of the current thread).
+*/
+class GatDelay
+    : public GatCallbackAwaiter
+{
+public:
+    bool await_suspend(GatTask::handle_type coroutine);
+    void await_resume() const {}
+
+    explicit GatDelay(uint milliseconds) : milliseconds_(milliseconds) {}
+
+private:
+    uint milliseconds_;
+};
+
+
+//! \name Operations
+//! @{
+//! Polls (through 'statusQueries') until the calculation 'durationKey' (see 'GatSpecialFunctionExec::durationKey()')
+//! the GM is running finishes, and records its duration; 'Timeout' once past the deadline its history supports
+//! (see 'GatCalcDurationModel'), else past 'GatSpecialFunctionExec::maxStatusPollDuration()'.
+GatTask gatPollUntilReady(GatStatusQueryCoalescer &statusQueries, GatStatusPollPolicy policy, QString durationKey);
+
+//! Reads a multi-packet reply (LARQ/LARR), frame by frame, into 'frames' (which must outlive the task).
+GatTask gatReadFrames(GatLinkLayer &linkLayer, GatDataFormat dataFormat, GatByteChain &frames,
+                      uint frameRetryLimit = GatMultipktRply::defaultFrameRetryLimit);
+
+//! IACQ, then 'gatPollUntilReady()', then 'gatReadFrames()' (XML) into 'reply' (which must outlive the task).
+GatTask gatSpecialFunction(GatLinkLayer &linkLayer, GatStatusQueryCoalescer &statusQueries, QStringList params,
+                           GatByteChain &reply);
+//! @}
+
+
+#endif // #ifdef ENABLE_GAT_COROUTINES
+
+
+#endif // #ifndef GATCOROUTINE_HPP__27E9545F_9FD0_4983_86EE_208B8C21E709__INCLUDED
+
+
+/*
+    End of "GatCoroutine.hpp"
+*/
@@ -0,0 +1,308 @@
+/*!
+    \file "GatCrc16.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    GAT CRC-16 implementations (byte table, slice-by-8, carry-less multiply) and their runtime selection.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatCrc16.hpp"
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#define GAT_CRC16_CLMUL
+#endif
+
+
+// Reflected CRC-16, polynomial 0x8005 (x^16 + x^15 + x^2 + 1).
+static uint16_t const crc16Table[] =
+{
+    0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
+    0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
+    0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
+    0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
+    0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
+    0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
+    0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
+    0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
+    0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
+    0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
+    0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
+    0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
+    0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
+    0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
+    0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
+    0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
+    0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
+    0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
+    0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
+    0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
+    0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+    0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
+    0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
+    0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
+    0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
+    0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
+    0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
+    0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
+    0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
+    0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
+    0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
+    0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040,
+};
+
+
+uint16_t
+gatCrc16Bytewise(void const *data, size_t dataSize, uint16_t seed)
+{
+    uint8_t const *bytes = reinterpret_cast<uint8_t const *>(data);
+    uint16_t crc = seed;
+    for (size_t idx = 0; dataSize > idx; ++idx)
+    {
+        crc = static_cast<uint16_t>((crc >> 8) ^ crc16Table[(crc ^ (static_cast<uint16_t>(bytes[idx]) & 0xff)) & 0xff]);
+    }
+    return crc;
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+/*
+    Slice-by-8: 'table_[n][b]' is the CRC (seed zero) of byte 'b' followed by 'n' zero bytes, so the CRC of eight
+    bytes (with the running CRC xor'ed into the first two) is the xor of one lookup per byte.
+*/
+static struct SliceBy8Tables
+{
+    uint16_t table_[8][256];
+
+    SliceBy8Tables()
+    {
+        for (size_t b = 0; 256 > b; ++b)
+        {
+            table_[0][b] = crc16Table[b];
+        }
+        for (size_t n = 1; 8 > n; ++n)
+        {
+            for (size_t b = 0; 256 > b; ++b)
+            {
+                uint16_t const crc = table_[n - 1][b];
+                table_[n][b] = static_cast<uint16_t>((crc >> 8) ^ crc16Table[crc & 0xff]);
+            }
+        }
+    }
+} const sliceBy8Tables;
+
+
+uint16_t
+gatCrc16SliceBy8(void const *data, size_t dataSize, uint16_t seed)
+{
+    uint8_t const *bytes = reinterpret_cast<uint8_t const *>(data);
+    uint16_t const (*table)[256] = sliceBy8Tables.table_;
+    uint32_t crc = seed;
+
+    for (; 8 <= dataSize; bytes += 8, dataSize -= 8)
+    {
+        // Little endian assembly (not a load) so the result does not depend on the host's byte order.
+        uint32_t const lo = (static_cast<uint32_t>(bytes[0]) << 0) | (static_cast<uint32_t>(bytes[1]) << 8) |
+                            (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+        uint32_t const hi = (static_cast<uint32_t>(bytes[4]) << 0) | (static_cast<uint32_t>(bytes[5]) << 8) |
+                            (static_cast<uint32_t>(bytes[6]) << 16) | (static_cast<uint32_t>(bytes[7]) << 24);
+        uint32_t const x = lo ^ crc;
+        crc = table[7][(x >> 0) & 0xff] ^ table[6][(x >> 8) & 0xff] ^
+              table[5][(x >> 16) & 0xff] ^ table[4][(x >> 24) & 0xff] ^
+              table[3][(hi >> 0) & 0xff] ^ table[2][(hi >> 8) & 0xff] ^
+              table[1][(hi >> 16) & 0xff] ^ table[0][(hi >> 24) & 0xff];
+    }
+
+    return gatCrc16Bytewise(bytes, dataSize, static_cast<uint16_t>(crc));
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+/*
+    Carry-less multiply folding.
+
+    The CRC only depends on the message polynomial modulo the CRC polynomial P, so a leading 128-bit block A
+    followed by 'n' bits may be replaced by any F = A * x^n (mod P) of fewer than 128 bits.  Splitting A into
+    64-bit halves, F = A_hi * (x^(n+64) mod P) + A_lo * (x^n mod P): two 64x16 bit carry-less multiplies per 16
+    bytes.  Four blocks are folded in parallel (n = 512) to hide the multiply latency, the four are folded into
+    one (n = 128), and the remaining 16 bytes plus the tail are finished by slice-by-8.  In the reflected bit
+    order, the leading half (A_hi) is the low quadword, and each constant is one degree less because the reflected
+    product comes out shifted by one bit.
+*/
+
+#ifdef GAT_CRC16_CLMUL
+
+size_t const clmulMinimumSize = 64; // Less is faster by slice-by-8.
+
+
+// Reflected (bit 63 is x^0) x^exponent mod P.
+static uint64_t
+clmulFoldConstant(uint exponent)
+{
+    uint32_t remainder = 1;
+    for (uint idx = 0; exponent > idx; ++idx)
+    {
+        remainder <<= 1;
+        if (0 != (remainder & 0x10000)) { remainder ^= 0x18005; }
+    }
+
+    uint64_t reflected = 0;
+    for (uint degree = 0; 16 > degree; ++degree)
+    {
+        if (0 != (remainder & (1u << degree))) { reflected |= static_cast<uint64_t>(1) << (63 - degree); }
+    }
+    return reflected;
+}
+
+
+static struct ClmulFoldConstants
+{
+    uint64_t fold128_[2]; // Low, high quadword.
+    uint64_t fold512_[2];
+
+    ClmulFoldConstants()
+    {
+        fold128_[0] = clmulFoldConstant(128 + 64 - 1);
+        fold128_[1] = clmulFoldConstant(128 - 1);
+        fold512_[0] = clmulFoldConstant(512 + 64 - 1);
+        fold512_[1] = clmulFoldConstant(512 - 1);
+    }
+} const clmulFoldConstants;
+
+
+__attribute__((target("pclmul,sse2")))
+static inline __m128i
+clmulFold(__m128i block, __m128i constants)
+{
+    return _mm_xor_si128(_mm_clmulepi64_si128(block, constants, 0x00), _mm_clmulepi64_si128(block, constants, 0x11));
+}
+
+
+__attribute__((target("pclmul,sse2")))
+uint16_t
+gatCrc16Clmul(void const *data, size_t dataSize, uint16_t seed)
+{
+    if (clmulMinimumSize > dataSize) { return gatCrc16SliceBy8(data, dataSize, seed); }
+
+    uint8_t const *bytes = reinterpret_cast<uint8_t const *>(data);
+    __m128i const fold128 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(clmulFoldConstants.fold128_));
+    __m128i const fold512 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(clmulFoldConstants.fold512_));
+
+    // The seed is equivalent to a zero seed with the seed xor'ed into the first two bytes.
+    __m128i x0 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const *>(bytes + 0)),
+                               _mm_cvtsi32_si128(seed));
+    __m128i x1 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(bytes + 16));
+    __m128i x2 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(bytes + 32));
+    __m128i x3 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(bytes + 48));
+    bytes += 64;
+    dataSize -= 64;
+
+    for (; 64 <= dataSize; bytes += 64, dataSize -= 64)
+    {
+        x0 = _mm_xor_si128(clmulFold(x0, fold512), _mm_loadu_si128(reinterpret_cast<__m128i const *>(bytes + 0)));
+        x1 = _mm_xor_si128(clmulFold(x1, fold512), _mm_loadu_si128(reinterpret_cast<__m128i const *>(bytes + 16)));
+        x2 = _mm_xor_si128(clmulFold(x2, fold512), _mm_loadu_si128(reinterpret_cast<__m128i const *>(bytes + 32)));
+        x3 = _mm_xor_si128(clmulFold(x3, fold512), _mm_loadu_si128(reinterpret_cast<__m128i const *>(bytes + 48)));
+    }
+
+    __m128i x = _mm_xor_si128(clmulFold(x0, fold128), x1);
+    x = _mm_xor_si128(clmulFold(x, fold128), x2);
+    x = _mm_xor_si128(clmulFold(x, fold128), x3);
+    for (; 16 <= dataSize; bytes += 16, dataSize -= 16)
+    {
+        x = _mm_xor_si128(clmulFold(x, fold128), _mm_loadu_si128(reinterpret_cast<__m128i const *>(bytes)));
+    }
+
+    uint8_t folded[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(folded), x);
+    uint16_t const crc = gatCrc16SliceBy8(folded, sizeof(folded), 0);
+    return gatCrc16SliceBy8(bytes, dataSize, crc);
+}
+
+#else // #ifdef GAT_CRC16_CLMUL
+
+uint16_t
+gatCrc16Clmul(void const *data, size_t dataSize, uint16_t seed)
+{
+    return gatCrc16SliceBy8(data, dataSize, seed); // Never selected (not supported).
+}
+
+#endif // #ifdef GAT_CRC16_CLMUL
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+bool
+gatCrc16ImplSupported(GatCrc16Impl impl)
+{
+    switch (impl)
+    {
+        case GatCrc16Impl::Bytewise: return true;
+        case GatCrc16Impl::SliceBy8: return true;
+#ifdef GAT_CRC16_CLMUL
+        case GatCrc16Impl::Clmul: return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse2");
+#endif
+        default: return false;
+    }
+}
+
+
+gat_crc16_function_type
+gatCrc16Function(GatCrc16Impl impl)
+{
+    if (!gatCrc16ImplSupported(impl)) { return nullptr; }
+
+    switch (impl)
+    {
+        case GatCrc16Impl::Bytewise: return gatCrc16Bytewise;
+        case GatCrc16Impl::SliceBy8: return gatCrc16SliceBy8;
+        case GatCrc16Impl::Clmul: return gatCrc16Clmul;
+        default: return nullptr;
+    }
+}
+
+
+GatCrc16Impl
+gatCrc16SelectedImpl()
+{
+    static GatCrc16Impl const selected = gatCrc16ImplSupported(GatCrc16Impl::Clmul) ? GatCrc16Impl::Clmul
+                                                                                      : GatCrc16Impl::SliceBy8;
+    return selected;
+}
+
+
+char const *
+gatCrc16ImplName(GatCrc16Impl impl)
+{
+    static char const * const names[] = {
+        "bytewise",   // GatCrc16Impl::Bytewise
+        "slice-by-8", // GatCrc16Impl::SliceBy8
+        "clmul",      // GatCrc16Impl::Clmul
+        "undefined",  // GatCrc16Impl::Undefined
+    };
+    Q_ASSERT(arycap(names) == gatCrc16Impl_Count);
+    size_t const idx = (std::min)(static_cast<size_t>(impl), gatCrc16Impl_Count - 1);
+    return names[idx];
+}
+
+
+/*
+    End of "GatCrc16.cpp"
+*/
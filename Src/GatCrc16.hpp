@@ -0,0 +1,61 @@
+/*!
+    \file "GatCrc16.hpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    GAT CRC-16 implementations (byte table, slice-by-8, carry-less multiply) and their runtime selection.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#ifndef GATCRC16_HPP__E49918F8_F0F7_4B37_AD6C_DE98996D97A7__INCLUDED
+#define GATCRC16_HPP__E49918F8_F0F7_4B37_AD6C_DE98996D97A7__INCLUDED
+
+
+#pragma once
+
+
+#include "Defs.hpp"
+
+
+/*
+    All implementations compute the same (reflected, polynomial 0x8005) CRC as the original byte table, and take
+    the same arguments as 'calcGatCrc16()', which calls the fastest one the CPU supports.
+*/
+
+enum class GatCrc16Impl : size_t
+{
+    Bytewise, //!< One table lookup per byte (the reference).
+    SliceBy8, //!< Eight table lookups per eight bytes.
+    Clmul,    //!< Carry-less multiply folding (x86 PCLMULQDQ); slice-by-8 for short data and the tail.
+    Undefined // Must always be last.
+};
+size_t const gatCrc16Impl_Count = static_cast<size_t>(GatCrc16Impl::Undefined) + 1;
+
+typedef uint16_t (*gat_crc16_function_type)(void const *data, size_t dataSize, uint16_t seed);
+
+uint16_t gatCrc16Bytewise(void const *data, size_t dataSize, uint16_t seed);
+uint16_t gatCrc16SliceBy8(void const *data, size_t dataSize, uint16_t seed);
+uint16_t gatCrc16Clmul(void const *data, size_t dataSize, uint16_t seed); //!< Only when supported.
+
+bool gatCrc16ImplSupported(GatCrc16Impl impl); //!< By this CPU.
+gat_crc16_function_type gatCrc16Function(GatCrc16Impl impl); //!< nullptr when not supported.
+GatCrc16Impl gatCrc16SelectedImpl(); //!< The fastest supported (chosen once, at startup).
+char const * gatCrc16ImplName(GatCrc16Impl impl);
+
+
+#endif // #ifndef GATCRC16_HPP__E49918F8_F0F7_4B37_AD6C_DE98996D97A7__INCLUDED
+
+
+/*
+    End of "GatCrc16.hpp"
+*/
@@ -0,0 +1,163 @@
+/*!
+    \file "GatEpollReactor.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Dispatches epoll events for many file descriptors from one Qt event loop.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatEpollReactor.hpp"
+#include <errno.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+
+bool
+GatEpollReactor::open()
+{
+    if (-1 != epollFd_) { return true; }
+
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (-1 == epollFd_)
+    {
+        qWarning() << "epoll_create1() failed: " << errnoToStr(errno);
+        return false;
+    }
+
+    notifier_ = new QSocketNotifier(epollFd_, QSocketNotifier::Read, this);
+    connect(notifier_, SIGNAL(activated(int)), this, SLOT(onActivated(int)));
+
+    return true;
+}
+
+
+void
+GatEpollReactor::close()
+{
+    Q_ASSERT(0 == fileDescriptorCount_);
+
+    if (nullptr != notifier_)
+    {
+        notifier_->setEnabled(false);
+        delete notifier_;
+        notifier_ = nullptr;
+    }
+
+    if (-1 != epollFd_)
+    {
+        ::close(epollFd_);
+        epollFd_ = -1;
+    }
+}
+
+
+bool
+GatEpollReactor::add(int fileDescriptor, uint32_t events, GatEpollHandlerInterface *handler)
+{
+    if (-1 == fileDescriptor || nullptr == handler || !open()) { return false; }
+
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.ptr = handler;
+    if (-1 == epoll_ctl(epollFd_, EPOLL_CTL_ADD, fileDescriptor, &event))
+    {
+        qWarning() << "epoll_ctl(EPOLL_CTL_ADD) failed: " << errnoToStr(errno);
+        return false;
+    }
+
+    ++fileDescriptorCount_;
+
+    return true;
+}
+
+
+bool
+GatEpollReactor::modify(int fileDescriptor, uint32_t events, GatEpollHandlerInterface *handler)
+{
+    if (-1 == fileDescriptor || nullptr == handler || -1 == epollFd_) { return false; }
+
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.ptr = handler;
+    if (-1 == epoll_ctl(epollFd_, EPOLL_CTL_MOD, fileDescriptor, &event))
+    {
+        qWarning() << "epoll_ctl(EPOLL_CTL_MOD) failed: " << errnoToStr(errno);
+        return false;
+    }
+
+    return true;
+}
+
+
+void
+GatEpollReactor::remove(int fileDescriptor)
+{
+    if (-1 == fileDescriptor || -1 == epollFd_) { return; }
+
+    epoll_event event; // Ignored, but must not be null for kernels prior to 2.6.9.
+    memset(&event, 0, sizeof(event));
+    if (0 == epoll_ctl(epollFd_, EPOLL_CTL_DEL, fileDescriptor, &event))
+    {
+        Q_ASSERT(0 < fileDescriptorCount_);
+        --fileDescriptorCount_;
+    }
+}
+
+
+/*!
+    The epoll file descriptor is readable whenever any registered file descriptor has pending events.
+    Everything that is ready is serviced before returning to the event loop.
+*/
+void
+GatEpollReactor::onActivated(int /*socket*/)
+{
+    epoll_event events[64];
+    for (;;)
+    {
+        int const eventCount = epoll_wait(epollFd_, events, static_cast<int>(arycap(events)), 0);
+        if (-1 == eventCount && EINTR == errno) { continue; }
+        if (0 >= eventCount) { break; }
+
+        for (int idx = 0; eventCount > idx; ++idx)
+        {
+            GatEpollHandlerInterface *handler = static_cast<GatEpollHandlerInterface *>(events[idx].data.ptr);
+            try { handler->onEpollEvents(events[idx].events); } catch (...) { qWarning("Unexpected exception caught and discarded in GatEpollReactor::onActivated(int). " STRINGIZE(__LINE__)); }
+        }
+
+        if (static_cast<int>(arycap(events)) > eventCount) { break; }
+    }
+}
+
+
+GatEpollReactor::GatEpollReactor(QObject *parent)
+    : QObject(parent)
+    , epollFd_(-1)
+    , fileDescriptorCount_(0)
+    , notifier_(nullptr)
+{
+    // Do nothing.  The epoll file descriptor is created on first use, in the thread that uses it.
+}
+
+
+GatEpollReactor::~GatEpollReactor()
+{
+    close();
+}
+
+
+/*
+    End of "GatEpollReactor.cpp"
+*/
@@ -0,0 +1,79 @@
+/*!
+    \file "GatEpollReactor.hpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Dispatches epoll events for many file descriptors from one Qt event loop.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#ifndef GATEPOLLREACTOR_HPP__0745F54C_2399_4152_81BE_5409C8272577__INCLUDED
+#define GATEPOLLREACTOR_HPP__0745F54C_2399_4152_81BE_5409C8272577__INCLUDED
+
+
+#pragma once
+
+
+#include "Defs.hpp"
+#include <QObject>
+#include <QSocketNotifier>
+
+
+struct GatEpollHandlerInterface
+{
+    virtual void onEpollEvents(uint32_t events) = 0; //!< 'events' is 'epoll_event::events'.
+};
+
+
+/*!
+    \brief Dispatches epoll events for many file descriptors from one Qt event loop.
+
+    Only the epoll file descriptor is watched by the Qt event loop (via a QSocketNotifier), so the thread wakes once
+    for any number of ready file descriptors, and all of them are serviced in that one wakeup.  The reactor must be
+    used only by the thread that owns it.  The epoll file descriptor is created on first use (in that thread).
+*/
+class GatEpollReactor
+    : public QObject
+{
+    Q_OBJECT
+
+public:
+    bool add(int fileDescriptor, uint32_t events, GatEpollHandlerInterface *handler);
+    bool modify(int fileDescriptor, uint32_t events, GatEpollHandlerInterface *handler);
+    void remove(int fileDescriptor);
+    void close(); //!< Releases the epoll file descriptor; all file descriptors must have been removed.
+
+    GatEpollReactor(QObject *parent = nullptr);
+    virtual ~GatEpollReactor();
+
+protected slots:
+    virtual void onActivated(int socket);
+
+private:
+    bool open();
+
+    int epollFd_;
+    uint fileDescriptorCount_;
+    QSocketNotifier *notifier_;
+
+    GatEpollReactor(GatEpollReactor const&) = delete; //!< No cloning; leave unimplemented!
+    GatEpollReactor& operator=(GatEpollReactor const&) = delete; //!< No cloning; leave unimplemented!
+};
+
+
+#endif // #ifndef GATEPOLLREACTOR_HPP__0745F54C_2399_4152_81BE_5409C8272577__INCLUDED
+
+
+/*
+    End of "GatEpollReactor.hpp"
+*/
@@ -18,7 +18,9 @@
 
 
 #include "GatHost.hpp"
+#include "GatPkt_StatusQueryRslt_SR81.hpp"
 #include <QApplication>
+#include <QWaitCondition>
 /*
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -27,11 +29,43 @@
 */
 
 
+const uint roundTripProbeCount = 5; // Status queries per round-trip measurement (see 'GatHostRoundTripCmd').
+
+
+/*!
+    \brief The state shared by the copies of a 'GatCmdFuture' (and its command, which finishes it).
+
+    Guarded by its own mutex, since client threads wait on it while the thread of the host finishes it.
+*/
+class GatCmdFutureState
+    : public std::enable_shared_from_this<GatCmdFutureState>
+{
+public:
+    typedef std::shared_ptr<GatCmdFutureState> ptr_type;
+
+    void finish(GatCmdFuture::result_type result); //!< The first call only; runs the continuations.
+    void addInput(GatCmdFuture const &input); //!< Canceled with this (at once, when this was canceled already).
+    void cancel();
+    bool isCanceled() const;
+
+    GatCmdFuture future(); //!< Of this state (and its command, if still alive).
+
+    mutable QMutex guard_;
+    QWaitCondition finished_;
+    GatCmdFuture::result_type result_;
+    std::vector<GatCmdFuture::continuation_type> continuations_; // Until finished.
+    std::weak_ptr<GatHostCmd> cmd_; // Of a command's future (the future keeps the command alive, not this).
+    GatCmdFuture::futures_type inputs_; // Of a combined future.
+    bool canceled_;
+    size_t pendingInputCount_; // See 'GatCmdFuture::whenAll()'.
+
+    GatCmdFutureState() : result_(GatCmdFuture::result_type::Undefined), canceled_(false), pendingInputCount_(0) {}
+};
+
+
 void
 GatHostCmd::begin()
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
     setCmdState(CmdState::Started);
 }
 
@@ -39,8 +73,6 @@ GatHostCmd::begin()
 void
 GatHostCmd::cancel()
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
     setCmdState(CmdState::Canceled);
 }
 
@@ -48,45 +80,44 @@ GatHostCmd::cancel()
 void
 GatHostCmd::fail()
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
     setCmdState(CmdState::Failed);
 }
 
 
 void
-GatHostCmd::processGmResponse(uint8_t const *data, size_t dataSize)
+GatHostCmd::processGmResponse(GatByteChain const &response)
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
-    if (nullptr != data && 0 < dataSize)
-    {
-        Q_ASSERT(sizeof(char) == sizeof(uint8_t));
-        setLastGatOpResult(QByteArray(reinterpret_cast<char const *>(static_cast<uchar const *>(data)), dataSize));
-    }
-    else
-    {
-        setLastGatOpResult(QByteArray());
-    }
+    setLastGatOpResult(response);
     setCmdState(CmdState::Completed);
 }
 
 
+void
+GatHostCmd::scheduleCancel()
+{
+    // Post an event to this to invoke a DPC (in the thread of this command; see 'GatPort::schedule()').
+    QEvent *event = new QEvent(static_cast<QEvent::Type>(ELocalEventType::CancelThisDpc));
+    QApplication::postEvent(this, event);
+}
+
+
 QByteArray
 GatHostCmd::lastGatOpResult() const
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
+    return operationResult_.toByteArray(); // The only copy of the reply data.
+}
 
-    return QByteArray(operationResult_.constData(), operationResult_.size()); // Clone return value!
+
+GatByteChain
+GatHostCmd::lastGatOpResultChain() const
+{
+    return operationResult_; // References (counted atomically), not bytes.
 }
 
 
 QString
 GatHostCmd::gatSpecialFunctionName() const
 {
-    // No need to enter synchronization domain for this particular method implementation.
-    //QMutexLocker syncDomainLock(SyncDomainGuard());
-
     return "GAT Command";
 }
 
@@ -94,8 +125,7 @@ GatHostCmd::gatSpecialFunctionName() const
 GatLinkLayer::RequestResult
 GatHostCmd::sendRequest(GatRqst gatRequest, void const *data, uint dataSize)
 {
-    GatHostPrivilegesForGatHostCmdInterface *priv = static_cast<GatHostPrivilegesForGatHostCmdInterface *>(&host());
-    GatLinkLayer::RequestResult const result = priv->gatLinkLayer().sendRequest(gatRequest, data, dataSize);
+    GatLinkLayer::RequestResult const result = hostPrivileges().gatLinkLayer().sendRequest(gatRequest, data, dataSize);
     bool const failedToTransmit = GatLinkLayer::RequestResult::Success != result &&
                                   GatLinkLayer::RequestResult::Pending != result;
     if (failedToTransmit) { scheduleFailureDpc(); }
@@ -122,14 +152,18 @@ GatHostCmd::customEvent(QEvent *event)
     {
         setCmdState(CmdState::Failed);
     }
+    else if (nullptr != event &&
+             static_cast<uint>(ELocalEventType::CancelThisDpc) == static_cast<uint>(event->type()))
+    {
+        // A command may finish before the DPC runs; a queued one is skipped once canceled (see 'startNextGatCmd()').
+        if (!isFinished()) { cancel(); }
+    }
 }
 
 
 GatHostCmd::CmdState
 GatHostCmd::setCmdState(CmdState value)
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
     if (cmdState() != value)
     {
         cmdState_ = value;
@@ -149,12 +183,23 @@ GatHostCmd::setCmdState(CmdState value)
                  << ")";
 #endif // #ifdef DEBUG
         onCmdStateChanged();
+
+        // After the subclass has seen the state (e.g. taken the results), and only the first final state.
+        if (isFinished()) { futureState_->finish(cmdState_); }
     }
 
     return cmdState_;
 }
 
 
+bool
+GatHostCmd::isFinished() const
+{
+    CmdState const state = cmdState_;
+    return CmdState::Started != state && CmdState::Undefined != state;
+}
+
+
 void
 GatHostCmd::onCmdStateChanged()
 {
@@ -165,8 +210,6 @@ GatHostCmd::onCmdStateChanged()
 void
 GatHostCmd::onLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer::StateId state)
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
     /*
         This logic is for a _single_ packet command with a _single_ packet reply, e.g. "IACQ(0x04)/IACR(0x84)".
         Special functions require the use of CGatHostSpecialFxnCmd, which should be inherited.
@@ -205,7 +248,7 @@ GatHostCmd::onLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer::StateId st
                 }
                 else
                 {
-                    processGmResponse(reinterpret_cast<uint8_t const *>(reply.first), reply.second);
+                    processGmResponse(GatByteChain(host->replyView()));
                 }
                 break;
             }
@@ -214,40 +257,315 @@ GatHostCmd::onLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer::StateId st
 }
 
 
-GatHostCmd::GatHostCmd(GatHost &gatHost)
+GatHostCmd::GatHostCmd(GatHostPrivilegesForGatHostCmdInterface &gatHost)
     : cmdState_(CmdState::Undefined)
+    , futureState_(std::make_shared<GatCmdFutureState>())
+    , priority_(Priority::Normal)
+    , schedulingFlags_(NoSchedulingFlags)
     , host_(gatHost)
 {
-    { // Subscribe to signals from 'CGatLinkLayer'.
-        QMutexLocker syncDomainLock(host().syncDomainGuard());
-        connect(&hostPrivileges().gatLinkLayer(),
-                SIGNAL(stateChanged(GatLinkLayer*, GatLinkLayer::StateId)),
-                this,
-                SLOT(onLinkLayerStateChanged(GatLinkLayer*, GatLinkLayer::StateId)));
-    }
+    // Subscribe to signals from 'GatLinkLayer' (delivered in this command's thread; only a started one acts on them).
+    connect(&hostPrivileges().gatLinkLayer(),
+            SIGNAL(stateChanged(GatLinkLayer*, GatLinkLayer::StateId)),
+            this,
+            SLOT(onLinkLayerStateChanged(GatLinkLayer*, GatLinkLayer::StateId)));
 }
 
 
 GatHostCmd::~GatHostCmd()
 {
-    { // Unsubscribe from signals from 'CGatLinkLayer'.
-        QMutexLocker syncDomainLock(host().syncDomainGuard());
-        disconnect(&hostPrivileges().gatLinkLayer(),
-                   SIGNAL(stateChanged(GatLinkLayer*, GatLinkLayer::StateId)),
-                   this,
-                   SLOT(onLinkLayerStateChanged(GatLinkLayer*, GatLinkLayer::StateId)));
+    // Unsubscribe from signals from 'GatLinkLayer'.
+    disconnect(&hostPrivileges().gatLinkLayer(),
+               SIGNAL(stateChanged(GatLinkLayer*, GatLinkLayer::StateId)),
+               this,
+               SLOT(onLinkLayerStateChanged(GatLinkLayer*, GatLinkLayer::StateId)));
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+void
+GatCmdFutureState::finish(GatCmdFuture::result_type result)
+{
+    std::vector<GatCmdFuture::continuation_type> continuations;
+    {
+        QMutexLocker guardLock(&guard_);
+        if (GatCmdFuture::result_type::Undefined != result_) { return; }
+        result_ = result;
+        continuations.swap(continuations_);
+        inputs_.clear(); // All finished (or no longer awaited); release their commands.
+        finished_.wakeAll();
+    }
+
+    // Continuations may combine this future again (and so take its lock).
+    GatCmdFuture const finishedFuture = future();
+    for (GatCmdFuture::continuation_type const &continuation : continuations)
+    {
+        try { continuation(finishedFuture); } catch (...) { qWarning("Unexpected exception caught and discarded in GatCmdFutureState::finish(GatCmdFuture::result_type). " STRINGIZE(__LINE__)); }
+    }
+}
+
+
+void
+GatCmdFutureState::addInput(GatCmdFuture const &input)
+{
+    bool canceled = false;
+    {
+        QMutexLocker guardLock(&guard_);
+        if (GatCmdFuture::result_type::Undefined != result_) { return; }
+        inputs_.push_back(input);
+        canceled = canceled_;
+    }
+    if (canceled) { input.cancel(); }
+}
+
+
+void
+GatCmdFutureState::cancel()
+{
+    GatCmdFuture::futures_type inputs;
+    std::shared_ptr<GatHostCmd> cmd;
+    {
+        QMutexLocker guardLock(&guard_);
+        if (GatCmdFuture::result_type::Undefined != result_) { return; }
+        canceled_ = true;
+        inputs = inputs_;
+        cmd = cmd_.lock();
     }
+    if (nullptr != cmd) { cmd->scheduleCancel(); }
+    for (GatCmdFuture const &input : inputs) { input.cancel(); }
+}
+
+
+bool
+GatCmdFutureState::isCanceled() const
+{
+    QMutexLocker guardLock(&guard_);
+    return canceled_;
+}
+
+
+GatCmdFuture
+GatCmdFutureState::future()
+{
+    GatCmdFuture future(shared_from_this());
+    future.cmd_ = cmd_.lock();
+    return future;
 }
 
 
 // [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
 
 
+bool
+GatCmdFuture::isFinished() const
+{
+    return GatHostCmd::CmdState::Undefined != result();
+}
+
+
+auto
+GatCmdFuture::result() const -> result_type
+{
+    if (!isValid()) { return result_type::Undefined; }
+
+    QMutexLocker guardLock(&state_->guard_);
+    return state_->result_;
+}
+
+
+auto
+GatCmdFuture::wait() const -> result_type
+{
+    if (!isValid()) { return result_type::Undefined; }
+
+    QMutexLocker guardLock(&state_->guard_);
+    while (result_type::Undefined == state_->result_) { state_->finished_.wait(&state_->guard_); }
+    return state_->result_;
+}
+
+
+bool
+GatCmdFuture::wait(uint timeoutInMilliseconds) const
+{
+    if (!isValid()) { return false; }
+
+    uint32_t const startTime = monotonicClock32();
+    QMutexLocker guardLock(&state_->guard_);
+    while (result_type::Undefined == state_->result_)
+    {
+        uint const elapsed = monotonicClock32() - startTime;
+        if (elapsed >= timeoutInMilliseconds) { return false; }
+        state_->finished_.wait(&state_->guard_, timeoutInMilliseconds - elapsed);
+    }
+    return true;
+}
+
+
 void
-GatHostSpecialFxnCmd::begin()
+GatCmdFuture::onFinished(continuation_type continuation) const
+{
+    if (!isValid() || !continuation) { return; }
+
+    {
+        QMutexLocker guardLock(&state_->guard_);
+        if (result_type::Undefined == state_->result_)
+        {
+            state_->continuations_.push_back(continuation);
+            return;
+        }
+    }
+    try { continuation(*this); } catch (...) { qWarning("Unexpected exception caught and discarded in GatCmdFuture::onFinished(continuation_type). " STRINGIZE(__LINE__)); }
+}
+
+
+GatCmdFuture
+GatCmdFuture::then(next_type next) const
+{
+    if (!isValid()) { return GatCmdFuture(); }
+
+    // The chained future waits for this one, then for the one 'next' returns.  Its continuations only refer to it
+    // weakly: when no one holds it any more, the chain runs all the same (it is owned by the futures it waits for).
+    GatCmdFutureState::ptr_type const chained = std::make_shared<GatCmdFutureState>();
+    chained->addInput(*this);
+    std::weak_ptr<GatCmdFutureState> const weakChained(chained);
+    onFinished([weakChained, next](GatCmdFuture const &finished) {
+        GatCmdFuture following;
+        GatCmdFutureState::ptr_type chained = weakChained.lock();
+        bool const canceled = nullptr != chained && chained->isCanceled();
+        if (result_type::Completed == finished.result() && next && !canceled)
+        {
+            try { following = next(finished); } catch (...) { qWarning("Unexpected exception caught and discarded in GatCmdFuture::then(next_type). " STRINGIZE(__LINE__)); }
+        }
+        if (nullptr == chained) { return; }
+        if (!following.isValid()) { chained->finish(canceled ? result_type::Canceled : finished.result()); return; }
+
+        chained->addInput(following);
+        chained.reset();
+        following.onFinished([weakChained](GatCmdFuture const &followed) {
+            GatCmdFutureState::ptr_type const chained = weakChained.lock();
+            if (nullptr != chained) { chained->finish(followed.result()); }
+        });
+    });
+
+    return GatCmdFuture(chained);
+}
+
+
+GatCmdFuture
+GatCmdFuture::whenAll(futures_type const &futures)
+{
+    GatCmdFutureState::ptr_type const joined = std::make_shared<GatCmdFutureState>();
+    futures_type inputs;
+    for (GatCmdFuture const &future : futures)
+    {
+        if (future.isValid()) { inputs.push_back(future); }
+    }
+    joined->pendingInputCount_ = inputs.size();
+    for (GatCmdFuture const &input : inputs) { joined->addInput(input); }
+    if (inputs.empty()) { joined->finish(result_type::Completed); }
+
+    // Finished by the last input to finish (in whatever thread), from the inputs in their given order.
+    std::weak_ptr<GatCmdFutureState> const weakJoined(joined);
+    for (GatCmdFuture const &input : inputs)
+    {
+        input.onFinished([weakJoined](GatCmdFuture const &) {
+            GatCmdFutureState::ptr_type const joined = weakJoined.lock();
+            if (nullptr == joined) { return; }
+            futures_type inputs;
+            {
+                QMutexLocker guardLock(&joined->guard_);
+                if (0 != --joined->pendingInputCount_) { return; }
+                inputs = joined->inputs_;
+            }
+            result_type result = result_type::Completed;
+            for (GatCmdFuture const &input : inputs)
+            {
+                if (result_type::Completed != input.result()) { result = input.result(); break; }
+            }
+            joined->finish(result);
+        });
+    }
+
+    return GatCmdFuture(joined);
+}
+
+
+GatCmdFuture
+GatCmdFuture::whenAny(futures_type const &futures)
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
+    GatCmdFutureState::ptr_type const joined = std::make_shared<GatCmdFutureState>();
+    futures_type inputs;
+    for (GatCmdFuture const &future : futures)
+    {
+        if (future.isValid()) { inputs.push_back(future); }
+    }
+    if (inputs.empty()) { return GatCmdFuture(); }
+    for (GatCmdFuture const &input : inputs) { joined->addInput(input); }
+
+    // The others run on (cancel the returned future to cancel them too).
+    std::weak_ptr<GatCmdFutureState> const weakJoined(joined);
+    for (GatCmdFuture const &input : inputs)
+    {
+        input.onFinished([weakJoined](GatCmdFuture const &finished) {
+            GatCmdFutureState::ptr_type const joined = weakJoined.lock();
+            if (nullptr != joined) { joined->finish(finished.result()); }
+        });
+    }
+
+    return GatCmdFuture(joined);
+}
+
+
+void
+GatCmdFuture::cancel() const
+{
+    if (isValid()) { state_->cancel(); }
+}
+
+
+GatCmdFuture::GatCmdFuture(std::shared_ptr<GatHostCmd> const &cmd)
+    : state_(nullptr == cmd ? std::shared_ptr<GatCmdFutureState>() : cmd->futureState_)
+    , cmd_(cmd)
+{
+    if (isValid())
+    {
+        QMutexLocker guardLock(&state_->guard_);
+        state_->cmd_ = cmd;
+    }
+}
+
+
+GatCmdFuture::GatCmdFuture(std::shared_ptr<GatCmdFutureState> const &state)
+    : state_(state)
+{
+    // Do nothing.
+}
+
 
+#ifdef ENABLE_GAT_COROUTINES
+bool
+GatCmdFutureAwaiter::await_suspend(GatTask::handle_type coroutine)
+{
+    if (!future_.isValid()) { return false; } // Never finishes.
+
+    lifetime_type const lifetime = beginSuspend(coroutine);
+    future_.onFinished([this, lifetime](GatCmdFuture const &) {
+        if (lifetime.expired()) { return; }
+        complete();
+    });
+    return endSuspend();
+}
+#endif // #ifdef ENABLE_GAT_COROUTINES
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+void
+GatHostSpecialFxnCmd::begin()
+{
     // Get parameters for special function.
     QStringList params;
     gatSpecFxnParams(params);
@@ -262,8 +580,6 @@ GatHostSpecialFxnCmd::begin()
 void
 GatHostSpecialFxnCmd::onLinkLayerStateChanged(GatLinkLayer * /*host*/, GatLinkLayer::StateId /*state*/)
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
 //! \todo I don't like this design.  Revisit and refactor.
 
     // Do nothing.  Shunt base class functionality.
@@ -275,8 +591,6 @@ void
 GatHostSpecialFxnCmd::onSpecialFunctionExecStateChanged(GatSpecialFunctionExec * /*host*/,
                                                         GatSpecialFunctionExec::StateId newState)
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
     /*
         This logic is for a special function.  Single packet replies require the use of CGatHostCmd.
     */
@@ -309,15 +623,7 @@ GatHostSpecialFxnCmd::onSpecialFunctionExecStateChanged(GatSpecialFunctionExec *
 
             case GatSpecialFunctionExec::StateId::ReplyReady:
             {
-                GatSpecialFunctionExec::reply_type reply(specialFxnExec_.reply());
-                if (nullptr == reply.first && 0 < reply.second) // Implementation error.
-                {
-                    setCmdState(CmdState::Failed);
-                }
-                else
-                {
-                    processGmResponse(reinterpret_cast<uint8_t const *>(reply.first), reply.second);
-                }
+                processGmResponse(specialFxnExec_.reply());
                 break;
             }
         }
@@ -328,13 +634,11 @@ GatHostSpecialFxnCmd::onSpecialFunctionExecStateChanged(GatSpecialFunctionExec *
 QString
 GatHostSpecialFxnCmd::gatSpecialFunctionName() const
 {
-    //QMutexLocker syncDomainLock(SyncDomainGuard());
-
     return "Special Function";
 }
 
 
-GatHostSpecialFxnCmd::GatHostSpecialFxnCmd(GatHost &host)
+GatHostSpecialFxnCmd::GatHostSpecialFxnCmd(GatHostPrivilegesForGatHostCmdInterface &host)
     : GatHostCmd(host)
 {
     specialFxnExec_.setParent(this);
@@ -350,8 +654,11 @@ GatHostSpecialFxnCmd::GatHostSpecialFxnCmd(GatHost &host)
     // Subscribe to signals from 'GatMultipktRply'.
     connect(&specialFxnExec_, SIGNAL(specialFunctionExecStateChanged(GatSpecialFunctionExec *, GatSpecialFunctionExec::StateId)),
             this, SLOT(onSpecialFunctionExecStateChanged(GatSpecialFunctionExec *, GatSpecialFunctionExec::StateId)));
+    connect(&specialFxnExec_, SIGNAL(calculationProgress(GatSpecialFunctionExec *, uint, uint)),
+            this, SLOT(onCalculationProgress(GatSpecialFunctionExec *, uint, uint)));
 
-    specialFxnExec_.setLinkLayer(&static_cast<GatHostPrivilegesForGatHostCmdInterface &>(host).gatLinkLayer());
+    specialFxnExec_.setLinkLayer(&host.gatLinkLayer());
+    specialFxnExec_.setStatusQueries(&host.gatPort().statusQueries());
 }
 
 
@@ -360,6 +667,8 @@ GatHostSpecialFxnCmd::~GatHostSpecialFxnCmd()
     // Unsubscribe from signals from 'CGatMultipktRply'.
     disconnect(&specialFxnExec_, SIGNAL(specialFunctionExecStateChanged(GatSpecialFunctionExec *, GatSpecialFunctionExec::StateId)),
                this, SLOT(onSpecialFunctionExecStateChanged(GatSpecialFunctionExec *, GatSpecialFunctionExec::StateId)));
+    disconnect(&specialFxnExec_, SIGNAL(calculationProgress(GatSpecialFunctionExec *, uint, uint)),
+               this, SLOT(onCalculationProgress(GatSpecialFunctionExec *, uint, uint)));
 }
 
 
@@ -369,8 +678,6 @@ GatHostSpecialFxnCmd::~GatHostSpecialFxnCmd()
 void
 GatHostGetSpecialFunctionsCmd::gatSpecFxnParams(QStringList &result)
 {
-    //QMutexLocker syncDomainLock(SyncDomainGuard());
-
     result.append("Get Special Functions");
 }
 
@@ -378,8 +685,6 @@ GatHostGetSpecialFunctionsCmd::gatSpecFxnParams(QStringList &result)
 QString
 GatHostGetSpecialFunctionsCmd::gatSpecialFunctionName() const
 {
-    //QMutexLocker syncDomainLock(SyncDomainGuard());
-
     return "Get Special Functions";
 }
 
@@ -390,8 +695,6 @@ GatHostGetSpecialFunctionsCmd::gatSpecialFunctionName() const
 void
 GatHostGetFileCmd::gatSpecFxnParams(QStringList &result)
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
     result.append("Get File");
     result.append(fileName());
     result.append(params());
@@ -401,8 +704,6 @@ GatHostGetFileCmd::gatSpecFxnParams(QStringList &result)
 QString
 GatHostGetFileCmd::gatSpecialFunctionName() const
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
     return QString("Get File ") + fileName_;
 }
 
@@ -410,8 +711,6 @@ GatHostGetFileCmd::gatSpecialFunctionName() const
 QStringList
 GatHostGetFileCmd::params() const
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
     QStringList result;
     for (auto iter = params_.begin(); params_.end() != iter; ++iter)
     {
@@ -442,8 +741,6 @@ GatHostGetFileCmd::fileName(FileName fileName)
 void
 GatHostGetComponentCmd::gatSpecFxnParams(QStringList &result)
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
     result.append("Component");
     result.append(componentName());
     result.append(params());
@@ -453,8 +750,6 @@ GatHostGetComponentCmd::gatSpecFxnParams(QStringList &result)
 QString
 GatHostGetComponentCmd::gatSpecialFunctionName() const
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
     return QString("Component ") + componentName_;
 }
 
@@ -462,8 +757,6 @@ GatHostGetComponentCmd::gatSpecialFunctionName() const
 QStringList
 GatHostGetComponentCmd::params() const
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
     QStringList result;
     for (auto iter = params_.begin(); params_.end() != iter; ++iter)
     {
@@ -478,157 +771,1272 @@ GatHostGetComponentCmd::params() const
 
 
 void
-GatHost::schedule(gat_host_cmd_ptr_type operationCommand)
+GatHostBatchSpecialFxnCmd::begin()
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
+    stepIdx_ = 0;
+    stepResults_.clear();
+    bool const stepsValid = !steps_.empty() &&
+                            steps_.end() == std::find_if(steps_.begin(), steps_.end(), [](Step const &step) -> bool {
+                                return StepKind::Undefined <= step.kind_; });
+    if (!stepsValid) { fail(); return; }
+
+    GatHostSpecialFxnCmd::begin(); // The first step.
+}
+
 
-    // Queue the command.
-    operationCommand->moveToThread(this);
-    cmds_.push_back(operationCommand);
-    scheduleCmdQueueService();
+QString
+GatHostBatchSpecialFxnCmd::gatSpecialFunctionName() const
+{
+    return QString("Batch of %1 special functions").arg(steps_.size());
 }
 
 
-void
-GatHost::failPendingGatCmds(uint commandCountToLeaveInQueue)
+auto
+GatHostBatchSpecialFxnCmd::steps() const -> steps_type
 {
-    // Purge and fail all but the last command in the queue (only one can be in progress at a time).
-    while (cmds_.size() > commandCountToLeaveInQueue)
-    {
-        gat_host_cmd_ptr_type cmd = cmds_.front();
-        cmds_.pop_front();
-        try { cmd->fail(); } catch (...) { qWarning("Unexpected exception caught and discarded in CGatHost::customEvent(QEvent *). " STRINGIZE(__LINE__)); }
-    }
+    return steps_;
 }
 
 
-void
-GatHost::cleanupAllGatCommands() throw()
+auto
+GatHostBatchSpecialFxnCmd::stepResults() const -> step_results_type
 {
-    try { cancelGatCmdInPgrs(); } catch (...) { }
-    try { failPendingGatCmds(); } catch (...) { }
+    return stepResults_;
 }
 
 
 void
-GatHost::scheduleCmdQueueService()
+GatHostBatchSpecialFxnCmd::gatSpecFxnParams(QStringList &result)
 {
-    if (!cmds_.empty())
+    if (steps_.size() <= stepIdx_) { return; }
+
+    Step const &step = steps_[stepIdx_];
+    switch (step.kind_)
     {
-        // Post an event to this to invoke a DPC for operation command processing.
-        QEvent *event = new QEvent(static_cast<QEvent::Type>(LocalEventType::CmdQueueChanged));
-        QApplication::postEvent(this, event);
+        default: return; // Prevent compiler warning ('begin()' rejects these).
+        case StepKind::Component: result.append("Component"); break;
+        case StepKind::GetFile:   result.append("Get File"); break;
     }
+    result.append(step.name_);
+    result.append(step.params_);
 }
 
 
 void
-GatHost::onGatHostCmdStateChanged(GatHostCmd *cmd, GatHostCmd::CmdState cmdState)
+GatHostBatchSpecialFxnCmd::onSpecialFunctionExecStateChanged(GatSpecialFunctionExec * /*host*/,
+                                                             GatSpecialFunctionExec::StateId newState)
 {
-    switch (cmdState)
+    if (CmdState::Started == cmdState())
     {
-        case GatHostCmd::CmdState::Canceled:
-        case GatHostCmd::CmdState::Failed_Timeout:
-        case GatHostCmd::CmdState::Failed:
-        case GatHostCmd::CmdState::Completed:
+        switch (newState)
         {
-            if (cmdInProgress_.get() == cmd)
+            case GatSpecialFunctionExec::StateId::Ready:
+            case GatSpecialFunctionExec::StateId::Requesting:
+            case GatSpecialFunctionExec::StateId::WaitingForReply:
+            case GatSpecialFunctionExec::StateId::ReceivingReply:
+                // Do nothing.  These link layer states can be ignored here.
+                break;
+
+            default:
+            case GatSpecialFunctionExec::StateId::Undefined: // Unexpected link layer state.
+            case GatSpecialFunctionExec::StateId::RequestFailed:
+            case GatSpecialFunctionExec::StateId::ReplyFailed:
             {
-                // Schedule DPC.
-                QEvent *event = new QEvent(static_cast<QEvent::Type>(LocalEventType::ReleaseCmdInPgrs));
-                QApplication::postEvent(this, event);
+                finishStep(CmdState::Failed, GatByteChain());
+                break;
             }
-            else
+
+            case GatSpecialFunctionExec::StateId::RequestFailed_Timeout:
+            case GatSpecialFunctionExec::StateId::ReplyUnavailable_Timeout:
             {
-                cmds_type::iterator iter = std::find_if(cmds_.begin(), cmds_.end(),
-                    [cmd](gat_host_cmd_ptr_type& a) -> bool { return a.get() == cmd; });
-                if (cmds_.end() != iter) { cmds_.erase(iter); }
+                finishStep(CmdState::Failed_Timeout, GatByteChain());
+                break;
+            }
+
+            case GatSpecialFunctionExec::StateId::ReplyReady:
+            {
+                finishStep(CmdState::Completed, gatSpecialFunctionExec().reply());
+                break;
             }
-            break;
         }
-        default: break; // Prevent compiler warning.
     }
 }
 
 
 void
-GatHost::customEvent(QEvent *event)
+GatHostBatchSpecialFxnCmd::finishStep(CmdState stepCmdState, GatByteChain const &reply)
 {
-    QThread::customEvent(event);
+    StepResult stepResult;
+    stepResult.cmdState_ = stepCmdState;
+    stepResult.reply_ = reply;
+    stepResults_.push_back(stepResult);
+    ++stepIdx_;
 
-    if (nullptr != event)
-    {
-        if (static_cast<uint>(LocalEventType::CmdQueueChanged) == static_cast<uint>(event->type()))
-        {
-            if (!cmds_.empty())
-            {
-                // If a command is in progress, cancel it.
-                cancelGatCmdInPgrs();
+    bool const stop = steps_.size() <= stepIdx_ || (CmdState::Completed != stepCmdState && stopOnFailure_);
+    if (stop) { finishBatch(); return; }
 
-                // Purge and fail all but the last command in the queue (only one can be in progress at a time).
-                failPendingGatCmds(1);
+    // Begin the next step from a DPC, once the special function state machine is ready again.
+    QEvent *event = new QEvent(static_cast<QEvent::Type>(LocalEventType::BeginNextStepDpc));
+    QApplication::postEvent(this, event);
+}
 
-                // Remove the last command from the queue, make it current, and start it.
-                Q_ASSERT(!cmds_.empty());
-                if (!cmds_.empty())
-                {
-                    cmdInProgress_ = cmds_.front();
-                    cmds_.pop_front();
-                    connect(cmdInProgress_.get(), SIGNAL(gatHostCmdStateChanged(GatHostCmd *, GatHostCmd::CmdState)),
-                            this, SLOT(onGatHostCmdStateChanged(GatHostCmd *, GatHostCmd::CmdState)));
-                    try { cmdInProgress_->begin(); } catch (...) { qWarning("Unexpected exception caught and discarded in CGatHost::customEvent(QEvent *). " STRINGIZE(__LINE__)); }
-                }
 
-                // Failsafe (to ensure queue never stalls).
-                if (!cmds_.empty()) { scheduleCmdQueueService(); }
-            }
-        }
-        else if (static_cast<uint>(LocalEventType::ReleaseCmdInPgrs) == static_cast<uint>(event->type()))
-        {
-            cmdInProgress_.reset();
-        }
+void
+GatHostBatchSpecialFxnCmd::finishBatch()
+{
+    GatByteChain replies;
+    CmdState batchCmdState = CmdState::Completed;
+    for (StepResult const &stepResult : stepResults_)
+    {
+        replies.append(stepResult.reply_);
+        if (CmdState::Completed == batchCmdState) { batchCmdState = stepResult.cmdState_; }
     }
+
+    setLastGatOpResult(replies);
+    setCmdState(batchCmdState);
 }
 
 
 void
-GatHost::cancelGatCmdInPgrs()
+GatHostBatchSpecialFxnCmd::customEvent(QEvent *event)
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
+    GatHostSpecialFxnCmd::customEvent(event);
 
-    if (nullptr != cmdInProgress_.get())
+    if (nullptr != event &&
+        static_cast<uint>(LocalEventType::BeginNextStepDpc) == static_cast<uint>(event->type()))
     {
-        disconnect(cmdInProgress_.get(), SIGNAL(gatHostCmdStateChanged(GatHostCmd *, GatHostCmd::CmdState)),
-                   this, SLOT(onGatHostCmdStateChanged(GatHostCmd *, GatHostCmd::CmdState)));
-        try { cmdInProgress_->cancel(); } catch (...) { qWarning("Unexpected exception caught and discarded in CGatHost::customEvent(QEvent *). " STRINGIZE(__LINE__)); }
-        try { cmdInProgress_.reset(); } catch (...) { qWarning("Unexpected exception caught and discarded in CGatHost::customEvent(QEvent *). " STRINGIZE(__LINE__)); }
+        if (CmdState::Started != cmdState()) { return; } // Canceled meanwhile.
+
+        QStringList params;
+        gatSpecFxnParams(params);
+        if (!gatSpecialFunctionExec().sendRequest(params)) { finishStep(CmdState::Failed, GatByteChain()); }
     }
 }
 
 
-uint
-GatHost::write(GatLinkLayer & /*host*/, void const *data, uint dataSizeInBytes)
+GatHostBatchSpecialFxnCmd::GatHostBatchSpecialFxnCmd(GatHostPrivilegesForGatHostCmdInterface &host,
+                                                     steps_type const &steps, bool stopOnFailure)
+    : GatHostSpecialFxnCmd(host)
+    , steps_(steps)
+    , stopOnFailure_(stopOnFailure)
+    , stepIdx_(0)
+{
+    // Do nothing.
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+void
+GatHostStatusQueryCmd::begin()
+{
+    // Started first: a fresh reply is delivered before 'query()' returns.
+    setCmdState(CmdState::Started);
+    using namespace std::placeholders;
+    subscription_ = port().statusQueries().query(std::bind(&GatHostStatusQueryCmd::onStatusQueryReply, this, _1, _2));
+}
+
+
+void
+GatHostStatusQueryCmd::cancel()
+{
+    unsubscribe();
+    GatHostCmd::cancel();
+}
+
+
+QString
+GatHostStatusQueryCmd::gatSpecialFunctionName() const
+{
+    return "Status Query";
+}
+
+
+void
+GatHostStatusQueryCmd::onLinkLayerStateChanged(GatLinkLayer * /*host*/, GatLinkLayer::StateId /*state*/)
+{
+    // Do nothing.  Shunt base class functionality; the reply (maybe to another command's query) is delivered to
+    // 'onStatusQueryReply()'.
+}
+
+
+void
+GatHostStatusQueryCmd::onStatusQueryReply(GatLinkLayer::ResultType resultType, GatByteView const &reply)
+{
+    subscription_ = 0;
+    if (CmdState::Started != cmdState()) { return; }
+
+    switch (resultType)
+    {
+        case GatLinkLayer::ResultType::Reply:
+        {
+            processGmResponse(GatByteChain(reply));
+            break;
+        }
+
+        case GatLinkLayer::ResultType::Timeout:
+        {
+            setCmdState(CmdState::Failed_Timeout);
+            break;
+        }
+
+        default:
+        {
+            setCmdState(CmdState::Failed);
+            break;
+        }
+    }
+}
+
+
+void
+GatHostStatusQueryCmd::unsubscribe()
+{
+    if (0 != subscription_) { port().statusQueries().unsubscribe(subscription_); }
+    subscription_ = 0;
+}
+
+
+GatHostStatusQueryCmd::GatHostStatusQueryCmd(GatHostPrivilegesForGatHostCmdInterface &host)
+    : GatHostCmd(host)
+    , subscription_(0)
+{
+    setPriority(Priority::High);
+}
+
+
+GatHostStatusQueryCmd::~GatHostStatusQueryCmd()
+{
+    unsubscribe(); // Its reply would otherwise be delivered to this (destroyed) command.
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+#ifdef ENABLE_GAT_COROUTINES
+void
+GatHostCoroutineCmd::begin()
+{
+    // Started first: the coroutine may finish before it first suspends.
+    setCmdState(CmdState::Started);
+    task_ = run();
+    using namespace std::placeholders;
+    task_.start(std::bind(&GatHostCoroutineCmd::onRunFinished, this, _1));
+}
+
+
+void
+GatHostCoroutineCmd::cancel()
+{
+    task_ = GatTask(); // Its pending callbacks are ignored from here on.
+    GatHostCmd::cancel();
+}
+
+
+void
+GatHostCoroutineCmd::onLinkLayerStateChanged(GatLinkLayer * /*host*/, GatLinkLayer::StateId /*state*/)
+{
+    // Do nothing.  Shunt base class functionality; the coroutine is resumed by the completion of its request.
+}
+
+
+void
+GatHostCoroutineCmd::onRunFinished(GatTask::result_type result)
+{
+    if (CmdState::Started != cmdState()) { return; }
+
+    switch (result)
+    {
+        case GatLinkLayer::ResultType::Reply:   setCmdState(CmdState::Completed); break;
+        case GatLinkLayer::ResultType::Timeout: setCmdState(CmdState::Failed_Timeout); break;
+        default:                                setCmdState(CmdState::Failed); break;
+    }
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+QString
+GatHostCoSpecialFxnCmd::gatSpecialFunctionName() const
+{
+    return params_.isEmpty() ? QString("Special Function") : params_.join(" ");
+}
+
+
+GatTask
+GatHostCoSpecialFxnCmd::run()
+{
+    GatTask::result_type const result = co_await gatSpecialFunction(hostPrivileges().gatLinkLayer(),
+                                                                    port().statusQueries(), params_, reply_);
+    if (GatLinkLayer::ResultType::Reply == result) { setLastGatOpResult(reply_); }
+    co_return result;
+}
+#endif // #ifdef ENABLE_GAT_COROUTINES
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+void
+GatHostAutoBaudCmd::begin()
+{
+    baudRateIdx_ = 0;
+    baudRate_ = 0;
+    setCmdState(CmdState::Started);
+    probeNextBaudRate();
+}
+
+
+QString
+GatHostAutoBaudCmd::gatSpecialFunctionName() const
+{
+    return "Auto Baud";
+}
+
+
+uint
+GatHostAutoBaudCmd::baudRate() const
+{
+    return baudRate_;
+}
+
+
+void
+GatHostAutoBaudCmd::probeNextBaudRate()
+{
+    if (CmdState::Started != cmdState()) { return; }
+
+    // Switch to the next candidate rate the device supports.
+    while (baudRates_.size() > baudRateIdx_)
+    {
+        uint const baudRate = baudRates_[baudRateIdx_++];
+        if (port().applyBaudRate(baudRate))
+        {
+#ifdef DEBUG
+            qDebug() << "Auto-baud: probing" << baudRate << "baud.";
+#endif // #ifdef DEBUG
+            sendRequest(GatRqst::SQ_01);
+            return;
+        }
+    }
+
+    setCmdState(CmdState::Failed); // No candidate rate works.
+}
+
+
+void
+GatHostAutoBaudCmd::onLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer::StateId state)
+{
+    if (CmdState::Started != cmdState()) { return; }
+
+    switch (state)
+    {
+        case GatLinkLayer::StateId::Ready:
+        case GatLinkLayer::StateId::WaitForNextTxTime:
+        case GatLinkLayer::StateId::Transmit:
+        case GatLinkLayer::StateId::Receive:
+            // Do nothing.  These link layer states can be ignored here.
+            break;
+
+        default:
+        case GatLinkLayer::StateId::Undefined: // Unexpected link layer state.
+        {
+            setCmdState(CmdState::Failed);
+            break;
+        }
+
+        case GatLinkLayer::StateId::Timeout:
+        case GatLinkLayer::StateId::Reply:
+        {
+            GatLinkLayer::reply_type reply(host->reply());
+            uint8_t const *replyBytes = reinterpret_cast<uint8_t const *>(reply.first);
+            GatPkt_StatusQueryRslt_SR81 statusQueryResult;
+            if (GatLinkLayer::StateId::Reply == state &&
+                GatLinkLayer::ResultType::Reply == host->resultType() &&
+                nullptr != replyBytes &&
+                statusQueryResult.parseResultPacket(replyBytes, reply.second))
+            {
+                baudRate_ = baudRates_[baudRateIdx_ - 1];
+                processGmResponse(GatByteChain(host->replyView()));
+            }
+            else
+            {
+                // Probe the next rate from a DPC, once the link layer has started its inter-request gap.
+                QEvent *event = new QEvent(static_cast<QEvent::Type>(LocalEventType::ProbeNextBaudRateDpc));
+                QApplication::postEvent(this, event);
+            }
+            break;
+        }
+    }
+}
+
+
+void
+GatHostAutoBaudCmd::customEvent(QEvent *event)
+{
+    GatHostCmd::customEvent(event);
+
+    if (nullptr != event &&
+        static_cast<uint>(LocalEventType::ProbeNextBaudRateDpc) == static_cast<uint>(event->type()))
+    {
+        probeNextBaudRate();
+    }
+}
+
+
+GatHostAutoBaudCmd::GatHostAutoBaudCmd(GatHostPrivilegesForGatHostCmdInterface &host,
+                                       GatSerialLineSettings::baud_rates_type const &baudRates)
+    : GatHostCmd(host)
+    , baudRates_(baudRates)
+    , baudRateIdx_(0)
+    , baudRate_(0)
+{
+    // Do nothing.
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+void
+GatHostRoundTripCmd::begin()
+{
+    probesSent_ = 0;
+    replyCount_ = 0;
+    totalRoundTripInMicroseconds_ = 0;
+    minRoundTripInMicroseconds_ = 0;
+    setCmdState(CmdState::Started);
+    sendNextProbe();
+}
+
+
+QString
+GatHostRoundTripCmd::gatSpecialFunctionName() const
+{
+    return "Round Trip";
+}
+
+
+uint
+GatHostRoundTripCmd::replyCount() const
+{
+    return replyCount_;
+}
+
+
+uint
+GatHostRoundTripCmd::meanRoundTripInMicroseconds() const
+{
+    return 0 == replyCount_ ? 0 : static_cast<uint>(totalRoundTripInMicroseconds_ / replyCount_);
+}
+
+
+uint
+GatHostRoundTripCmd::minRoundTripInMicroseconds() const
+{
+    return static_cast<uint>(minRoundTripInMicroseconds_);
+}
+
+
+void
+GatHostRoundTripCmd::sendNextProbe()
+{
+    if (CmdState::Started != cmdState()) { return; }
+
+    if (probeCount_ > probesSent_)
+    {
+        ++probesSent_;
+        GatLinkLayer::RequestResult const result = sendRequest(GatRqst::SQ_01);
+        bool const sent = GatLinkLayer::RequestResult::Success == result ||
+                          GatLinkLayer::RequestResult::Pending == result;
+        if (sent) { return; }
+    }
+
+    setCmdState(0 < replyCount_ ? CmdState::Completed : CmdState::Failed);
+}
+
+
+void
+GatHostRoundTripCmd::onLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer::StateId state)
+{
+    if (CmdState::Started != cmdState()) { return; }
+
+    switch (state)
+    {
+        case GatLinkLayer::StateId::Ready:
+        case GatLinkLayer::StateId::WaitForNextTxTime:
+        case GatLinkLayer::StateId::Transmit:
+        case GatLinkLayer::StateId::Receive:
+            // Do nothing.  These link layer states can be ignored here.
+            break;
+
+        default:
+        case GatLinkLayer::StateId::Undefined: // Unexpected link layer state.
+        {
+            setCmdState(CmdState::Failed);
+            break;
+        }
+
+        case GatLinkLayer::StateId::Timeout:
+        case GatLinkLayer::StateId::Reply:
+        {
+            GatLinkLayer::reply_type reply(host->reply());
+            uint8_t const *replyBytes = reinterpret_cast<uint8_t const *>(reply.first);
+            GatPkt_StatusQueryRslt_SR81 statusQueryResult;
+            qint64 const roundTrip = host->roundTripInMicroseconds();
+            if (GatLinkLayer::StateId::Reply == state &&
+                GatLinkLayer::ResultType::Reply == host->resultType() &&
+                nullptr != replyBytes &&
+                0 <= roundTrip &&
+                statusQueryResult.parseResultPacket(replyBytes, reply.second))
+            {
+                bool const firstReply = 0 == replyCount_++;
+                totalRoundTripInMicroseconds_ += roundTrip;
+                if (firstReply || minRoundTripInMicroseconds_ > roundTrip) { minRoundTripInMicroseconds_ = roundTrip; }
+            }
+
+            // Send the next probe from a DPC, once the link layer has started its inter-request gap.
+            QEvent *event = new QEvent(static_cast<QEvent::Type>(LocalEventType::SendNextProbeDpc));
+            QApplication::postEvent(this, event);
+            break;
+        }
+    }
+}
+
+
+void
+GatHostRoundTripCmd::customEvent(QEvent *event)
+{
+    GatHostCmd::customEvent(event);
+
+    if (nullptr != event &&
+        static_cast<uint>(LocalEventType::SendNextProbeDpc) == static_cast<uint>(event->type()))
+    {
+        sendNextProbe();
+    }
+}
+
+
+GatHostRoundTripCmd::GatHostRoundTripCmd(GatHostPrivilegesForGatHostCmdInterface &host, uint probeCount)
+    : GatHostCmd(host)
+    , probeCount_(probeCount)
+    , probesSent_(0)
+    , replyCount_(0)
+    , totalRoundTripInMicroseconds_(0)
+    , minRoundTripInMicroseconds_(0)
+{
+    // Do nothing.
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+GatCmdFuture
+GatPort::schedule(gat_host_cmd_ptr_type operationCommand)
+{
+    // Before it is queued, so it cannot finish unobserved.
+    GatCmdFuture const future(operationCommand);
+
+    // Hand the command over to the thread of the host, which admits it (in priority order) and alone uses it from
+    // here on.  The inbox is the only state shared with the scheduling thread.
+    operationCommand->moveToThread(&host_);
+    {
+        QMutexLocker scheduledCmdsLock(&scheduledCmdsGuard_);
+        scheduledCmds_.push_back(operationCommand);
+    }
+    QEvent *event = new QEvent(static_cast<QEvent::Type>(LocalEventType::CmdQueueChanged));
+    QApplication::postEvent(this, event);
+
+    return future;
+}
+
+
+void
+GatPort::admitScheduledGatCmds()
+{
+    cmds_type scheduledCmds;
+    {
+        QMutexLocker scheduledCmdsLock(&scheduledCmdsGuard_);
+        scheduledCmds.swap(scheduledCmds_);
+    }
+
+    while (!scheduledCmds.empty())
+    {
+        gat_host_cmd_ptr_type cmd = scheduledCmds.front();
+        scheduledCmds.pop_front();
+
+        if (0 != (GatHostCmd::Preempts & cmd->schedulingFlags()))
+        {
+            failPendingGatCmds(GatHostCmd::Preemptible);
+            if (nullptr != cmdInProgress_.get() && 0 != (GatHostCmd::Preemptible & cmdInProgress_->schedulingFlags()))
+            {
+                cancelGatCmdInPgrs();
+            }
+        }
+
+        // Behind the commands of the same or a higher priority.
+        GatHostCmd::Priority const priority = cmd->priority();
+        cmds_type::iterator const position = std::find_if(cmds_.begin(), cmds_.end(),
+            [priority](gat_host_cmd_ptr_type& a) -> bool { return a->priority() > priority; });
+        cmds_.insert(position, cmd);
+    }
+}
+
+
+void
+GatPort::startNextGatCmd()
+{
+    // Non-preemptive: the next command waits for the one in progress (see 'ReleaseCmdInPgrs').
+    if (nullptr != cmdInProgress_.get()) { return; }
+    if (StartupStep::Done != startupStep_) { return; } // Held during startup (see 'runStartupSteps()').
+
+    // Held until the request of a command that ended early is answered (see 'onLinkLayerStateChanged()').
+    GatLinkLayer::StateId const linkLayerState = gatLinkLayer_.state();
+    if (GatLinkLayer::StateId::Transmit == linkLayerState || GatLinkLayer::StateId::Receive == linkLayerState)
+    {
+        return;
+    }
+
+    // Drop the commands canceled while queued (see 'GatHostCmd::scheduleCancel()').
+    while (!cmds_.empty() && cmds_.front()->isFinished()) { cmds_.pop_front(); }
+    if (cmds_.empty()) { return; }
+
+    cmdInProgress_ = cmds_.front();
+    cmds_.pop_front();
+    connect(cmdInProgress_.get(), SIGNAL(gatHostCmdStateChanged(GatHostCmd *, GatHostCmd::CmdState)),
+            this, SLOT(onGatHostCmdStateChanged(GatHostCmd *, GatHostCmd::CmdState)));
+    try { cmdInProgress_->begin(); } catch (...) { qWarning("Unexpected exception caught and discarded in GatPort::startNextGatCmd(). " STRINGIZE(__LINE__)); }
+}
+
+
+void
+GatPort::failPendingGatCmds(GatHostCmd::scheduling_flags_type requiredFlags)
+{
+    // Purge and fail the queued commands that have (all of) 'requiredFlags', in the order they would have run.
+    cmds_type failedCmds;
+    for (cmds_type::iterator iter = cmds_.begin(); cmds_.end() != iter; )
+    {
+        if (requiredFlags == (requiredFlags & (*iter)->schedulingFlags()))
+        {
+            failedCmds.push_back(*iter);
+            iter = cmds_.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+    for (gat_host_cmd_ptr_type const &cmd : failedCmds)
+    {
+        if (cmd->isFinished()) { continue; } // Canceled while queued.
+        try { cmd->fail(); } catch (...) { qWarning("Unexpected exception caught and discarded in GatPort::failPendingGatCmds(GatHostCmd::scheduling_flags_type). " STRINGIZE(__LINE__)); }
+    }
+}
+
+
+void
+GatPort::cleanupAllGatCommands() throw()
+{
+    try { cancelGatCmdInPgrs(); } catch (...) { }
+    try { admitScheduledGatCmds(); } catch (...) { }
+    try { failPendingGatCmds(); } catch (...) { }
+}
+
+
+void
+GatPort::scheduleCmdQueueService()
+{
+    bool scheduledCmdsPending = false;
+    {
+        QMutexLocker scheduledCmdsLock(&scheduledCmdsGuard_);
+        scheduledCmdsPending = !scheduledCmds_.empty();
+    }
+
+    if (!cmds_.empty() || scheduledCmdsPending)
+    {
+        // Post an event to this to invoke a DPC for operation command processing.
+        QEvent *event = new QEvent(static_cast<QEvent::Type>(LocalEventType::CmdQueueChanged));
+        QApplication::postEvent(this, event);
+    }
+}
+
+
+void
+GatPort::onGatHostCmdStateChanged(GatHostCmd *cmd, GatHostCmd::CmdState cmdState)
+{
+    switch (cmdState)
+    {
+        case GatHostCmd::CmdState::Canceled:
+        case GatHostCmd::CmdState::Failed_Timeout:
+        case GatHostCmd::CmdState::Failed:
+        case GatHostCmd::CmdState::Completed:
+        {
+            if (cmdInProgress_.get() == cmd)
+            {
+                // Canceled (e.g. through its future): as if by 'cancelGatCmdInPgrs()'.
+                if (GatHostCmd::CmdState::Canceled == cmdState) { discardCanceledRequests(); }
+
+                // Schedule DPC (which also starts the next command).  A command preempting from here on must not
+                // cancel this one, and the DPC must not release the next one.
+                finishedCmd_ = cmdInProgress_;
+                cmdInProgress_.reset();
+                QEvent *event = new QEvent(static_cast<QEvent::Type>(LocalEventType::ReleaseCmdInPgrs));
+                QApplication::postEvent(this, event);
+            }
+            else
+            {
+                cmds_type::iterator iter = std::find_if(cmds_.begin(), cmds_.end(),
+                    [cmd](gat_host_cmd_ptr_type& a) -> bool { return a.get() == cmd; });
+                if (cmds_.end() != iter) { cmds_.erase(iter); }
+            }
+
+            // After the release DPC is posted, so the next startup step (or held command) does not get released.
+            if (nullptr != startupCmd_ && startupCmd_.get() == cmd) { finishStartupStep(cmdState); }
+            break;
+        }
+        default: break; // Prevent compiler warning.
+    }
+}
+
+
+void
+GatPort::onLinkLayerStateChanged(GatLinkLayer * /*host*/, GatLinkLayer::StateId state)
+{
+    // Release the next command held by 'startNextGatCmd()'.
+    if (GatLinkLayer::StateId::Ready == state && nullptr == cmdInProgress_.get()) { scheduleCmdQueueService(); }
+}
+
+
+void
+GatPort::customEvent(QEvent *event)
+{
+    QObject::customEvent(event);
+
+    if (nullptr != event)
+    {
+        if (static_cast<uint>(LocalEventType::CmdQueueChanged) == static_cast<uint>(event->type()))
+        {
+            admitScheduledGatCmds();
+            startNextGatCmd();
+        }
+        else if (static_cast<uint>(LocalEventType::ReleaseCmdInPgrs) == static_cast<uint>(event->type()))
+        {
+            finishedCmd_.reset();
+            scheduleCmdQueueService();
+        }
+        else if (static_cast<uint>(LocalEventType::RunStartupSteps) == static_cast<uint>(event->type()))
+        {
+            runStartupSteps();
+        }
+    }
+}
+
+
+void
+GatPort::cancelGatCmdInPgrs()
+{
+    if (nullptr != cmdInProgress_.get())
+    {
+        disconnect(cmdInProgress_.get(), SIGNAL(gatHostCmdStateChanged(GatHostCmd *, GatHostCmd::CmdState)),
+                   this, SLOT(onGatHostCmdStateChanged(GatHostCmd *, GatHostCmd::CmdState)));
+        try { cmdInProgress_->cancel(); } catch (...) { qWarning("Unexpected exception caught and discarded in GatPort::cancelGatCmdInPgrs(). " STRINGIZE(__LINE__)); }
+        try { cmdInProgress_.reset(); } catch (...) { qWarning("Unexpected exception caught and discarded in GatPort::cancelGatCmdInPgrs(). " STRINGIZE(__LINE__)); }
+    }
+    startupCmd_.reset();
+    discardCanceledRequests();
+}
+
+
+void
+GatPort::discardCanceledRequests()
+{
+    gatLinkLayer_.discardPendingRequests(); // Requests queued by the canceled command must not reach the GM.
+    statusQueries_.discardSubscribers(); // Its status query (if in flight) was one of them.
+}
+
+
+uint
+GatPort::write(GatLinkLayer & /*host*/, void const *data, uint dataSizeInBytes)
 {
     return serialPort_.write(reinterpret_cast<char const *>(data), dataSizeInBytes);
 }
 
 
 void
-GatHost::onLinkToHost(GatLinkLayer * /*host*/)
+GatPort::onLinkToHost(GatLinkLayer * /*host*/)
+{
+    // Do nothing.
+}
+
+
+QString
+GatPort::serialDevicePathname() const
+{
+    return QString().append(serialDevicePathname_);
+}
+
+
+auto
+GatPort::transport() const -> Transport
+{
+    return transport_;
+}
+
+
+void
+GatPort::setTransport(Transport value)
+{
+    Q_ASSERT(!host_.isRunning());
+    if (Transport::Undefined != value) { transport_ = value; }
+}
+
+
+void
+GatPort::setSerialDevicePathname(QString const &value)
+{
+    Q_ASSERT(!host_.isRunning());
+    serialDevicePathname_ = value;
+}
+
+
+bool
+GatPort::open(QString &errorDescription)
+{
+    if (!openDevice(errorDescription)) { return false; }
+
+    gatLinkLayer_.setLineSettings(lineSettings_);
+    gatLinkLayer_.resetReplyTiming(); // The GM may have been replaced while the device was closed.
+    startupStep_ = StartupStep::AutoBaud;
+    runStartupSteps();
+
+    return true;
+}
+
+
+bool
+GatPort::openDevice(QString &errorDescription)
+{
+    if (Transport::TermiosEpoll == transport_)
+    {
+        if (serialPort_.isOpen()) { serialPort_.close(); }
+        bool const portOpened = termiosSerialPort_.open(serialDevicePathname_, lineSettings_, errorDescription);
+        if (portOpened) { gatLinkLayer_.setStrategy(&termiosSerialPort_); }
+        return portOpened;
+    }
+
+    if (Transport::IoUring == transport_)
+    {
+        if (serialPort_.isOpen()) { serialPort_.close(); }
+        bool const portOpened = uringSerialPort_.open(serialDevicePathname_, lineSettings_, errorDescription);
+        if (portOpened) { gatLinkLayer_.setStrategy(&uringSerialPort_); }
+        return portOpened;
+    }
+
+    // Initiailze and open serial port.
+    if (serialPort_.isOpen()) { serialPort_.close(); }
+    serialPort_.setPortName(serialDevicePathname_); // Use SerialPortInfo class to enumerate devices.
+/*
+
+There appears to be a bug in QtAddOn::SerialPort::SerialPort::open().  Opening a port about 20 times in a row
+will eventually cause QtAddOn::SerialPort::SerialPort::open() to return false, even though the 'open()' system
+call works.  I'm not sure why.  I'll investigate in the future when there's more time.
+Eventually the system settles and it works again (usually a couple minutes).  Time seems to be a factor.
+This only seems to occur on VMware virtual machines so perhaps it's a bug in the VMware driver.
+
+int handle = open(toStdStr(serialDevicePathname_).c_str(), O_RDWR | O_ASYNC);
+if (-1 != handle)
+{
+    close(handle);
+}
+else
+{
+    qWarning() << "Failed to open \"" << serialDevicePathname_ << "\"!" << endl << errnoToStr(errno);
+}
+*/
+    bool const portOpened = serialPort_.open(QIODevice::ReadWrite); // Port is always exclusive to this thread; no other process or thread can access.
+    int const errorNumber = errno;
+    if (portOpened) { applyLineSettings(lineSettings_); }
+    serialPort_.setReadBufferSize(1024); // Limit read buffer (prevent heap abuse).
+    if (!portOpened)
+    {
+        QString errnoDescription(errnoToStr(errorNumber));
+        QString description("Unable to open serial port \"%1\".\n%2\n%3");
+        errorDescription = description.arg(toStdStr(serialDevicePathname_).c_str(), portErrorDesc(), errnoDescription);
+        qWarning() << errorDescription;
+    }
+
+    return portOpened;
+}
+
+
+void
+GatPort::close()
+{
+    cleanupAllGatCommands();
+    startupStep_ = StartupStep::Done;
+    try { lowLatency_.restore(); } catch (...) { } // While the device is still open.
+    gatLinkLayer_.resetAdapterLatency();
+    try { serialPort_.close(); } catch (...) { }
+    try { termiosSerialPort_.close(); } catch (...) { }
+    try { uringSerialPort_.close(); } catch (...) { }
+    if (this != gatLinkLayer_.strategy()) { gatLinkLayer_.setStrategy(this); }
+
+    Q_ASSERT(!isOpen());
+}
+
+
+GatSerialLineSettings
+GatPort::lineSettings() const
+{
+    return lineSettings_;
+}
+
+
+void
+GatPort::setLineSettings(GatSerialLineSettings const &value)
+{
+    Q_ASSERT(!host_.isRunning());
+    if (value.isValid()) { lineSettings_ = value; }
+}
+
+
+/*!
+    Applies line settings to the open device (whichever transport) and scales the link layer's timing to them.
+    'lineSettings_' is not changed.
+*/
+bool
+GatPort::applyLineSettings(GatSerialLineSettings const &value)
+{
+    if (!value.isValid()) { return false; }
+
+    bool applied = false;
+    if (termiosSerialPort_.isOpen())
+    {
+        applied = termiosSerialPort_.setLineSettings(value);
+    }
+    else if (uringSerialPort_.isOpen())
+    {
+        applied = uringSerialPort_.setLineSettings(value);
+    }
+    else if (serialPort_.isOpen())
+    {
+        static QSerialPort::Parity const parities[] = {
+            QSerialPort::NoParity,   // GatSerialLineSettings::Parity::None
+            QSerialPort::EvenParity, // GatSerialLineSettings::Parity::Even
+            QSerialPort::OddParity,  // GatSerialLineSettings::Parity::Odd
+        };
+        static QSerialPort::FlowControl const flowControls[] = {
+            QSerialPort::NoFlowControl,   // GatSerialLineSettings::FlowControl::None
+            QSerialPort::HardwareControl, // GatSerialLineSettings::FlowControl::Hardware
+            QSerialPort::SoftwareControl, // GatSerialLineSettings::FlowControl::Software
+        };
+        Q_ASSERT(arycap(parities) + 1 == GatSerialLineSettings::parity_Count);
+        Q_ASSERT(arycap(flowControls) + 1 == GatSerialLineSettings::flowControl_Count);
+        applied = serialPort_.setBaudRate(static_cast<qint32>(value.baudRate_)) &&
+                  serialPort_.setDataBits(static_cast<QSerialPort::DataBits>(value.dataBits_)) &&
+                  serialPort_.setParity(parities[static_cast<size_t>(value.parity_)]) &&
+                  serialPort_.setStopBits(2 == value.stopBits_ ? QSerialPort::TwoStop : QSerialPort::OneStop) &&
+                  serialPort_.setFlowControl(flowControls[static_cast<size_t>(value.flowControl_)]);
+        serialPort_.clear(); // Discard anything sent or received at the previous settings.
+    }
+
+    if (applied) { gatLinkLayer_.setLineSettings(value); }
+
+    return applied;
+}
+
+
+bool
+GatPort::applyBaudRate(uint baudRate)
+{
+    GatSerialLineSettings value(lineSettings_);
+    value.baudRate_ = baudRate;
+    return applyLineSettings(value);
+}
+
+
+/*!
+    Runs the startup steps that apply to the line settings, in order, ahead of any other command.  Commands scheduled
+    meanwhile are held until the steps are done.  Steps that run a command continue from 'finishStartupStep()'.
+*/
+void
+GatPort::runStartupSteps()
 {
-    // Do nothing.
+    while (StartupStep::Done != startupStep_ && isOpen())
+    {
+        gat_host_cmd_ptr_type cmd;
+        switch (startupStep_)
+        {
+            case StartupStep::AutoBaud:
+                if (lineSettings_.autoBaud_) { cmd.reset(new GatHostAutoBaudCmd(*this, autoBaudRates())); }
+                break;
+
+            case StartupStep::MeasureRoundTrip:
+            case StartupStep::MeasureLowLatencyRoundTrip:
+                if (lineSettings_.lowLatency_) { cmd.reset(new GatHostRoundTripCmd(*this, roundTripProbeCount)); }
+                break;
+
+            case StartupStep::EnableLowLatency:
+                if (lineSettings_.lowLatency_) { enableLowLatency(); }
+                break;
+
+            default: break; // Prevent compiler warning.
+        }
+
+        if (nullptr != cmd)
+        {
+            startStartupCmd(cmd);
+            return;
+        }
+
+        startupStep_ = static_cast<StartupStep>(static_cast<size_t>(startupStep_) + 1);
+    }
+
+    startupStep_ = StartupStep::Done;
+    scheduleCmdQueueService(); // Service commands that were held.
+}
+
+
+void
+GatPort::startStartupCmd(gat_host_cmd_ptr_type cmd)
+{
+    cancelGatCmdInPgrs();
+    startupCmd_ = cmd;
+    cmdInProgress_ = cmd;
+    connect(cmdInProgress_.get(), SIGNAL(gatHostCmdStateChanged(GatHostCmd *, GatHostCmd::CmdState)),
+            this, SLOT(onGatHostCmdStateChanged(GatHostCmd *, GatHostCmd::CmdState)));
+    try { cmdInProgress_->begin(); } catch (...) { qWarning("Unexpected exception caught and discarded in GatPort::startStartupCmd(gat_host_cmd_ptr_type). " STRINGIZE(__LINE__)); }
+}
+
+
+/*!
+    Collects the result of the startup command that just finished and continues with the next step from a DPC
+    (which runs after the finished command is released).
+*/
+void
+GatPort::finishStartupStep(GatHostCmd::CmdState cmdState)
+{
+    bool const completed = GatHostCmd::CmdState::Completed == cmdState;
+    switch (startupStep_)
+    {
+        case StartupStep::AutoBaud:
+        {
+            GatHostAutoBaudCmd const &cmd = static_cast<GatHostAutoBaudCmd const &>(*startupCmd_);
+            bool const detected = completed && 0 < cmd.baudRate();
+            if (detected) { lineSettings_.baudRate_ = cmd.baudRate(); }
+            else          { applyLineSettings(lineSettings_); } // Restore the configured rate.
+            emit baudRateDetected(this, lineSettings_.baudRate_, detected);
+            break;
+        }
+
+        case StartupStep::MeasureRoundTrip:
+        {
+            GatHostRoundTripCmd const &cmd = static_cast<GatHostRoundTripCmd const &>(*startupCmd_);
+            roundTripBeforeInMicroseconds_ = completed ? cmd.meanRoundTripInMicroseconds() : 0;
+            break;
+        }
+
+        case StartupStep::MeasureLowLatencyRoundTrip:
+        {
+            GatHostRoundTripCmd const &cmd = static_cast<GatHostRoundTripCmd const &>(*startupCmd_);
+            uint const roundTripAfterInMicroseconds = completed ? cmd.meanRoundTripInMicroseconds() : 0;
+            emit lowLatencyReport(this, roundTripBeforeInMicroseconds_, roundTripAfterInMicroseconds,
+                                  lowLatency_.description());
+            break;
+        }
+
+        default: break; // Prevent compiler warning.
+    }
+
+    startupCmd_.reset();
+    startupStep_ = static_cast<StartupStep>(static_cast<size_t>(startupStep_) + 1);
+
+    QEvent *event = new QEvent(static_cast<QEvent::Type>(LocalEventType::RunStartupSteps));
+    QApplication::postEvent(this, event);
+}
+
+
+void
+GatPort::enableLowLatency()
+{
+    int fileDescriptor = -1;
+    if (termiosSerialPort_.isOpen())    { fileDescriptor = termiosSerialPort_.handle(); }
+    else if (uringSerialPort_.isOpen()) { fileDescriptor = uringSerialPort_.handle(); }
+    else if (serialPort_.isOpen())      { fileDescriptor = static_cast<int>(serialPort_.handle()); }
+
+    if (!lowLatency_.enable(fileDescriptor, serialDevicePathname_))
+    {
+        qWarning() << "Low latency mode is not available on \"" << serialDevicePathname_ << "\".";
+    }
+
+    // Received data is held by the adapter for no longer than its (new) latency timer.
+    uint const adapterLatency = lowLatency_.adapterLatencyInMilliseconds(gatLinkLayer_.adapterLatencyInMilliseconds());
+    gatLinkLayer_.setAdapterLatency(adapterLatency);
+}
+
+
+GatSerialLineSettings::baud_rates_type
+GatPort::autoBaudRates() const
+{
+    // The configured rate is probed first.
+    GatSerialLineSettings::baud_rates_type baudRates(1, lineSettings_.baudRate_);
+    for (auto baudRate : lineSettings_.autoBaudRates_)
+    {
+        bool const alreadyListed = baudRates.end() != std::find(baudRates.begin(), baudRates.end(), baudRate);
+        if (!alreadyListed) { baudRates.push_back(baudRate); }
+    }
+    return baudRates;
+}
+
+
+QString
+GatPort::portErrorDesc() const
+{
+    static char const *errorDescriptions[] = {
+        "NoError", // SPN::SerialPort::NoError
+        "NoSuchDeviceError", // SPN::SerialPort::NoSuchDeviceError
+        "PermissionDeniedError", // SPN::SerialPort::PermissionDeniedError
+        "DeviceAlreadyOpenedError", // SPN::SerialPort::DeviceAlreadyOpenedError
+        "DeviceIsNotOpenedError", // SPN::SerialPort::DeviceIsNotOpenedError
+        "ParityError", // SPN::SerialPort::ParityError
+        "FramingError", // SPN::SerialPort::FramingError
+        "BreakConditionError", // SPN::SerialPort::BreakConditionError
+        "IoError", // SPN::SerialPort::IoError
+        "UnsupportedPortOperationError", // SPN::SerialPort::UnsupportedPortOperationError
+        "UnknownPortError", // SPN::SerialPort::UnknownPortError
+    };
+    auto const portError = serialPort_.error();
+    auto idx = static_cast<size_t>(portError);
+    return errorDescriptions[arycap(errorDescriptions) >= idx ? (arycap(errorDescriptions) - 1) : idx];
+}
+
+
+/*!
+    The readyRead() signal (bound to this slot) is emitted every time new serial data arrives.
+*/
+void
+GatPort::onRxDataReady()
+{
+    qint64 bytesAvailable = serialPort_.bytesAvailable();
+    char buffer[1024];
+    Q_ASSERT(arycap(buffer) <= std::numeric_limits<size_t>::max());
+    while (0 < bytesAvailable)
+    {
+        // Read straight into the link layer's reply buffer (the data's only copy) when it wants the data.
+        GatLinkLayer::receive_buffer_type const receiveBuffer(gatLinkLayer_.receiveBuffer());
+        if (nullptr != receiveBuffer.first)
+        {
+            qint64 const byteCountToRead = (std::min)(static_cast<qint64>(receiveBuffer.second), bytesAvailable);
+            qint64 const byteCountRead = serialPort_.read(static_cast<char *>(receiveBuffer.first), byteCountToRead);
+            if (0 >= byteCountRead) { break; }
+            gatLinkLayer_.receivedIntoBuffer(static_cast<size_t>(byteCountRead));
+            bytesAvailable -= byteCountRead;
+            continue;
+        }
+
+        qint64 const byteCountToRead = (std::min)(static_cast<qint64>(arycap(buffer)), bytesAvailable);
+        qint64 const byteCountRead = serialPort_.read(buffer, byteCountToRead);
+        if (0 >= byteCountRead) { break; }
+        gatLinkLayer_.receiveData(buffer, static_cast<size_t>(byteCountRead));
+        bytesAvailable -= byteCountRead;
+    }
+}
+
+
+GatPort::GatPort(GatHost &host)
+    : transport_(Transport::QtSerialPort)
+    , termiosSerialPort_(host.epollReactor())
+    , uringSerialPort_(host.uringEngine())
+    , statusQueries_(gatLinkLayer_)
+    , startupStep_(StartupStep::Done)
+    , roundTripBeforeInMicroseconds_(0)
+    , host_(host)
+{
+    serialPort_.setParent(this);
+    gatLinkLayer_.setParent(this);
+
+    gatLinkLayer_.setStrategy(this);
+
+    // Subscribe to signals.
+    connect(&serialPort_, SIGNAL(readyRead()), this, SLOT(onRxDataReady()));
+    connect(&gatLinkLayer_, SIGNAL(stateChanged(GatLinkLayer*, GatLinkLayer::StateId)),
+            this, SLOT(onLinkLayerStateChanged(GatLinkLayer*, GatLinkLayer::StateId)));
+}
+
+
+GatPort::~GatPort()
+{
+    cleanupAllGatCommands();
+
+    // Unsubscribe from signals.
+    disconnect(&gatLinkLayer_, SIGNAL(stateChanged(GatLinkLayer*, GatLinkLayer::StateId)),
+               this, SLOT(onLinkLayerStateChanged(GatLinkLayer*, GatLinkLayer::StateId)));
+    disconnect(&serialPort_, SIGNAL(readyRead()), this, SLOT(onRxDataReady()));
+
+    gatLinkLayer_.setStrategy(nullptr);
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+GatCmdFuture
+GatHost::schedule(gat_host_cmd_ptr_type operationCommand)
+{
+    // Route the command to the port it was created for.
+    if (nullptr == operationCommand) { return GatCmdFuture(); }
+    return operationCommand->port().schedule(operationCommand);
+}
+
+
+void
+GatHost::createPorts(size_t portCount)
+{
+    Q_ASSERT(!isRunning());
+    while (ports_.size() < portCount)
+    {
+        ports_.push_back(std::unique_ptr<GatPort>(new GatPort(*this)));
+        ports_.back()->setParent(this);
+    }
+}
+
+
+void
+GatHost::closeAllPorts() throw()
+{
+    for (auto &port : ports_)
+    {
+        try { port->close(); } catch (...) { }
+    }
 }
 
 
 void
 GatHost::startup(char const *serialDevicePathname)
 {
-    if (isRunning() || nullptr == serialDevicePathname) { return; }
+    if (nullptr == serialDevicePathname) { return; }
+
+    startup(QStringList() << QString(serialDevicePathname));
+}
+
+
+void
+GatHost::startup(QStringList const &serialDevicePathnames)
+{
+    if (isRunning() || serialDevicePathnames.isEmpty()) { return; }
 
-    QMutexLocker syncDomainLock(syncDomainGuard());
+    // Assign one port to each device (create ports as necessary).  Unused ports keep an empty pathname.
+    createPorts(static_cast<size_t>(serialDevicePathnames.size()));
+    for (size_t idx = 0; ports_.size() > idx; ++idx)
+    {
+        ports_[idx]->setSerialDevicePathname(static_cast<size_t>(serialDevicePathnames.size()) > idx
+                                             ? serialDevicePathnames[idx] : QString());
+    }
 
-    serialDevicePathname_ = serialDevicePathname;
-    start(QThread::HighestPriority); // Priority is more important on Windows than on Linux.
     // Inform Qt that 'this' object is owned by the OS thread it encapsulates.
     // This ensures that signals/slots and QEvents are passed between threads and
     // executed (asynchronously) in the appropriate context.
@@ -636,22 +2044,19 @@ GatHost::startup(char const *serialDevicePathname)
     //
     // 'moveToThread(QThread *)' can only /push/ an object from the current OS thread to the
     // OS thread implemented by its argument.  It cannot /pull/ a QObject from one OS thread to another,
-    // which is why this method is called here and *not* in 'run()'.
+    // which is why this method is called here and *not* in 'run()'.  All ports are children of this
+    // and are therefore moved with it.
     //
-    // Note that 'run()' immediately enters the synchronization domain, which causes it to
-    // block until this function leaves the synchronization domain.  This ensures that the
-    // thread does no substantial work until this function returns.
+    // The move is done before the thread starts (Qt allows moving to a thread that is not running yet), so 'run()'
+    // finds everything it owns already in its thread, and no lock is needed to hold it back until then.
     moveToThread(this);
+    start(QThread::HighestPriority); // Priority is more important on Windows than on Linux.
 }
 
 
 void
 GatHost::shutdown(bool waitForTermination)
 {
-    // No need to enter synchronization domain for this particular method implementation.
-    // All called methods are thread safe and/or synchronized by the event queue.
-    //QMutexLocker syncDomainLock(SyncDomainGuard());
-
     if (isRunning())
     {
         quit(); // This could also be called directly by either this thread or another, since quit() is a slot.
@@ -662,66 +2067,46 @@ GatHost::shutdown(bool waitForTermination)
         }
     }
 
-    cleanupAllGatCommands();
+    // Commands belong to the thread of the host while it runs ('run()' cleans up as it ends); only clean up here
+    // when it is not running, e.g. commands scheduled while it was stopped.
+    if (isRunning()) { return; }
+    for (auto &port : ports_)
+    {
+        port->cleanupAllGatCommands();
+    }
 }
 
 
 QString
 GatHost::serialDevicePathname() const
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
-    return QString().append(serialDevicePathname_);
+    return port(0).serialDevicePathname();
 }
 
 
 void
 GatHost::run()
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
     connect(&timer_, SIGNAL(timeout()), this, SLOT(onTimer()));
     timer_.setInterval(1000);
     timer_.start();
 
-    // Initialize GAT state machine (variables).
-//! \todo >>> Under Construction <<<
-
-    // Initiailze and open serial port.
-    if (serialPort_.isOpen()) { serialPort_.close(); }
-    serialPort_.setPortName(serialDevicePathname_); // Use SerialPortInfo class to enumerate devices.
-/*
-
-There appears to be a bug in QtAddOn::SerialPort::SerialPort::open().  Opening a port about 20 times in a row
-will eventually cause QtAddOn::SerialPort::SerialPort::open() to return false, even though the 'open()' system
-call works.  I'm not sure why.  I'll investigate in the future when there's more time.
-Eventually the system settles and it works again (usually a couple minutes).  Time seems to be a factor.
-This only seems to occur on VMware virtual machines so perhaps it's a bug in the VMware driver.
+    // Open all ports (all or nothing).
+    QString description;
+    bool portsOpened = true;
+    for (auto &port : ports_)
+    {
+        if (!port->serialDevicePathname_.isEmpty() &&
+            !port->open(description))
+        {
+            portsOpened = false;
+            break;
+        }
+    }
 
-int handle = open(toStdStr(serialDevicePathname_).c_str(), O_RDWR | O_ASYNC);
-if (-1 != handle)
-{
-    close(handle);
-}
-else
-{
-    qWarning() << "Failed to open \"" << serialDevicePathname_ << "\"!" << endl << errnoToStr(errno);
-}
-*/
-    bool const portOpened = serialPort_.open(QIODevice::ReadWrite); // Port is always exclusive to this thread; no other process or thread can access.
-    serialPort_.setBaudRate(QSerialPort::Baud9600);
-    serialPort_.setDataBits(QSerialPort::Data8);
-    serialPort_.setParity(QSerialPort::NoParity);
-    serialPort_.setStopBits(QSerialPort::OneStop);
-    serialPort_.setFlowControl(QSerialPort::NoFlowControl);
-    serialPort_.setReadBufferSize(1024); // Limit read buffer (prevent heap abuse).
-    int const errorNumber = errno;
-    if (!portOpened)
+    if (!portsOpened)
     {
-        QString errorDescription(errnoToStr(errorNumber));
-        QString description("Unable to open serial port \"%1\".\n%2\n%3");
-        description = description.arg(toStdStr(serialDevicePathname_).c_str(), portErrorDesc(), errorDescription);
-        qWarning() << description;
+        closeAllPorts();
         emit startupState(this, GatHostStartupStateId::Fail, description);
     }
     else
@@ -730,71 +2115,26 @@ else
         {
             emit startupState(this, GatHostStartupStateId::Success, "Success.");
 
-            // Start [thread] Qt event loop.
-            syncDomainLock.unlock();
+            // Start [thread] Qt event loop.  All ports are serviced by this one event loop.
             exec(); // Does not return until either exit() or quit() is called.
-            syncDomainLock.relock();
         }
         catch (...)
         {
-            syncDomainLock.relock();
+            qWarning("Unexpected exception caught and discarded in GatHost::run(). " STRINGIZE(__LINE__));
         }
 
         // Clean up.
-        cleanupAllGatCommands();
-        try { serialPort_.close(); } catch (...) { }
+        closeAllPorts();
     }
 
-    Q_ASSERT(!serialPort_.isOpen());
+    epollReactor_.close(); // Releases its QSocketNotifier in this thread (the thread that created it).
+    uringEngine_.close(); // Likewise.
 
     disconnect(&timer_, SIGNAL(timeout()), this, SLOT(onTimer()));
     timer_.stop();
 }
 
 
-QString
-GatHost::portErrorDesc() const
-{
-    static char const *errorDescriptions[] = {
-        "NoError", // SPN::SerialPort::NoError
-        "NoSuchDeviceError", // SPN::SerialPort::NoSuchDeviceError
-        "PermissionDeniedError", // SPN::SerialPort::PermissionDeniedError
-        "DeviceAlreadyOpenedError", // SPN::SerialPort::DeviceAlreadyOpenedError
-        "DeviceIsNotOpenedError", // SPN::SerialPort::DeviceIsNotOpenedError
-        "ParityError", // SPN::SerialPort::ParityError
-        "FramingError", // SPN::SerialPort::FramingError
-        "BreakConditionError", // SPN::SerialPort::BreakConditionError
-        "IoError", // SPN::SerialPort::IoError
-        "UnsupportedPortOperationError", // SPN::SerialPort::UnsupportedPortOperationError
-        "UnknownPortError", // SPN::SerialPort::UnknownPortError
-    };
-    auto const portError = serialPort_.error();
-    auto idx = static_cast<size_t>(portError);
-    return errorDescriptions[arycap(errorDescriptions) >= idx ? (arycap(errorDescriptions) - 1) : idx];
-}
-
-
-/*!
-    The readyRead() signal (bound to this slot) is emitted every time new serial data arrives.
-*/
-void
-GatHost::onRxDataReady()
-{
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
-    qint64 bytesAvailable = serialPort_.bytesAvailable();
-    char buffer[1024];
-    Q_ASSERT(arycap(buffer) <= std::numeric_limits<size_t>::max());
-    while (0 < bytesAvailable)
-    {
-        qint64 byteCountToRead = (std::min)(static_cast<qint64>(arycap(buffer)), bytesAvailable);
-        qint64 byteCountRead = serialPort_.read(buffer, byteCountToRead);
-        gatLinkLayer_.receiveData(buffer, static_cast<size_t>(byteCountRead));
-        bytesAvailable -= byteCountRead;
-    }
-}
-
-
 void
 GatHost::onTimer()
 {
@@ -805,26 +2145,15 @@ GatHost::onTimer()
 }
 
 
-void
-GatHost::onLinkLayerStateChanged(GatLinkLayer * /*host*/, GatLinkLayer::StateId /*state*/)
-{
-    // Do nothing.
-}
-
-
 GatHost::GatHost()
-    : syncDomainGuard_(QMutex::Recursive)
 {
-    serialPort_.setParent(this);
-    gatLinkLayer_.setParent(this);
     timer_.setParent(this);
+    epollReactor_.setParent(this);
+    uringEngine_.setParent(this);
 
-    gatLinkLayer_.setStrategy(this);
-
-    // Subscribe to signals.
-    connect(&serialPort_, SIGNAL(readyRead()), this, SLOT(onRxDataReady()));
-    connect(&gatLinkLayer_, SIGNAL(stateChanged(GatLinkLayer*, GatLinkLayer::StateId)),
-            this, SLOT(onLinkLayerStateChanged(GatLinkLayer*, GatLinkLayer::StateId)));
+    // There is always at least one port (clients may subscribe to its signals before startup).
+    ports_.push_back(std::unique_ptr<GatPort>(new GatPort(*this)));
+    ports_.back()->setParent(this);
 }
 
 
@@ -833,11 +2162,7 @@ GatHost::~GatHost()
     Q_ASSERT(!isRunning());
     shutdown(true);
 
-    // Unsubscribe from signals.
-    disconnect(&gatLinkLayer_, SIGNAL(stateChanged(GatLinkLayer*, GatLinkLayer::StateId)),
-               this, SLOT(onLinkLayerStateChanged(GatLinkLayer*, GatLinkLayer::StateId)));
-
-    gatLinkLayer_.setStrategy(nullptr);
+    ports_.clear();
 }
 
 
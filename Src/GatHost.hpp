@@ -22,25 +22,50 @@
 
 
 #include "Defs.hpp"
+#include "GatCoroutine.hpp"
 #include "GatLinkLayer.hpp"
+#include "GatSerialLineSettings.hpp"
+#include "GatSerialLowLatency.hpp"
 #include "GatSpecialFunctionExec.hpp"
+#include "GatStatusQueryCoalescer.hpp"
+#include "GatEpollReactor.hpp"
+#include "GatTermiosSerialPort.hpp"
+#include "GatUringEngine.hpp"
+#include "GatUringSerialPort.hpp"
 #include <QtSerialPort/QSerialPort>
 #include <QtSerialPort/QSerialPortInfo>
 #include <QEvent>
+#include <QMutex>
 #include <QTimer>
+#include <memory>
+#include <vector>
 
 
+class GatCmdFuture;
+class GatCmdFutureState;
 class GatHost;
+class GatPort;
 
 
 struct GatHostPrivilegesForGatHostCmdInterface
 {
     virtual GatLinkLayer& gatLinkLayer() = 0;
+    virtual GatPort& gatPort() = 0;
 
     friend class GatHostCmd;
 };
 
 
+/*!
+    \brief An operation on the GM of one port.
+
+    A command is confined to one thread at a time, and takes no locks: its creator's until scheduled, then the
+    thread of its host, which runs it (state machine events, link layer signals, DPCs) and finally releases it.
+    Other threads reach it only through messages: 'scheduleCancel()', the 'gatHostCmdStateChanged' signal, DPCs
+    posted by subclasses with copies of the results, or a 'GatCmdFuture' (whose results may be read once finished).
+    What a command is constructed with (e.g. 'gatSpecialFunctionName()', 'params()') never changes, so it may be
+    read from any thread.
+*/
 class GatHostCmd
     : public QObject
 {
@@ -52,19 +77,22 @@ public:
     virtual void begin();
     virtual void cancel();
     virtual void fail();
-    virtual void processGmResponse(uint8_t const *data, size_t dataSize);
+    virtual void processGmResponse(GatByteChain const &response);
+
+    void scheduleCancel(); //!< 'cancel()' from this command's thread (callable from any); ignored once finished.
     //! @}
 
     //! \name Operation Result(s)
     //! @{
 public:
-    QByteArray lastGatOpResult() const; //!< Returns by value for thread safety.
+    QByteArray lastGatOpResult() const; //!< Returns by value for thread safety (contiguous copy of the chain).
+    GatByteChain lastGatOpResultChain() const; //!< Returns by value for thread safety (shares the reply packets).
 
 protected:
-    QByteArray const& setLastGatOpResult(QByteArray const &value) { return (operationResult_ = value); }
+    GatByteChain const& setLastGatOpResult(GatByteChain const &value) { return (operationResult_ = value); }
 
 private:
-    QByteArray operationResult_;
+    GatByteChain operationResult_; // Views of the reply packet(s), as received.
     //! @}
 
     //! \name Miscellaneous
@@ -79,7 +107,8 @@ protected:
 
     enum class ELocalEventType : int
     {
-        FailThisDpc = QEvent::User
+        FailThisDpc = QEvent::User,
+        CancelThisDpc
     };
 
     void customEvent(QEvent *event);
@@ -98,18 +127,56 @@ public:
     };
     static size_t const cmdState_Count = static_cast<size_t>(CmdState::Undefined) + 1;
 
+    bool isFinished() const; //!< Canceled, failed, or completed.
+
 signals:
     void gatHostCmdStateChanged(GatHostCmd *cmd, GatHostCmd::CmdState cmdState); //!< Signals execute in thread context of creator.
 
 protected:
     virtual CmdState setCmdState(CmdState newCmdState);
-    virtual CmdState cmdState() const { return cmdState_; } // Atomic operation.
+    virtual CmdState cmdState() const { return cmdState_; }
     virtual void onCmdStateChanged();
 
 private:
     CmdState cmdState_;
     //! @}
 
+    //! \name Future (see 'GatCmdFuture')
+    //! @{
+private:
+    friend class GatCmdFuture;
+
+    std::shared_ptr<GatCmdFutureState> futureState_; // Finished once this command is.
+    //! @}
+
+    //! \name Scheduling (see 'GatPort::schedule()'; set before the command is scheduled)
+    //! @{
+public:
+    enum class Priority : size_t {
+        High,   //!< Quick queries (e.g. SQ, LASQ), which should not wait for calculations.
+        Normal, //!< Default.
+        Low,    //!< Background work.
+        Undefined // Must always be last.
+    };
+    static size_t const priority_Count = static_cast<size_t>(Priority::Undefined) + 1;
+
+    enum SchedulingFlag : uint {
+        NoSchedulingFlags = 0x0,
+        Preempts = 0x1,    //!< Cancels (or fails, when queued) the 'Preemptible' commands scheduled before this one.
+        Preemptible = 0x2  //!< Otherwise a command, once scheduled, is never canceled in favor of another.
+    };
+    typedef uint scheduling_flags_type; // 'SchedulingFlag's.
+
+    Priority priority() const { return priority_; }
+    void setPriority(Priority value) { priority_ = value; }
+    scheduling_flags_type schedulingFlags() const { return schedulingFlags_; }
+    void setSchedulingFlags(scheduling_flags_type value) { schedulingFlags_ = value; }
+
+private:
+    Priority priority_;
+    scheduling_flags_type schedulingFlags_;
+    //! @}
+
     //! \name Link Layer Management
     //! @{
 protected slots:
@@ -119,31 +186,120 @@ protected slots:
     //! \name Host Association
     //! @{
 public:
-    GatHost & host() { return host_; } // Atomic operation.
-    GatHost const & host() const { return host_; } // Atomic operation.
+    GatPort & port() { return host_.gatPort(); } // Atomic operation.
 
     GatHostPrivilegesForGatHostCmdInterface& hostPrivileges(); // Atomic operation.
     GatHostPrivilegesForGatHostCmdInterface const& hostPrivileges() const; // Atomic operation.
 
 private:
-    GatHost &host_;
+    GatHostPrivilegesForGatHostCmdInterface &host_; // Either a 'GatPort' or a 'GatHost' (its first port).
     //! @}
 
-    //! \name Synchronization Domain
+    //! \name Construction, Destruction, and Assignment
     //! @{
 public:
-    QMutex * syncDomainGuard() const; // Atomic operation.
+    GatHostCmd(GatHostPrivilegesForGatHostCmdInterface &gatHost);
+    virtual ~GatHostCmd();
+    //! @}
+};
+
+
+/*!
+    \brief How a scheduled command ends (see 'GatHost::schedule()'), for clients that do not subclass the command.
+
+    A future finishes once its command does (is canceled, fails, or completes), and keeps the command alive for
+    its results (e.g. 'command()->lastGatOpResult()').  Futures are cheap to copy; all copies share one state.
+    Continuations run once, in the thread that finished the command (the thread of the host), or at once (in the
+    calling thread) when the future is already finished.  'wait()' blocks any other thread until then.
+
+    Futures combine: 'then()' schedules the next command once one completes, 'whenAll()' and 'whenAny()' join many.
+    Canceling a combined future cancels every command it waits for.
+*/
+class GatCmdFuture
+{
+public:
+    typedef GatHostCmd::CmdState result_type;
+    typedef std::function<void (GatCmdFuture const &finished)> continuation_type;
+    typedef std::function<GatCmdFuture (GatCmdFuture const &completed)> next_type; //!< See 'then()'.
+    typedef std::vector<GatCmdFuture> futures_type;
+
+    //! \name Result
+    //! @{
+public:
+    bool isValid() const { return nullptr != state_.get(); }
+    bool isFinished() const;
+    result_type result() const; //!< 'Undefined' until finished.
+    std::shared_ptr<GatHostCmd> command() const { return cmd_; } //!< Null for combined futures.
+
+    result_type wait() const; //!< Blocks until finished; never call from the thread of the host!
+    bool wait(uint timeoutInMilliseconds) const; //!< Returns whether finished.
+    //! @}
+
+    //! \name Combination
+    //! @{
+public:
+    void onFinished(continuation_type continuation) const;
+
+    //! Finishes as the future 'next' returns, once this one completes; otherwise (or when 'next' returns an invalid
+    //! future, e.g. nothing more to do) as this one did.  So a chain stops at the first command not completed.
+    GatCmdFuture then(next_type next) const;
+
+    //! Once all have finished: completed when all completed, else as the first of 'futures' that did not.
+    static GatCmdFuture whenAll(futures_type const &futures);
+
+    //! As the first of 'futures' to finish; invalid when none are valid.
+    static GatCmdFuture whenAny(futures_type const &futures);
+    //! @}
+
+    //! \name Cancellation
+    //! @{
+public:
+    void cancel() const; //!< See 'GatHostCmd::scheduleCancel()'.
     //! @}
 
     //! \name Construction, Destruction, and Assignment
     //! @{
 public:
-    GatHostCmd(GatHost &gatHost);
-    virtual ~GatHostCmd();
+    GatCmdFuture() {} //!< Invalid.
+    explicit GatCmdFuture(std::shared_ptr<GatHostCmd> const &cmd);
+
+private:
+    friend class GatCmdFutureState;
+
+    explicit GatCmdFuture(std::shared_ptr<GatCmdFutureState> const &state);
+
+    std::shared_ptr<GatCmdFutureState> state_;
+    std::shared_ptr<GatHostCmd> cmd_;
     //! @}
 };
 
 
+#ifdef ENABLE_GAT_COROUTINES
+/*!
+    \brief 'co_await' of a 'GatCmdFuture' from a coroutine in the thread of the host; resumes with its result.
+*/
+class GatCmdFutureAwaiter
+    : public GatCallbackAwaiter
+{
+public:
+    bool await_suspend(GatTask::handle_type coroutine);
+    GatCmdFuture::result_type await_resume() const { return future_.result(); }
+
+    explicit GatCmdFutureAwaiter(GatCmdFuture const &future) : future_(future) {}
+
+private:
+    GatCmdFuture future_;
+};
+
+
+inline GatCmdFutureAwaiter
+operator co_await(GatCmdFuture const &future)
+{
+    return GatCmdFutureAwaiter(future);
+}
+#endif // #ifdef ENABLE_GAT_COROUTINES
+
+
 class GatHostSpecialFxnCmd
     : public GatHostCmd
 {
@@ -155,13 +311,15 @@ public:
 
     virtual QString gatSpecialFunctionName() const; //!< Returns by value for thread safety.
 
-    GatHostSpecialFxnCmd(GatHost &host);
+    GatHostSpecialFxnCmd(GatHostPrivilegesForGatHostCmdInterface &host);
     virtual ~GatHostSpecialFxnCmd();
 
 protected slots:
     virtual void onLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer::StateId state);
     virtual void onSpecialFunctionExecStateChanged(GatSpecialFunctionExec *host,
                                                    GatSpecialFunctionExec::StateId newState);
+    virtual void onCalculationProgress(GatSpecialFunctionExec * /*host*/, uint /*elapsedInMilliseconds*/,
+                                       uint /*expectedInMilliseconds*/) {} //!< For progress displays.
 
 protected:
     virtual void gatSpecFxnParams(QStringList & /*arDest*/) {}
@@ -179,7 +337,7 @@ class GatHostGetSpecialFunctionsCmd
 public:
     virtual QString gatSpecialFunctionName() const; //!< Returns by value for thread safety.
 
-    GatHostGetSpecialFunctionsCmd(GatHost &host) : GatHostSpecialFxnCmd(host) {}
+    GatHostGetSpecialFunctionsCmd(GatHostPrivilegesForGatHostCmdInterface &host) : GatHostSpecialFxnCmd(host) {}
 
 protected:
     virtual void gatSpecFxnParams(QStringList &result);
@@ -206,7 +364,7 @@ public:
 
     static QString fileName(FileName fileName); //!< Standard GAT file names (for convenience).
 
-    GatHostGetFileCmd(GatHost &host, QString const &fileName, QStringList const *params)
+    GatHostGetFileCmd(GatHostPrivilegesForGatHostCmdInterface &host, QString const &fileName, QStringList const *params)
         : GatHostSpecialFxnCmd(host), fileName_(fileName), params_(nullptr == params ? QStringList() : *params) {}
 
 protected:
@@ -229,7 +387,8 @@ public:
     QString componentName() const { return QString().append(componentName_); } //!< Returns by value for thread safety.
     QStringList params() const; //!< Returns by value for thread safety.
 
-    GatHostGetComponentCmd(GatHost &host, QString const &componentName, QStringList const *params)
+    GatHostGetComponentCmd(GatHostPrivilegesForGatHostCmdInterface &host, QString const &componentName,
+                           QStringList const *params)
         : GatHostSpecialFxnCmd(host)
         , componentName_(componentName)
         , params_(nullptr == params ? QStringList() : *params) {}
@@ -243,6 +402,247 @@ private:
 };
 
 
+/*!
+    \brief Runs a list of special functions (Component, Get File) back to back, as one command.
+
+    Each step starts from a DPC of this command as soon as the one before it finishes, i.e. on the host thread and
+    without a round trip through the client.  The command completes once, when every step completed, else it ends
+    as the first step that did not (see 'stopOnFailure()').  Its result is the replies of the steps that completed,
+    in order; 'stepResults()' has them per step.
+*/
+class GatHostBatchSpecialFxnCmd
+    : public GatHostSpecialFxnCmd
+{
+    Q_OBJECT
+
+public:
+    enum class StepKind : size_t {
+        Component,
+        GetFile,
+        Undefined // Must always be last.
+    };
+    static size_t const stepKind_Count = static_cast<size_t>(StepKind::Undefined) + 1;
+
+    struct Step
+    {
+        StepKind kind_;
+        QString name_; // Component or file name.
+        QStringList params_;
+    };
+    typedef std::vector<Step> steps_type;
+
+    struct StepResult
+    {
+        CmdState cmdState_; // 'Completed', 'Failed', or 'Failed_Timeout'.
+        GatByteChain reply_; // Empty unless 'Completed'.
+    };
+    typedef std::vector<StepResult> step_results_type; // Of the steps that ran, in order.
+
+    virtual void begin();
+    virtual QString gatSpecialFunctionName() const; //!< Returns by value for thread safety.
+
+    steps_type steps() const; //!< Returns by value for thread safety.
+    step_results_type stepResults() const; //!< Returns by value for thread safety.
+    bool stopOnFailure() const { return stopOnFailure_; } //!< Otherwise the steps after a failed one still run.
+
+    GatHostBatchSpecialFxnCmd(GatHostPrivilegesForGatHostCmdInterface &host, steps_type const &steps,
+                              bool stopOnFailure = true);
+
+protected slots:
+    virtual void onSpecialFunctionExecStateChanged(GatSpecialFunctionExec *host,
+                                                   GatSpecialFunctionExec::StateId newState);
+
+protected:
+    enum class LocalEventType : int
+    {
+        BeginNextStepDpc = static_cast<int>(ELocalEventType::FailThisDpc) + 1
+    };
+
+    void customEvent(QEvent *event);
+    virtual void gatSpecFxnParams(QStringList &result); //!< Of the current step.
+
+private:
+    void finishStep(CmdState stepCmdState, GatByteChain const &reply);
+    void finishBatch();
+
+    steps_type steps_;
+    bool stopOnFailure_;
+    size_t stepIdx_; // Current step.
+    step_results_type stepResults_;
+};
+
+
+/*!
+    \brief Status query (SQ/SR) through the port's 'GatStatusQueryCoalescer'.
+
+    Completes with the SR as its result.  The SR is shared with any other command polling the GM at the same time
+    (e.g. a special function waiting for its calculation), or is a reply that is still fresh, so asking for the
+    status of a busy GM does not add to its load.
+*/
+class GatHostStatusQueryCmd
+    : public GatHostCmd
+{
+    Q_OBJECT
+
+public:
+    virtual void begin();
+    virtual void cancel();
+    virtual QString gatSpecialFunctionName() const; //!< Returns by value for thread safety.
+
+    GatHostStatusQueryCmd(GatHostPrivilegesForGatHostCmdInterface &host);
+    virtual ~GatHostStatusQueryCmd();
+
+protected slots:
+    virtual void onLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer::StateId state);
+
+private:
+    void onStatusQueryReply(GatLinkLayer::ResultType resultType, GatByteView const &reply);
+    void unsubscribe();
+
+    uint subscription_; // 0 when not waiting for a reply.
+};
+
+
+#ifdef ENABLE_GAT_COROUTINES
+/*!
+    \brief A command written as a coroutine: 'run()' (see 'GatTask').
+
+    The command ends as its coroutine does ('Reply' completes it; see 'onRunFinished()').  Canceling the command
+    destroys the coroutine wherever it is suspended.
+*/
+class GatHostCoroutineCmd
+    : public GatHostCmd
+{
+    Q_OBJECT
+
+public:
+    virtual void begin();
+    virtual void cancel();
+
+    GatHostCoroutineCmd(GatHostPrivilegesForGatHostCmdInterface &host) : GatHostCmd(host) {}
+
+protected slots:
+    virtual void onLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer::StateId state);
+
+protected:
+    virtual GatTask run() = 0; //!< Sets the result of the command ('setLastGatOpResult()') before it returns.
+
+private:
+    void onRunFinished(GatTask::result_type result);
+
+    GatTask task_;
+};
+
+
+/*!
+    \brief Special function (e.g. "Component", name, parameters) as a coroutine; see 'gatSpecialFunction()'.
+*/
+class GatHostCoSpecialFxnCmd
+    : public GatHostCoroutineCmd
+{
+    Q_OBJECT
+
+public:
+    virtual QString gatSpecialFunctionName() const; //!< Returns by value for thread safety.
+
+    GatHostCoSpecialFxnCmd(GatHostPrivilegesForGatHostCmdInterface &host, QStringList const &params)
+        : GatHostCoroutineCmd(host), params_(params) {}
+
+protected:
+    virtual GatTask run();
+
+private:
+    QStringList params_;
+    GatByteChain reply_; // Frames, as they are read.
+};
+#endif // #ifdef ENABLE_GAT_COROUTINES
+
+
+/*!
+    \brief Finds the baud rate of the GM attached to a port (see 'GatSerialLineSettings::autoBaud_').
+
+    A status query (SQ) is sent at each candidate rate, in order, until the GM returns a valid (CRC checked) SR.
+    The command completes with that SR as its result and the port is left at that rate.  The command fails when no
+    candidate works.  Ports run this command themselves when opened with auto-baud enabled.
+*/
+class GatHostAutoBaudCmd
+    : public GatHostCmd
+{
+    Q_OBJECT
+
+public:
+    virtual void begin();
+    virtual QString gatSpecialFunctionName() const; //!< Returns by value for thread safety.
+
+    uint baudRate() const; //!< The detected rate (0 until detected).
+
+    GatHostAutoBaudCmd(GatHostPrivilegesForGatHostCmdInterface &host,
+                       GatSerialLineSettings::baud_rates_type const &baudRates);
+
+protected slots:
+    virtual void onLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer::StateId state);
+
+protected:
+    enum class LocalEventType : int
+    {
+        ProbeNextBaudRateDpc = static_cast<int>(ELocalEventType::FailThisDpc) + 1
+    };
+
+    void customEvent(QEvent *event);
+
+private:
+    void probeNextBaudRate();
+
+    GatSerialLineSettings::baud_rates_type baudRates_;
+    size_t baudRateIdx_; // Next candidate.
+    uint baudRate_;
+};
+
+
+/*!
+    \brief Measures the SQ/SR round-trip time of a port (see 'GatSerialLineSettings::lowLatency_').
+
+    A status query (SQ) is sent 'probeCount' times, one after another, and the time from when each request is
+    written until its valid (CRC checked) SR is parsed is measured by the link layer.  Timeouts and invalid replies
+    are not counted.  The command completes when at least one valid reply was received, otherwise it fails.
+*/
+class GatHostRoundTripCmd
+    : public GatHostCmd
+{
+    Q_OBJECT
+
+public:
+    virtual void begin();
+    virtual QString gatSpecialFunctionName() const; //!< Returns by value for thread safety.
+
+    uint replyCount() const; //!< Valid replies measured.
+    uint meanRoundTripInMicroseconds() const; //!< 0 when no reply was measured.
+    uint minRoundTripInMicroseconds() const; //!< 0 when no reply was measured.
+
+    GatHostRoundTripCmd(GatHostPrivilegesForGatHostCmdInterface &host, uint probeCount);
+
+protected slots:
+    virtual void onLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer::StateId state);
+
+protected:
+    enum class LocalEventType : int
+    {
+        SendNextProbeDpc = static_cast<int>(ELocalEventType::FailThisDpc) + 1
+    };
+
+    void customEvent(QEvent *event);
+
+private:
+    void sendNextProbe();
+
+    uint probeCount_;
+    uint probesSent_;
+    uint replyCount_;
+    qint64 totalRoundTripInMicroseconds_;
+    qint64 minRoundTripInMicroseconds_;
+};
+
+
 enum class GatHostStartupStateId : size_t
 {
     Success,
@@ -252,36 +652,19 @@ size_t const gatHostStartupState_Count = static_cast<size_t>(GatHostStartupState
 
 
 /*!
-    \brief The GatHost class
+    \brief One serial device (GM connection) driven by a GatHost.
 
-    See 'http://mayaposch.wordpress.com/2011/11/01/how-to-really-truly-use-qthreads-the-full-explanation/'
-    for details about using QThread.
-
-    Sending a QEvent to another thread:
-    http://www.qtcentre.org/threads/40985-How-to-send-custom-events-from-QThread-run-()-to-application
+    A port owns the serial device, the GAT link layer that runs over it, and the queue of commands for the GM
+    attached to it.  Ports are created by, owned by, and live in the thread of their host.  Commands are bound to a
+    port when constructed (see 'GatHostCmd::GatHostCmd()').
 
-    GAT v3.5 rules:
-    ---------------
-      * Response messages from the GM must start less than 200ms from the last byte of the command message from this.
-      * Suggested inter-byte timeout value is 5ms, which starts when the first byte of the response from the GM
-        is received.  Timer expiration can be used to trigger response message evaluation.  Otherwise, the
-        message [fragment] (if any) must be evaluated 200ms after the last byte of the command message was sent.
-      * Another command message must not be sent any sooner than 225ms from the time the last byte of the
-        most recent command message was sent, when the GM does not respond, i.e. gap between bytes in two different
-        consecutive command messages must be no shorter than 225ms.
-      * Another command message must not be sent any sooner than 10ms from the time of the last byte of the response
-        message from the GM, when the GM does respond.
-      * Commands from the host to the GM are serialized and no more than _one_ command may be in-progress/active
-        at any point in time.  When the host sends a command to the GM while a command is in-progress on the GM,
-        the command in progress is cancelled and superceeded by the most recent command received, which is started.
-      * The GM _only_ sends messages to the host in response to a command message from the host.
-        The GM _never_ sends unsolicited messages to the host.  The host must poll the GM to determine if
-        results for the most recent command are available and to obtain them.
-      * Communication is full duplex.  Both host and GM may be transmitting simultaneously, however protocol
-        state machine rules seem to prevent this sceanrio (excluding malfunction scenarios).
+    Commands run one at a time, highest priority first and in the order scheduled within a priority.  A command in
+    progress runs to its end (so a calculation is never restarted), unless preempted: see 'GatHostCmd::Preempts'.
+    A command that ends before the reply to its request (e.g. canceled) leaves that request to finish: the next
+    command starts once the reply is in (or timed out), so it never takes that reply for its own.
 */
-class GatHost
-    : public QThread
+class GatPort
+    : public QObject
     , public GatHostPrivilegesForGatHostCmdInterface
     , public GatLinkLayerStrategyInterface
 {
@@ -292,38 +675,43 @@ class GatHost
 public:
     typedef std::shared_ptr<GatHostCmd> gat_host_cmd_ptr_type;
 
-    void schedule(gat_host_cmd_ptr_type operationCommand); //!< This takes ownership of the operation!
+    GatCmdFuture schedule(gat_host_cmd_ptr_type operationCommand); //!< This takes ownership of the operation!
 
 protected slots:
     virtual void onGatHostCmdStateChanged(GatHostCmd *cmd, GatHostCmd::CmdState cmdState);
+    void onLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer::StateId state);
 
 protected:
     enum class LocalEventType : int
     {
         CmdQueueChanged = QEvent::User,
-        ReleaseCmdInPgrs
+        ReleaseCmdInPgrs,
+        RunStartupSteps
     };
 
     void customEvent(QEvent *event);
 
 private:
-    void failPendingGatCmds(uint commandCountToLeaveInQueue = 0);
+    void admitScheduledGatCmds(); //!< Into 'cmds_', in priority order (and preempting).
+    void startNextGatCmd();
+    void failPendingGatCmds(GatHostCmd::scheduling_flags_type requiredFlags = GatHostCmd::NoSchedulingFlags);
     void cleanupAllGatCommands() throw();
     void scheduleCmdQueueService();
+    void discardCanceledRequests(); //!< Of the command in progress, which has been canceled.
 
     typedef std::deque<gat_host_cmd_ptr_type> cmds_type;
-    cmds_type cmds_;
+    QMutex scheduledCmdsGuard_; // Guards 'scheduledCmds_' only; never held while a command runs.
+    cmds_type scheduledCmds_; // Scheduled (by any thread) but not yet admitted (by this thread).
+    cmds_type cmds_; // Waiting to run: by priority, then in the order scheduled.
     gat_host_cmd_ptr_type cmdInProgress_;
-
-    friend class GatHostGetSpecialFunctionsCmd;
-    friend class GatHostGetFileCmd;
-    friend class GatHostGetComponentCmd;
+    gat_host_cmd_ptr_type finishedCmd_; // Released from a DPC; not while it is still signaling its state.
     //! @}
 
     //! \name GatHostPrivilegesForGatHostCmdInterface
     //! @{
 public:
     virtual GatLinkLayer& gatLinkLayer() { return gatLinkLayer_; }
+    virtual GatPort& gatPort() { return *this; }
 
 protected:
     virtual void cancelGatCmdInPgrs();
@@ -336,22 +724,213 @@ protected:
     virtual void onLinkToHost(GatLinkLayer *host);
     //! @}
 
-    //! \name Synchronization Domain
+    //! \name Serial Device
+    //! @{
+public:
+    enum class Transport : size_t
+    {
+        QtSerialPort, //!< QSerialPort (default).
+        TermiosEpoll, //!< Raw termios device serviced by the host's epoll reactor (see 'GatTermiosSerialPort').
+        IoUring,      //!< Raw termios device serviced by the host's io_uring engine (see 'GatUringSerialPort').
+        Undefined     // Must always be last.
+    };
+    static size_t const transport_Count = static_cast<size_t>(Transport::Undefined) + 1;
+
+    QString serialDevicePathname() const;
+    bool isOpen() const { return serialPort_.isOpen() || termiosSerialPort_.isOpen() || uringSerialPort_.isOpen(); }
+    Transport transport() const;
+    void setTransport(Transport value); //!< Only while the host is not running.
+
+protected:
+    void setSerialDevicePathname(QString const &value); //!< Only while the host is not running.
+    bool open(QString &errorDescription); //!< Called only by the host thread.
+    void close(); //!< Called only by the host thread.
+
+protected slots:
+    virtual void onRxDataReady();
+
+private:
+    bool openDevice(QString &errorDescription);
+    QString portErrorDesc() const;
+
+    QString serialDevicePathname_;
+    Transport transport_;
+    QSerialPort serialPort_; // http://qt-project.org/wiki/QtSerialPort#7868ff75ba2ba6671f178bc8fb7da0fd
+    GatTermiosSerialPort termiosSerialPort_;
+    GatUringSerialPort uringSerialPort_;
+    GatLinkLayer gatLinkLayer_;
+    //! @}
+
+    //! \name Status Queries (SQ/SR; shared by the commands of this port)
+    //! @{
+public:
+    GatStatusQueryCoalescer& statusQueries() { return statusQueries_; }
+
+private:
+    GatStatusQueryCoalescer statusQueries_; // Over 'gatLinkLayer_'.
+    //! @}
+
+    //! \name Serial Line Settings
+    //! @{
+public:
+    GatSerialLineSettings lineSettings() const; //!< Returns by value for thread safety.
+    void setLineSettings(GatSerialLineSettings const &value); //!< Only while the host is not running.
+
+signals:
+    void baudRateDetected(GatPort *port, uint baudRate, bool detected); //!< Result of auto-baud (when enabled).
+    void lowLatencyReport(GatPort *port, uint roundTripBeforeInMicroseconds, uint roundTripAfterInMicroseconds,
+                          QString changes); //!< Result of enabling low latency mode (when enabled).
+
+protected:
+    bool applyLineSettings(GatSerialLineSettings const &value); //!< To the open device and the link layer.
+    bool applyBaudRate(uint baudRate);
+
+private:
+    GatSerialLineSettings lineSettings_;
+
+    friend class GatHostAutoBaudCmd;
+    //! @}
+
+    //! \name Startup (runs once the device is opened, before any scheduled command)
+    //! @{
+private:
+    enum class StartupStep : size_t
+    {
+        AutoBaud,                   //!< When 'GatSerialLineSettings::autoBaud_'.
+        MeasureRoundTrip,           //!< When 'GatSerialLineSettings::lowLatency_'.
+        EnableLowLatency,           //!< When 'GatSerialLineSettings::lowLatency_'.
+        MeasureLowLatencyRoundTrip, //!< When 'GatSerialLineSettings::lowLatency_'.
+        Done                        // Must always be last.
+    };
+
+    void runStartupSteps();
+    void startStartupCmd(gat_host_cmd_ptr_type cmd);
+    void finishStartupStep(GatHostCmd::CmdState cmdState);
+    void enableLowLatency();
+    GatSerialLineSettings::baud_rates_type autoBaudRates() const;
+
+    StartupStep startupStep_;
+    gat_host_cmd_ptr_type startupCmd_;
+    GatSerialLowLatency lowLatency_;
+    uint roundTripBeforeInMicroseconds_;
+    //! @}
+
+    //! \name Host Association
+    //! @{
+public:
+    GatHost & host() { return host_; } // Atomic operation.
+    GatHost const & host() const { return host_; } // Atomic operation.
+
+private:
+    GatHost &host_;
+
+    friend class GatHost;
+    //! @}
+
+    //! \name Construction, Destruction, and Assignment
+    //! @{
+public:
+    GatPort(GatHost &host);
+    virtual ~GatPort();
+
+private:
+    GatPort(GatPort const& ) = delete; //!< No cloning; leave unimplemented.
+    GatPort& operator=(GatPort const& ) = delete; //!< No cloning; leave unimplemented.
+    //! @}
+};
+
+
+/*!
+    \brief The GatHost class
+
+    See 'http://mayaposch.wordpress.com/2011/11/01/how-to-really-truly-use-qthreads-the-full-explanation/'
+    for details about using QThread.
+
+    One host (thread and Qt event loop) drives any number of serial devices (ports).  Each port has its own link
+    layer and command queue (see 'GatPort').  Ports, link layers, and running commands are confined to the host's
+    thread and take no locks; other threads reach them by message (scheduling, DPCs, signals).  The configuration
+    of the ports (device, transport, line settings) is only set while the host is stopped, and is read-only while it
+    runs.  All port I/O and timers are event driven, so a host that is waiting on many GMs consumes no CPU.
+
+    Sending a QEvent to another thread:
+    http://www.qtcentre.org/threads/40985-How-to-send-custom-events-from-QThread-run-()-to-application
+
+    GAT v3.5 rules:
+    ---------------
+      * Response messages from the GM must start less than 200ms from the last byte of the command message from this.
+      * Suggested inter-byte timeout value is 5ms, which starts when the first byte of the response from the GM
+        is received.  Timer expiration can be used to trigger response message evaluation.  Otherwise, the
+        message [fragment] (if any) must be evaluated 200ms after the last byte of the command message was sent.
+      * Another command message must not be sent any sooner than 225ms from the time the last byte of the
+        most recent command message was sent, when the GM does not respond, i.e. gap between bytes in two different
+        consecutive command messages must be no shorter than 225ms.
+      * Another command message must not be sent any sooner than 10ms from the time of the last byte of the response
+        message from the GM, when the GM does respond.
+      * Commands from the host to the GM are serialized and no more than _one_ command may be in-progress/active
+        at any point in time.  When the host sends a command to the GM while a command is in-progress on the GM,
+        the command in progress is cancelled and superceeded by the most recent command received, which is started.
+      * The GM _only_ sends messages to the host in response to a command message from the host.
+        The GM _never_ sends unsolicited messages to the host.  The host must poll the GM to determine if
+        results for the most recent command are available and to obtain them.
+      * Communication is full duplex.  Both host and GM may be transmitting simultaneously, however protocol
+        state machine rules seem to prevent this sceanrio (excluding malfunction scenarios).
+*/
+class GatHost
+    : public QThread
+    , public GatHostPrivilegesForGatHostCmdInterface
+{
+    Q_OBJECT
+
+    //! \name GAT Operations
+    //! @{
+public:
+    typedef GatPort::gat_host_cmd_ptr_type gat_host_cmd_ptr_type;
+
+    //! This takes ownership of the operation!  The future may be dropped (the command runs all the same).
+    GatCmdFuture schedule(gat_host_cmd_ptr_type operationCommand);
+
+private:
+    friend class GatHostGetSpecialFunctionsCmd;
+    friend class GatHostGetFileCmd;
+    friend class GatHostGetComponentCmd;
+    //! @}
+
+    //! \name GatHostPrivilegesForGatHostCmdInterface (forwarded to the first port)
+    //! @{
+public:
+    virtual GatLinkLayer& gatLinkLayer() { return port(0).gatLinkLayer(); }
+    virtual GatPort& gatPort() { return port(0); }
+    //! @}
+
+    //! \name Ports
     //! @{
 public:
-    QMutex * syncDomainGuard() const { return &syncDomainGuard_; }
+    size_t portCount() const { return ports_.size(); } // Atomic operation.
+    GatPort & port(size_t portIndex) { return *ports_.at(portIndex); } // Atomic operation.
+    GatPort const & port(size_t portIndex) const { return *ports_.at(portIndex); } // Atomic operation.
+    void createPorts(size_t portCount); //!< Only while not running (so they may be configured before 'startup()').
+
+    GatEpollReactor & epollReactor() { return epollReactor_; } //!< Shared by all ports; use only in this thread.
+    GatUringEngine & uringEngine() { return uringEngine_; } //!< Shared by all ports; use only in this thread.
 
 private:
-    mutable QMutex syncDomainGuard_;
+    void closeAllPorts() throw();
+
+    GatEpollReactor epollReactor_;
+    GatUringEngine uringEngine_;
+
+    typedef std::deque<std::unique_ptr<GatPort>> ports_type;
+    ports_type ports_; // Ports are only added (never removed) so that commands may safely reference them.
     //! @}
 
     //! \name Thread Management
     //! @{
 public:
     void startup(char const *serialDevicePathname);
+    void startup(QStringList const &serialDevicePathnames); //!< One port per pathname (first is port 0).
 
     using QThread::isRunning;
-    QString serialDevicePathname() const;
+    QString serialDevicePathname() const; //!< Pathname of the first port.
 
 signals:
     void startupState(GatHost *host, GatHostStartupStateId startupState, QString const &description);
@@ -366,16 +945,9 @@ protected:
     //! \name Miscellaneous
     //! @{
 protected slots:
-    virtual void onRxDataReady();
     virtual void onTimer();
-    virtual void onLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer::StateId state);
 
 private:
-    QString portErrorDesc() const;
-
-    QString serialDevicePathname_;
-    QSerialPort serialPort_; // http://qt-project.org/wiki/QtSerialPort#7868ff75ba2ba6671f178bc8fb7da0fd
-    GatLinkLayer gatLinkLayer_;
     QTimer timer_;
     //! @}
 
@@ -409,13 +981,6 @@ GatHostCmd::hostPrivileges() const
 }
 
 
-inline QMutex *
-GatHostCmd::syncDomainGuard() const
-{
-    return host_.syncDomainGuard();
-}
-
-
 #endif // #ifndef GATHOST_HPP__BDE65372_4E6A_46CB_8155_B0A2A7D5BE33__INCLUDED
 
 
@@ -20,6 +20,18 @@ TEMPLATE = app
 #####PRE_TARGETDEPS += Version.hpp
 QMAKE_CXXFLAGS += -std=c++0x
 
+# io_uring serial transport (GatPort::Transport::IoUring) requires liburing: qmake CONFIG+=gat_io_uring
+gat_io_uring {
+    DEFINES += ENABLE_GAT_IO_URING
+    LIBS += -luring
+}
+
+# Coroutine operations (GatCoroutine.hpp, GatHostCoroutineCmd) require C++20: qmake CONFIG+=gat_coroutines
+gat_coroutines {
+    DEFINES += ENABLE_GAT_COROUTINES
+    QMAKE_CXXFLAGS += -std=c++20 -fcoroutines
+}
+
 CONFIG(release, debug|release) {
     #message(Release)
 }
@@ -35,24 +47,56 @@ SOURCES +=\
     GatHost.cpp \
     AboutBox.cpp \
     GatLinkLayer.cpp \
+    GatBuffer.cpp \
+    GatCoroutine.cpp \
     Defs.cpp \
+    GatCrc16.cpp \
     SelectSerialPortDlg.cpp \
     GatMultipktRply.cpp \
     GatSpecialFunctionExec.cpp \
+    GatSpecialFunctionsDecoder.cpp \
+    GatStatusPollPolicy.cpp \
+    GatStatusQueryCoalescer.cpp \
+    GatCalcDurationModel.cpp \
     GatPkt_StatusQueryRslt_SR81.cpp \
-    GatCmdSpec.cpp
+    GatPktCodec.cpp \
+    GatCmdSpec.cpp \
+    GatReplyTimingModel.cpp \
+    GatSerialLineSettings.cpp \
+    GatSerialLowLatency.cpp \
+    GatEpollReactor.cpp \
+    GatTermiosSerialPort.cpp \
+    GatTimerFd.cpp \
+    GatUringEngine.cpp \
+    GatUringSerialPort.cpp
 
 HEADERS  += \
     MainWindow.hpp \
     GatHost.hpp \
     AboutBox.hpp \
     Defs.hpp \
+    GatCrc16.hpp \
     GatLinkLayer.hpp \
+    GatBuffer.hpp \
+    GatCoroutine.hpp \
     SelectSerialPortDlg.hpp \
     GatMultipktRply.hpp \
     GatSpecialFunctionExec.hpp \
+    GatSpecialFunctionsDecoder.hpp \
+    GatStatusPollPolicy.hpp \
+    GatStatusQueryCoalescer.hpp \
+    GatCalcDurationModel.hpp \
     GatPkt_StatusQueryRslt_SR81.hpp \
-    GatCmdSpec.hpp
+    GatPktCodec.hpp \
+    GatCmdSpec.hpp \
+    GatReplyTimingModel.hpp \
+    GatSerialLineSettings.hpp \
+    GatSerialLowLatency.hpp \
+    GatEpollReactor.hpp \
+    GatTermiosSerialPort.hpp \
+    GatTimerFd.hpp \
+    GatUringEngine.hpp \
+    GatUringSerialPort.hpp
 
 FORMS    += \
     MainWindow.ui \
@@ -61,6 +105,10 @@ FORMS    += \
     GatCmdSpec.ui
 
 OTHER_FILES += \
+    Bench/GatCrc16Bench.pro \
+    Bench/GatTransportBench.pro \
+    Tools/GatCaptureVerify.pro \
+    Tests/GatHostTest.pro \
     ../Notes.txt \
     ../README \
     ../LICENSE
@@ -18,23 +18,38 @@
 
 
 #include "GatLinkLayer.hpp"
+#include "GatPktCodec.hpp"
 #include <QMetaType>
 
 
 #define ENABLE_GAT_LINK_LAYER_DEBUG_TIMING
 
 
+/*
+    Timeouts that depend upon the line rate are scaled by the character time (see 'setLineSettings()').
+    At 9600 baud 8N1 the inter-byte timeout is 50ms (34ms + 16ms adapter latency allowance), or 8ms when the
+    strategy times the gap and the adapter is in low latency mode (5ms + 2 character times + 1ms).
+*/
 #ifdef ENABLE_GAT_LINK_LAYER_DEBUG_TIMING
-    const int millisecondsUntilReceiveTimeout = 50;
-    const int millisecondsUntilRplyTimeout = 500;
+    const int millisecondsUntilReceiveTimeout = 5; // Minimum (GAT suggested inter-byte timeout).
+    const uint characterTimesUntilReceiveTimeout = 32;
+    const uint characterTimesUntilInterByteTimeout = 2; // When the strategy times the gap (no QTimer granularity).
+    const int millisecondsUntilRplyTimeout = 500; // From the last byte of the request.
     const int millisecondsUntilNextTransmitAllowedAfterReceive = 10;
     const int millisecondsUntilNextTransmitAllowedAfterTimeout = 25;
+    const int millisecondsUntilNextTransmitAllowedAfterRequest = 225; // From the last byte; when the GM is silent.
+    const int millisecondsMinimumAdaptiveReplyTimeout = 10; // Plus the adapter latency.
 #else
-    const int millisecondsUntilReceiveTimeout = 50;
-    const int millisecondsUntilRplyTimeout = 201;
+    const int millisecondsUntilReceiveTimeout = 5; // Minimum (GAT suggested inter-byte timeout).
+    const uint characterTimesUntilReceiveTimeout = 32;
+    const uint characterTimesUntilInterByteTimeout = 2; // When the strategy times the gap (no QTimer granularity).
+    const int millisecondsUntilRplyTimeout = 201; // From the last byte of the request.
     const int millisecondsUntilNextTransmitAllowedAfterReceive = 10;
     const int millisecondsUntilNextTransmitAllowedAfterTimeout = 25;
+    const int millisecondsUntilNextTransmitAllowedAfterRequest = 225; // From the last byte; when the GM is silent.
+    const int millisecondsMinimumAdaptiveReplyTimeout = 10; // Plus the adapter latency.
 #endif
+    const uint defaultAdapterLatencyInMilliseconds = 16; // FTDI default latency timer.
 
 
 auto
@@ -73,25 +88,56 @@ GatLinkLayer::setState(StateId value) -> StateId
 
 auto
 GatLinkLayer::sendRequest(GatRqst gatRequest, void const *data, uint dataSize) -> RequestResult
+{
+    return sendRequest(gatRequest, data, dataSize, completion_type());
+}
+
+
+auto
+GatLinkLayer::sendRequest(GatRqst gatRequest, void const *data, uint dataSize, completion_type completion)
+    -> RequestResult
 {
     if (nullptr == data && 0 != dataSize) { return RequestResult::InvalidDataSize; }
     if (GAT_MAX_PYLD_SIZE < dataSize) { return RequestResult::InvalidDataSize; }
+    if (requestQueueCapacity <= requestCount_) { return RequestResult::QueueFull; }
+
+    // Create the packet to send (at the tail of the queue).
+    PendingRequest &request = requests_[(requestHead_ + requestCount_) % requestQueueCapacity];
+    uint8_t const command = static_cast<uint8_t>(gatRqstToCode(gatRequest));
+    request.size_ = static_cast<uint>(GatPktFrameCodec::encode(request.data_, command, data, dataSize));
+    request.completion_ = completion;
+
+    bool const queuedBehindOthers = 0 < requestCount_++;
+    RequestResult const result = transmitPendingRequest();
+
+    return queuedBehindOthers && RequestResult::Success == result ? RequestResult::Pending : result;
+}
 
-    // Create the packet to send.
-    requestDataSize_ = 0;
-    requestData_[0] = static_cast<uint8_t>(gatRqstToCode(gatRequest)); // Command byte.
-    requestData_[1] = dataSize + 4/* command + length + CRC */; // Length byte.
-    if (nullptr != data && 0 < dataSize)
+
+void
+GatLinkLayer::discardPendingRequests()
+{
+    for (; 0 < requestCount_; --requestCount_)
     {
-        memcpy(requestData_ + 2, data, (std::min)(GAT_MAX_PYLD_SIZE, dataSize)); // Payload bytes.
+        requests_[requestHead_].completion_ = completion_type();
+        requestHead_ = (requestHead_ + 1) % requestQueueCapacity;
     }
-    size_t const crcIdx = dataSize + 2/* command + length */;
-    uint16_t const crc = calcGatCrc16(requestData_, crcIdx);
-    requestData_[crcIdx + 0] = static_cast<uint8_t>((crc >> 8) & 0xff); // CRC word.
-    requestData_[crcIdx + 1] = static_cast<uint8_t>((crc >> 0) & 0xff);
-    requestDataSize_ = requestData_[1];
+    completion_ = completion_type();
+}
+
 
-    return transmitPendingRequest();
+/*!
+    Calls the completion of the request in progress (if any) exactly once.
+*/
+void
+GatLinkLayer::completeRequest(ResultType resultType)
+{
+    completion_type completion;
+    completion.swap(completion_);
+    if (completion)
+    {
+        try { completion(*this, resultType); } catch (...) { qWarning("Unexpected exception caught and discarded in GatLinkLayer::completeRequest(ResultType). " STRINGIZE(__LINE__)); }
+    }
 }
 
 
@@ -100,17 +146,36 @@ GatLinkLayer::transmitPendingRequest() -> RequestResult
 {
     RequestResult result = RequestResult::Pending;
 
-    if (0 < requestDataSize_)
+    if (0 < requestCount_)
     {
         // Join on state transition and next transmit time.
         bool const stateAllowsTransmit = StateId::Ready == state();
         bool const timeAllowsTransmit = !timer_.isActive();
         if (stateAllowsTransmit && timeAllowsTransmit)
         {
-            // Discard old/previous results (if any).
+            // Discard old/previous results (if any); a reply still viewed by a client keeps its buffer.
+            if (replyBuffer_.isShared())
+            {
+                replyBuffer_ = GatBufferPool::instance().allocate();
+                replyData_ = replyBuffer_.data();
+            }
             replyDataSize_ = 0;
-            memset(replyData_, 0, sizeof(replyData_));
+            memset(replyData_, 0, GAT_MAX_PACKET_SIZE);
             setResultType(ResultType::Undefined);
+            roundTripInMicroseconds_ = -1;
+            discardedByteCount_ = 0;
+
+            // Dequeue the oldest request (it is in progress from here on, and its queue slot may be reused).
+            PendingRequest &request = requests_[requestHead_];
+            requestHead_ = (requestHead_ + 1) % requestQueueCapacity;
+            --requestCount_;
+            requestDataSize_ = request.size_;
+            memcpy(requestData_, request.data_, requestDataSize_);
+            completion_.swap(request.completion_);
+            request.completion_ = completion_type();
+            uint const requestSize = requestDataSize_;
+            lastRequestCmd_ = requestData_[0];
+            ++transmitCount_;
 
             setState(StateId::Transmit);
 
@@ -123,21 +188,21 @@ GatLinkLayer::transmitPendingRequest() -> RequestResult
                 failed = numberOfBytesWritten != requestDataSize_;
             }
 
-            // Clear pending request data.
-            lastRequestCmd_ = requestData_[0];
-            memset(requestData_, 0, sizeof(requestData_));
-            requestDataSize_ = 0;
-
             if (failed)
             {
                 result = RequestResult::UndefinedFailure;
+                completeRequest(ResultType::Undefined);
                 setState(StateId::Ready);
             }
             else
             {
                 result = RequestResult::Success;
+                roundTripTimer_.start();
+                transmitCompleteKnown_ = false;
+                transmitCompleteInMicroseconds_ = static_cast<qint64>(requestSize) * microsecondsPerCharacter_;
+                firstByteInMicroseconds_ = -1;
                 setState(StateId::Receive);
-                timer_.setInterval(millisecondsUntilRplyTimeout); // Time until timeout.
+                timer_.setInterval(replyTimeoutInMilliseconds(requestSize)); // Time until timeout.
                 timer_.setSingleShot(true);
                 timer_.start();
             }
@@ -148,6 +213,27 @@ GatLinkLayer::transmitPendingRequest() -> RequestResult
 }
 
 
+/*!
+    Called by a strategy that can tell when the request has actually left the device (rather than when it was
+    queued by 'write()').  The reply deadline is restarted from now, and the gap before the next request (when the GM
+    does not reply) is measured from now rather than from the estimate.  Strategies that never call this (e.g.
+    QSerialPort's) keep the estimates: the request leaves its transmit time after it was written.
+*/
+void
+GatLinkLayer::transmitComplete()
+{
+    if (StateId::Receive != state() || transmitCompleteKnown_) { return; }
+
+    transmitCompleteKnown_ = true;
+    transmitCompleteInMicroseconds_ = roundTripTimer_.nsecsElapsed() / 1000;
+    if (timer_.isActive() && 0 > firstByteInMicroseconds_)
+    {
+        timer_.setInterval(firstByteTimeoutInMilliseconds()); // Time until timeout (from the last byte).
+        timer_.start();
+    }
+}
+
+
 void
 GatLinkLayer::onTimer()
 {
@@ -172,99 +258,243 @@ GatLinkLayer::receiveData(void const *data, size_t dataSizeInBytes)
 {
     if (nullptr == data || 0 == dataSizeInBytes) { return; }
 
-    // [Re]start end-of-packet inter-character period measurement timer.
-    receiveDataTimer_.setInterval(millisecondsUntilReceiveTimeout); // Time until timeout.
-    receiveDataTimer_.setSingleShot(true);
-    receiveDataTimer_.start();
-
-    Q_ASSERT(sizeof(char) == sizeof(uint8_t));
-    emit onReceiveData(this, QByteArray(static_cast<char const *>(data), dataSizeInBytes));
+    onDataReceived(data, dataSizeInBytes);
 
     bool const responseAlreadyPending = ResultType::Undefined != resultType();
     if (responseAlreadyPending) { return; }
 
-    // Append new data to buffer.
-    Q_ASSERT(arycap(replyData_) > replyDataSize_);
-    uint const byteCountToConsume = (std::min)(dataSizeInBytes, arycap(replyData_) - replyDataSize_);
-    memcpy(replyData_ + replyDataSize_, data, byteCountToConsume);
-    replyDataSize_ += byteCountToConsume;
+    // Append new data to buffer, as much as fits at a time: framing discards what cannot be the reply, which makes
+    // room for the rest of the data (the reply may follow noise that would not leave room for it).
+    uint8_t const *bytes = static_cast<uint8_t const *>(data);
+    while (0 < dataSizeInBytes && ResultType::Undefined == resultType())
+    {
+        size_t const byteCountToConsume = (std::min)(dataSizeInBytes, GAT_MAX_PACKET_SIZE - replyDataSize_);
+        if (0 == byteCountToConsume) { break; } // A full buffer holds a complete candidate, so this cannot happen.
+        memcpy(replyData_ + replyDataSize_, bytes, byteCountToConsume);
+        replyDataSize_ += byteCountToConsume;
+        bytes += byteCountToConsume;
+        dataSizeInBytes -= byteCountToConsume;
+
+        analyzeReplyData();
+    }
+}
 
-    // Analyze buffer contents to detect when a complete packet arrives.
-    bool invalidResponse = false;
-    if (4 <= replyDataSize_)
+
+/*!
+    Returns the unused portion of the reply buffer so that a client can read serial data directly into it
+    (instead of into an intermediate buffer for 'receiveData()').  The client must call 'receivedIntoBuffer()'
+    immediately after writing to the buffer.  (nullptr, 0) is returned when received data would be discarded,
+    in which case the client must read into its own buffer and call 'receiveData()'.
+*/
+auto
+GatLinkLayer::receiveBuffer() -> receive_buffer_type
+{
+    bool const responseAlreadyPending = ResultType::Undefined != resultType();
+    if (responseAlreadyPending || GAT_MAX_PACKET_SIZE <= replyDataSize_) { return receive_buffer_type(nullptr, 0); }
+
+    return receive_buffer_type(replyData_ + replyDataSize_, GAT_MAX_PACKET_SIZE - replyDataSize_);
+}
+
+
+void
+GatLinkLayer::receivedIntoBuffer(size_t dataSizeInBytes)
+{
+    if (0 == dataSizeInBytes) { return; }
+
+    Q_ASSERT(GAT_MAX_PACKET_SIZE >= replyDataSize_ + dataSizeInBytes);
+    size_t const byteCountConsumed = (std::min)(dataSizeInBytes, GAT_MAX_PACKET_SIZE - replyDataSize_);
+    uint8_t const *data = replyData_ + replyDataSize_;
+    replyDataSize_ += byteCountConsumed;
+
+    onDataReceived(data, byteCountConsumed);
+    analyzeReplyData();
+}
+
+
+void
+GatLinkLayer::onDataReceived(void const *data, size_t dataSizeInBytes)
+{
+    // [Re]start end-of-packet inter-character period measurement timer (unless the strategy measures it).
+    if (nullptr == strategy() || !strategy()->providesInterByteTimeout())
     {
-        uint8_t const expectedResponseCmd = lastRequestCmd_ | 0x80;
-        if (expectedResponseCmd != replyData_[0])
+        receiveDataTimer_.setInterval(receiveTimeoutInMilliseconds()); // Time until timeout.
+        receiveDataTimer_.setSingleShot(true);
+        receiveDataTimer_.start();
+    }
+
+    // Only copied for subscribers (e.g. a traffic log).
+    if (0 < receivers(SIGNAL(onReceiveData(GatLinkLayer*, QByteArray))))
+    {
+        Q_ASSERT(sizeof(char) == sizeof(uint8_t));
+        emit onReceiveData(this, QByteArray(static_cast<char const *>(data), dataSizeInBytes));
+    }
+}
+
+
+/*!
+    Frames the reply in 'replyData_' incrementally (called whenever data arrives).
+
+    Bytes that cannot start the reply (line noise, or the late reply to an earlier request) are discarded: the
+    buffer is scanned forward for the expected command byte followed by a plausible length, and a candidate whose
+    CRC does not match is skipped by one byte and the scan resumes, so a valid reply is recovered from a noisy
+    buffer as soon as its last byte arrives.  A candidate that is still incomplete is waited for, unless
+    'endOfData' (the inter-byte timeout elapsed), in which case it is skipped too.  Returns true when the reply was
+    completed (valid or invalid).
+*/
+bool
+GatLinkLayer::analyzeReplyData(bool endOfData)
+{
+    uint8_t const expectedResponseCmd = lastRequestCmd_ | 0x80;
+    for (;;)
+    {
+        // Find the next candidate header.
+        uint start = 0;
+        while (replyDataSize_ > start &&
+               (expectedResponseCmd != replyData_[start] ||
+                (replyDataSize_ > start + 1 && 4/* command + length + CRC */ > replyData_[start + 1])))
         {
-            invalidResponse = true;
+            ++start;
         }
-        else
+        discardReplyData(start);
+        if (0 == replyDataSize_) { return false; } // Only noise so far.
+
+        // The GAT deadline is for the start of the reply; once it starts, allow for the whole packet.
+        if (StateId::Receive == state() && 0 > firstByteInMicroseconds_)
         {
-            size_t const length = replyData_[1];
-            if (length <= replyDataSize_)
+            firstByteInMicroseconds_ = roundTripTimer_.nsecsElapsed() / 1000;
+            if (timer_.isActive())
             {
-                uint16_t const packetCrc = static_cast<uint16_t>((static_cast<uint16_t>(replyData_[length - 2]) << 8) |
-                                                                 (static_cast<uint16_t>(replyData_[length - 1]) << 0));
-                uint16_t const calculatedCrc = calcGatCrc16(replyData_, length - 2/* CRC */);
-                if (packetCrc == calculatedCrc)
-                {
-                    replyDataSize_ = length;
-                    setResultType(ResultType::Reply);
-
-                    setState(StateId::Reply);
-                    setState(StateId::Ready);
-
-                    // Set timer to signal when next transmission can be sent.
-                    timer_.setInterval(millisecondsUntilNextTransmitAllowedAfterReceive);
-                    timer_.setSingleShot(true);
-                    timer_.start();
-                }
-                else
-                {
-                    invalidResponse = true;
-                }
-
-                receiveDataTimer_.stop(); // Stop watching for end of transmission.
-
-                Q_ASSERT(sizeof(char) == sizeof(replyData_[0]));
-                emit onReceivePacket(this, QByteArray(reinterpret_cast<char const *>(replyData_), replyDataSize_), invalidResponse);
+                timer_.setInterval(packetTimeoutInMilliseconds());
+                timer_.start();
             }
         }
-    }
-    if (invalidResponse)
-    {
-        // Invalid response received.
-        std::fill_n(replyData_, arycap(replyData_), 0);
-        replyDataSize_ = 0;
-        setResultType(ResultType::InvalidResponse);
+
+        size_t const length = 2 <= replyDataSize_ ? replyData_[1] : GAT_MAX_PACKET_SIZE;
+        if (length > replyDataSize_)
+        {
+            if (!endOfData) { return false; } // Wait for the rest.
+            discardReplyData(1); // Truncated (or a false header); look further.
+            continue;
+        }
+
+        if (!GatPktFrameCodec::crcIsValid(replyData_, length))
+        {
+            discardReplyData(1); // A false header; look further.
+            continue;
+        }
+
+        replyDataSize_ = length;
+        roundTripInMicroseconds_ = roundTripTimer_.nsecsElapsed() / 1000;
+        if (0 <= firstByteInMicroseconds_)
+        {
+            qint64 const firstByteLatency = firstByteInMicroseconds_ - transmitCompleteInMicroseconds_;
+            qint64 const packetDuration = roundTripInMicroseconds_ - firstByteInMicroseconds_;
+            replyTiming_.addReply(lastRequestCmd_, firstByteLatency, packetDuration);
+        }
+        setResultType(ResultType::Reply);
+
+        // Set timer to signal when next transmission can be sent (before 'Ready' transmits).
+        startNextTransmitTimer(millisecondsUntilNextTransmitAllowedAfterReceive);
 
         setState(StateId::Reply);
+        completeRequest(ResultType::Reply);
         setState(StateId::Ready);
+
+        receiveDataTimer_.stop(); // Stop watching for end of transmission.
+
+        if (0 < receivers(SIGNAL(onReceivePacket(GatLinkLayer*, QByteArray, bool))))
+        {
+            emit onReceivePacket(this, replyView().toByteArray(), false);
+        }
+        return true;
     }
 }
 
 
+void
+GatLinkLayer::discardReplyData(uint byteCount)
+{
+    if (0 == byteCount) { return; }
+
+    byteCount = (std::min)(byteCount, replyDataSize_);
+    if (0 < receivers(SIGNAL(onReceivePacket(GatLinkLayer*, QByteArray, bool))))
+    {
+        emit onReceivePacket(this, replyView().mid(0, byteCount).toByteArray(), true);
+    }
+
+    replyDataSize_ -= byteCount;
+    memmove(replyData_, replyData_ + byteCount, replyDataSize_);
+    discardedByteCount_ += byteCount;
+}
+
+
 void
 GatLinkLayer::receiveTimeout()
 {
     if (StateId::Receive == state() &&
         !timer_.isActive())
     {
-        std::fill_n(replyData_, arycap(replyData_), 0);
+        std::fill_n(replyData_, GAT_MAX_PACKET_SIZE, 0);
         replyDataSize_ = 0;
+        if (0 > firstByteInMicroseconds_) { replyTiming_.addTimeout(lastRequestCmd_); }
         setResultType(ResultType::Timeout);
 
+        // Set timer to signal when next transmission can be sent: the silent GM gets the whole gap from the last byte
+        // of the request, whether its transmission is known to be complete or only estimated (from when it was
+        // written), however short the reply deadline was.  Only an estimate is padded to the gap after a timeout.
+        // This must precede 'Ready', which transmits the next queued request when no timer is running.
+        qint64 const sinceTransmitCompleteInMicroseconds = roundTripTimer_.nsecsElapsed() / 1000 -
+                                                           transmitCompleteInMicroseconds_;
+        qint64 const remainingInMicroseconds = static_cast<qint64>(millisecondsUntilNextTransmitAllowedAfterRequest) *
+                                               1000 - sinceTransmitCompleteInMicroseconds;
+        int interval = static_cast<int>((std::max)(static_cast<qint64>(0), (remainingInMicroseconds + 999) / 1000));
+        if (!transmitCompleteKnown_)
+        {
+            interval = (std::max)(interval, millisecondsUntilNextTransmitAllowedAfterTimeout);
+        }
+        startNextTransmitTimer(interval);
+
         setState(StateId::Timeout);
+        completeRequest(ResultType::Timeout);
         setState(StateId::Ready);
-
-        // Set timer to signal when next transmission can be sent.
-        timer_.setInterval(millisecondsUntilNextTransmitAllowedAfterTimeout);
-        timer_.setSingleShot(true);
-        timer_.start();
     }
 }
 
 
+/*!
+    A false candidate header moved the reply deadline to allow for a whole packet (see 'analyzeReplyData()'); once
+    it is discarded, the deadline is again for the first byte of the reply, from the end of the request.
+*/
+void
+GatLinkLayer::restoreFirstByteDeadline()
+{
+    if (0 > firstByteInMicroseconds_) { return; }
+
+    firstByteInMicroseconds_ = -1;
+    qint64 const deadlineInMicroseconds = transmitCompleteInMicroseconds_ +
+                                          static_cast<qint64>(firstByteTimeoutInMilliseconds()) * 1000;
+    qint64 const remainingInMicroseconds = deadlineInMicroseconds - roundTripTimer_.nsecsElapsed() / 1000;
+    timer_.setInterval(static_cast<int>((std::max)(static_cast<qint64>(0), (remainingInMicroseconds + 999) / 1000)));
+    timer_.start();
+}
+
+
+void
+GatLinkLayer::startNextTransmitTimer(int milliseconds)
+{
+    timer_.setInterval(milliseconds);
+    timer_.setSingleShot(true);
+    timer_.start();
+}
+
+
+void
+GatLinkLayer::interByteTimeoutElapsed()
+{
+    receiveDataTimeout();
+}
+
+
 void
 GatLinkLayer::receiveDataTimeout()
 {
@@ -273,20 +503,109 @@ GatLinkLayer::receiveDataTimeout()
     receiveDataTimer_.stop(); // Stop watching for end of transmission.
 
     bool const responseAlreadyPending = ResultType::Undefined != resultType();
-    if (responseAlreadyPending || 0 == replyDataSize_) { return; }
+    if (responseAlreadyPending || StateId::Receive != state()) { return; }
+
+    // Recover a complete reply behind an incomplete candidate (everything else is discarded).
+    if (analyzeReplyData(true)) { return; }
 
-    Q_ASSERT(sizeof(char) == sizeof(replyData_[0]));
-    emit onReceivePacket(this, QByteArray(reinterpret_cast<char const *>(replyData_), replyDataSize_), true);
+    // Only bytes that are not the reply so far (e.g. a late echo, or noise): the reply may still start before its
+    // deadline, which 'timer_' watches (see 'receiveTimeout()').
+    if (timer_.isActive())
+    {
+        restoreFirstByteDeadline();
+        return;
+    }
+
+    // The GM sent something, then stopped, and none of it is the reply.
+    if (0 == discardedByteCount_) { return; }
 
-    std::fill_n(replyData_, arycap(replyData_), 0);
+    std::fill_n(replyData_, GAT_MAX_PACKET_SIZE, 0);
     replyDataSize_ = 0;
     setResultType(ResultType::InvalidResponse);
 
+    // Set timer to signal when next transmission can be sent (before 'Ready' transmits).
+    startNextTransmitTimer(millisecondsUntilNextTransmitAllowedAfterReceive);
+
     setState(StateId::Reply);
+    completeRequest(ResultType::InvalidResponse);
     setState(StateId::Ready);
 }
 
 
+void
+GatLinkLayer::setLineSettings(GatSerialLineSettings const &lineSettings)
+{
+    if (lineSettings.isValid()) { microsecondsPerCharacter_ = lineSettings.microsecondsPerCharacter(); }
+    adaptiveReplyTimeout_ = lineSettings.adaptiveReplyTimeout_;
+}
+
+
+int
+GatLinkLayer::receiveTimeoutInMilliseconds() const
+{
+    uint const characterTimesInMicroseconds = characterTimesUntilReceiveTimeout * microsecondsPerCharacter_;
+    int const characterTimes = static_cast<int>((characterTimesInMicroseconds + 999u) / 1000u);
+    int const adapterLatency = static_cast<int>(adapterLatencyInMilliseconds_);
+    return (std::max)(millisecondsUntilReceiveTimeout, characterTimes) + adapterLatency;
+}
+
+
+void
+GatLinkLayer::resetAdapterLatency()
+{
+    adapterLatencyInMilliseconds_ = defaultAdapterLatencyInMilliseconds;
+}
+
+
+/*!
+    The strategy measures the gap precisely (from when each chunk is read), so this needs no allowance for timer
+    or event loop granularity; only for the adapter holding received data.
+*/
+qint64
+GatLinkLayer::interByteTimeoutInMicroseconds() const
+{
+    return static_cast<qint64>(millisecondsUntilReceiveTimeout) * 1000 +
+           static_cast<qint64>(characterTimesUntilInterByteTimeout * microsecondsPerCharacter_) +
+           static_cast<qint64>(adapterLatencyInMilliseconds_) * 1000;
+}
+
+
+/*!
+    The GAT reply deadline is measured from the last byte of the request, but the request is only queued for
+    transmission when it is written, so its transmit time is added.
+*/
+int
+GatLinkLayer::replyTimeoutInMilliseconds(uint requestSizeInBytes) const
+{
+    int const transmitTime = static_cast<int>((requestSizeInBytes * microsecondsPerCharacter_ + 999u) / 1000u);
+    return firstByteTimeoutInMilliseconds() + transmitTime;
+}
+
+
+/*!
+    The GAT deadline, or (when adaptive) the deadline the GM's observed latency for the last request's command
+    supports (see 'GatReplyTimingModel'), which is never less than the minimum plus the adapter latency.
+*/
+int
+GatLinkLayer::firstByteTimeoutInMilliseconds() const
+{
+    if (!adaptiveReplyTimeout_) { return millisecondsUntilRplyTimeout; }
+
+    qint64 const floor = static_cast<qint64>(millisecondsMinimumAdaptiveReplyTimeout + adapterLatencyInMilliseconds_);
+    qint64 const timeout = replyTiming_.firstByteTimeoutInMicroseconds(lastRequestCmd_, floor * 1000,
+                                                                       millisecondsUntilRplyTimeout * 1000);
+    return static_cast<int>((timeout + 999) / 1000);
+}
+
+
+int
+GatLinkLayer::packetTimeoutInMilliseconds() const
+{
+    int const transmitTime = static_cast<int>((GAT_MAX_PACKET_SIZE * microsecondsPerCharacter_ + 999u) / 1000u);
+    return transmitTime + receiveTimeoutInMilliseconds();
+}
+
+
 GatLinkLayerStrategyInterface *
 GatLinkLayer::setStrategy(GatLinkLayerStrategyInterface *newStrategy)
 {
@@ -316,15 +635,29 @@ GatLinkLayer::GatLinkLayer(QObject *parent)
     , state_(StateId::Undefined)
     , requestDataSize_(0)
     , lastRequestCmd_(0)
+    , transmitCount_(0)
+    , transmitCompleteKnown_(false)
+    , transmitCompleteInMicroseconds_(0)
+    , firstByteInMicroseconds_(-1)
+    , replyBuffer_(GatBufferPool::instance().allocate())
+    , replyData_(replyBuffer_.data())
     , replyDataSize_(0)
+    , discardedByteCount_(0)
     , resultType_(ResultType::Undefined)
+    , requestHead_(0)
+    , requestCount_(0)
+    , microsecondsPerCharacter_(GatSerialLineSettings().microsecondsPerCharacter())
+    , adapterLatencyInMilliseconds_(defaultAdapterLatencyInMilliseconds)
+    , roundTripInMicroseconds_(-1)
+    , adaptiveReplyTimeout_(false)
     , strategy_(nullptr)
 {
     //qRegisterMetaType<CGatLinkLayer>("CGatLinkLayer");
 
     memset(requestData_, 0, sizeof(requestData_));
-    memset(replyData_, 0, sizeof(replyData_));
+    memset(replyData_, 0, GAT_MAX_PACKET_SIZE);
     timer_.setParent(this);
+    timer_.setTimerType(Qt::PreciseTimer); // GAT gaps are a few milliseconds; coarse timers may be 5% late.
     receiveDataTimer_.setParent(this);
     connect(&timer_, SIGNAL(timeout()), this, SLOT(onTimer()));
     connect(&receiveDataTimer_, SIGNAL(timeout()), this, SLOT(onRxdTimer()));
@@ -25,8 +25,13 @@
 
 
 #include "Defs.hpp"
+#include "GatBuffer.hpp"
+#include "GatReplyTimingModel.hpp"
+#include "GatSerialLineSettings.hpp"
 #include <QObject>
+#include <QElapsedTimer>
 #include <QTimer>
+#include <functional>
 
 
 class GatLinkLayer;
@@ -36,11 +41,19 @@ struct GatLinkLayerStrategyInterface
 {
     virtual uint write(GatLinkLayer &host, void const *data, uint dataSizeInBytes) = 0;
     virtual void onLinkToHost(GatLinkLayer *host) = 0;
+
+    //! True when the strategy times the gap after received data itself and calls
+    //! 'GatLinkLayer::interByteTimeoutElapsed()' (instead of the link layer rearming a QTimer per chunk).
+    virtual bool providesInterByteTimeout() const { return false; }
 };
 
 
 /*!
     \brief GAT link layer; transmission and reception of one request and its corresponding reply.
+
+    Requests are queued (bounded FIFO) and each is transmitted at the earliest moment the GAT rules allow after the
+    previous one's reply (or timeout), so a client may queue its next request(s) without waiting for a reply.  Each
+    request may have a completion that is called with its result, when the reply (if any) is available via 'reply()'.
 */
 class GatLinkLayer
     : public QObject
@@ -80,11 +93,13 @@ public:
         Success,
         Pending,
         UndefinedFailure,
+        QueueFull,
         InvalidDataSize // This must be last.
     };
     size_t const requestResult_Count = static_cast<size_t>(RequestResult::InvalidDataSize) + 1;
 
-    bool requestPending() const { return 0 < requestDataSize_; }
+    bool requestPending() const { return 0 < requestCount_; } //!< Queued; not yet transmitted.
+    uint transmitCount() const { return transmitCount_; } //!< Requests transmitted so far (wraps).
 
 signals:
     void onTxPacket(GatLinkLayer *host, QByteArray packetData);
@@ -96,14 +111,23 @@ protected slots:
     virtual void onTimer();
     virtual void onRxdTimer();
 
+public:
+    void transmitComplete(); //!< Strategy calls (optional) once the last byte of the request has left the device.
+
 protected:
     RequestResult transmitPendingRequest();
+    void startNextTransmitTimer(int milliseconds); //!< Earliest time the next request may be transmitted.
+    void restoreFirstByteDeadline(); //!< After a false candidate header (see 'receiveDataTimeout()').
 
 private:
-    uint8_t requestData_[GAT_MAX_PACKET_SIZE];
-    uint requestDataSize_; // Number of items in 'mvRequestData' (size of content).
+    uint8_t requestData_[GAT_MAX_PACKET_SIZE]; // Request in progress (dequeued).
+    uint requestDataSize_; // Number of items in 'requestData_' (size of content).
     uint8_t lastRequestCmd_; // "Cmd" field of last request sent.
+    uint transmitCount_; // Requests dequeued for transmit.
     QTimer timer_;
+    bool transmitCompleteKnown_; // 'transmitComplete()' was called for the last request sent.
+    qint64 transmitCompleteInMicroseconds_; // When the last request left (per 'roundTripTimer_'); estimated or known.
+    qint64 firstByteInMicroseconds_; // When the first byte of the reply arrived (per 'roundTripTimer_'); -1 if none.
     //! @}
 
     //! \name Receive Data (RxD)
@@ -111,9 +135,17 @@ private:
 public:
     void receiveData(void const *data, size_t dataSizeInBytes); //!< Client calls whenever data arrives (at any time).
 
+    typedef ::std::pair<void *, size_t> receive_buffer_type; // Data pointer + number of bytes available.
+    receive_buffer_type receiveBuffer(); //!< Unused reply buffer space; (nullptr, 0) when data would be discarded.
+    void receivedIntoBuffer(size_t dataSizeInBytes); //!< Client calls after reading directly into 'receiveBuffer()'.
+    void interByteTimeoutElapsed(); //!< Strategy calls (see its 'providesInterByteTimeout()').
+
 protected:
     void receiveTimeout(); //!< Handle timeout [when] in receive state.
     void receiveDataTimeout();
+    void onDataReceived(void const *data, size_t dataSizeInBytes);
+    bool analyzeReplyData(bool endOfData = false);
+    void discardReplyData(uint byteCount); //!< From the front of 'replyData_' (resynchronization).
 
 signals:
     void onReceiveData(GatLinkLayer *host, QByteArray rawData);
@@ -128,6 +160,7 @@ private:
 public:
     typedef ::std::pair<void const *, uint> reply_type; // Data pointer + number of bytes addressed.
     reply_type reply() { return reply_type(replyData_, replyDataSize_); }
+    GatByteView replyView() const { return GatByteView(replyBuffer_, 0, replyDataSize_); } //!< Shares (no copy).
 
     enum class ResultType : size_t {
         Reply,
@@ -143,11 +176,75 @@ protected:
     ResultType setResultType(ResultType value) { return (resultType_ = value); }
 
 private:
-    uint8_t replyData_[GAT_MAX_PACKET_SIZE];
+    GatBuffer replyBuffer_; // Replaced (not overwritten) by the next request while a 'replyView()' is held.
+    uint8_t *replyData_; // Content of 'replyBuffer_'.
     uint replyDataSize_; // Number of items in 'replyData_' (size of content).
+    uint discardedByteCount_; // Received for the request in progress but discarded (not part of its reply).
     ResultType resultType_;
     //! @}
 
+    //! \name Request Queue
+    //! @{
+public:
+    typedef std::function<void (GatLinkLayer &host, ResultType resultType)> completion_type;
+    static uint const requestQueueCapacity = 8;
+
+    RequestResult sendRequest(GatRqst gatRequest, void const *data, uint dataSize, completion_type completion);
+    uint pendingRequestCount() const { return requestCount_; }
+    void discardPendingRequests(); //!< And the completion of the request in progress (if any); none are called.
+
+private:
+    struct PendingRequest
+    {
+        uint8_t data_[GAT_MAX_PACKET_SIZE];
+        uint size_; // Number of items in 'data_' (size of content).
+        completion_type completion_;
+    };
+
+    void completeRequest(ResultType resultType); //!< Of the request in progress.
+
+    PendingRequest requests_[requestQueueCapacity]; // FIFO (ring); oldest at 'requestHead_'.
+    uint requestHead_;
+    uint requestCount_;
+    completion_type completion_; // Of the request in progress.
+    //! @}
+
+    //! \name Line Timing
+    //! @{
+public:
+    void setLineSettings(GatSerialLineSettings const &lineSettings); //!< Scales timeouts to the line's rate, etc.
+    int receiveTimeoutInMilliseconds() const; //!< Inter-byte (end of reply) timeout (QTimer).
+    qint64 interByteTimeoutInMicroseconds() const; //!< Inter-byte (end of reply) timeout (strategy timed).
+    int replyTimeoutInMilliseconds(uint requestSizeInBytes) const; //!< From when the request is written.
+    void setAdapterLatency(uint milliseconds) { adapterLatencyInMilliseconds_ = milliseconds; }
+    void resetAdapterLatency(); //!< To the default (an FTDI-style adapter's default latency timer).
+    uint adapterLatencyInMilliseconds() const { return adapterLatencyInMilliseconds_; }
+    qint64 roundTripInMicroseconds() const { return roundTripInMicroseconds_; } //!< Of last valid reply; -1 if none.
+
+private:
+    uint microsecondsPerCharacter_;
+    uint adapterLatencyInMilliseconds_; // Time a USB-serial adapter may hold received data before delivering it.
+    QElapsedTimer roundTripTimer_; // Started when the request is written.
+    qint64 roundTripInMicroseconds_;
+    //! @}
+
+    //! \name Reply Timing
+    //! @{
+public:
+    void setAdaptiveReplyTimeout(bool enable) { adaptiveReplyTimeout_ = enable; } //!< Off until 'setLineSettings()'.
+    bool adaptiveReplyTimeout() const { return adaptiveReplyTimeout_; }
+    GatReplyTimingModel const & replyTiming() const { return replyTiming_; }
+    void resetReplyTiming() { replyTiming_.reset(); } //!< When a different GM may be attached.
+
+protected:
+    int firstByteTimeoutInMilliseconds() const; //!< Of the last request sent; from its last byte.
+    int packetTimeoutInMilliseconds() const; //!< From the first byte of the reply.
+
+private:
+    GatReplyTimingModel replyTiming_;
+    bool adaptiveReplyTimeout_;
+    //! @}
+
     //! \name Strategy
     //! @{
 public:
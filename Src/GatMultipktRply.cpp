@@ -16,6 +16,7 @@
 
 
 #include "GatMultipktRply.hpp"
+#include "GatPktCodec.hpp"
 
 
 auto
@@ -63,15 +64,52 @@ GatMultipktRply::sendRequest(GatDataFormat dataFormat)
 
 
 bool
-GatMultipktRply::transmitLarq()
+GatFrameRetries::retry()
+{
+    if (limit_ <= frameRetryCount_) { return false; }
+
+    ++frameRetryCount_;
+    ++retryCount_;
+    return true;
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+QByteArray
+GatMultipktRply::larqPayload(GatDataFormat dataFormat, uint frameNumber)
+{
+    uint8_t larq[GatPktDesc_LARQ::maxSize];
+    GatPktDesc_LARQ::DataFormat::encode(larq, gatDataFormatIdToCode(dataFormat));
+    GatPktDesc_LARQ::FrameNumber::encode(larq, frameNumber);
+    return QByteArray(reinterpret_cast<char const *>(larq + GatPktDesc_LARQ::payloadOffset),
+                      static_cast<int>(GatPktDesc_LARQ::maxSize - GatPktDesc_LARQ::overhead));
+}
+
+
+/*!
+    Of the link layer's answer to the LARQ of 'frameNumber' ('reply' is its packet when 'resultType' is 'Reply').
+*/
+auto
+GatMultipktRply::checkFrame(GatLinkLayer::ResultType resultType, GatByteView const &reply, uint frameNumber)
+    -> FrameCheck
 {
-    uint8_t larqPayload[] = {
-        static_cast<uint8_t>(gatDataFormatIdToCode(dataFormat())),
-        static_cast<uint8_t>((frameNumber() >> 8) & 0xff),
-        static_cast<uint8_t>((frameNumber() >> 0) & 0xff),
-    };
+    if (GatLinkLayer::ResultType::Reply != resultType) { return FrameCheck::Retry; }
+
+    GatPktView_LARR const larr(reply.data(), reply.size());
+    if (!larr.isValid() || frameNumber != larr.frameNumber()) { return FrameCheck::Retry; }
+
+    return larr.gatError() ? FrameCheck::Fail : FrameCheck::Accept;
+}
+
 
-    auto const sendRequestResult = linkLayer()->sendRequest(GatRqst::LARQ_03, larqPayload, sizeof(larqPayload));
+bool
+GatMultipktRply::transmitLarq()
+{
+    QByteArray const larq(larqPayload(dataFormat(), frameNumber()));
+    auto const sendRequestResult = linkLayer()->sendRequest(GatRqst::LARQ_03, larq.constData(),
+                                                            static_cast<uint>(larq.size()));
     if (GatLinkLayer::RequestResult::Success != sendRequestResult &&
         GatLinkLayer::RequestResult::Pending != sendRequestResult)
     {
@@ -84,9 +122,50 @@ GatMultipktRply::transmitLarq()
 }
 
 
+/*!
+    Requests the current frame again (frames already received are kept), unless the frame has used up its retries.
+    The link layer holds the request until the GAT gap after the failure has elapsed.
+*/
+bool
+GatMultipktRply::retryFrame()
+{
+    if (!frameRetries_.retry()) { return false; }
+
+#ifdef DEBUG
+    qDebug() << "LARQ: retrying frame" << frameNumber() << "- retry" << frameRetries_.frameRetryCount() << "of"
+             << frameRetries_.limit();
+#endif // #ifdef DEBUG
+
+    return transmitLarq();
+}
+
+
+void
+GatMultipktRply::deliverFrame(uint frameNumber, GatByteView const &frameData, bool lastFrame)
+{
+    if (nullptr == frameSink_)
+    {
+        results_.append(frameData);
+        return;
+    }
+
+    try { frameSink_->onFrame(*this, frameNumber, frameData, lastFrame); } catch (...) { qWarning("Unexpected exception caught and discarded in GatMultipktRply::deliverFrame(). " STRINGIZE(__LINE__)); }
+}
+
+
+void
+GatMultipktRply::failFrameSink()
+{
+    if (nullptr == frameSink_) { return; }
+
+    try { frameSink_->onTransferFailed(*this); } catch (...) { qWarning("Unexpected exception caught and discarded in GatMultipktRply::failFrameSink(). " STRINGIZE(__LINE__)); }
+}
+
+
 void
 GatMultipktRply::onTimeout()
 {
+    failFrameSink();
     unsubscribeFromLinkLayer();
     clearResults();
     setResultType(ResultType::Timeout);
@@ -98,6 +177,7 @@ GatMultipktRply::onTimeout()
 void
 GatMultipktRply::onInvalidResponse()
 {
+    failFrameSink();
     unsubscribeFromLinkLayer();
     clearResults();
     setResultType(ResultType::InvalidResponse);
@@ -113,6 +193,7 @@ GatMultipktRply::clearResults()
     setFrameNumber(0);
     setResultType(ResultType::Undefined);
     results_.clear();
+    frameRetries_.reset();
 }
 
 
@@ -182,7 +263,7 @@ GatMultipktRply::onGatLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer::St
 
             case GatLinkLayer::StateId::Timeout:
             {
-                onTimeout();
+                if (!retryFrame()) { onTimeout(); }
                 break;
             }
 
@@ -193,34 +274,27 @@ GatMultipktRply::onGatLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer::St
                     case GatLinkLayer::ResultType::Reply:
                     {
                         // Get reply data from link layer.
-                        GatLinkLayer::reply_type const reply(linkLayer()->reply());
-                        void const *replyData = reply.first;
-                        uint const replySize = reply.second;
-                        if (nullptr == replyData ||
-                            7 > replySize ||
-                            GatLinkLayer::ResultType::Reply != linkLayer()->resultType())
+                        GatByteView const reply(linkLayer()->replyView());
+                        FrameCheck const frameCheck = checkFrame(linkLayer()->resultType(), reply, frameNumber());
+                        if (FrameCheck::Retry == frameCheck)
                         {
-                            onInvalidResponse();
+                            if (!retryFrame()) { onInvalidResponse(); }
                             break;
                         }
 
-                        // Parse status and frame number.
-                        uint8_t const *replyBytes = reinterpret_cast<uint8_t const *>(replyData);
-                        bool const gatError = 0 != (replyBytes[2] & 0x1);
-                        bool const lastFrame = 0 != (replyBytes[2] & 0x2);
-                        uint const packetFrameNumber = (static_cast<uint>(replyBytes[3] & 0xff) << 8)
-                                                       | static_cast<uint>(replyBytes[4] & 0xff);
-                        if (frameNumber() != packetFrameNumber ||
-                            gatError)
+                        // The GM reported an error (not noise); asking again will not help.
+                        if (FrameCheck::Accept != frameCheck)
                         {
                             onInvalidResponse();
                             break;
                         }
+                        GatPktView_LARR const larr(reply.data(), reply.size());
 
-                        // Append frame data to accumulated.
-                        std::copy(replyBytes + 5, replyBytes + 5 + replySize - 7, std::back_inserter(results_));
+                        // Deliver or accumulate frame data (a view; the link layer keeps the packet for it).
+                        deliverFrame(larr.frameNumber(), reply.mid(larr.dataOffset(), larr.dataSize()),
+                                     larr.lastFrame());
 
-                        if (lastFrame)
+                        if (larr.lastFrame())
                         {
                             unsubscribeFromLinkLayer();
                             setResultType(ResultType::Reply);
@@ -230,6 +304,7 @@ GatMultipktRply::onGatLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer::St
                         else
                         {
                             // Move to next frame.
+                            frameRetries_.nextFrame();
                             setFrameNumber(frameNumber() + 1);
                             transmitLarq();
                         }
@@ -240,13 +315,13 @@ GatMultipktRply::onGatLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer::St
                     case GatLinkLayer::ResultType::InvalidResponse:
                     default:
                     {
-                        onInvalidResponse();
+                        if (!retryFrame()) { onInvalidResponse(); }
                         break;
                     }
 
                     case GatLinkLayer::ResultType::Timeout:
                     {
-                        onTimeout();
+                        if (!retryFrame()) { onTimeout(); }
                         break;
                     }
                 }
@@ -263,6 +338,8 @@ GatMultipktRply::onGatLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer::St
 GatMultipktRply::GatMultipktRply(GatLinkLayer *linkLayer, QObject *parent)
     : QObject(parent)
     , stateId_(StateId::Undefined)
+    , frameRetries_(defaultFrameRetryLimit)
+    , frameSink_(nullptr)
     , dataFormat_(GatDataFormat::Undefined)
     , frameNumber_(0)
     , resultType_(ResultType::Undefined)
@@ -28,6 +28,51 @@
 #include <QTimer>
 
 
+class GatMultipktRply;
+
+
+/*!
+    \brief Consumer of the frames of a multi-packet reply, as each arrives (instead of after the last one).
+
+    Called on the GAT I/O thread, in the order of the frames, exactly once per frame (a retried frame is delivered
+    once, when it finally arrives intact).
+*/
+struct GatFrameSinkInterface
+{
+    //! 'frameData' shares the received packet (no copy); a sink may keep it, or consume it and let it go.
+    virtual void onFrame(GatMultipktRply &host, uint frameNumber, GatByteView const &frameData, bool lastFrame) = 0;
+
+    //! The transfer failed after the frames delivered so far (partial results).
+    virtual void onTransferFailed(GatMultipktRply & /*host*/) {}
+
+    virtual ~GatFrameSinkInterface() {}
+};
+
+
+/*!
+    \brief Retries of the frames of one multi-packet reply: each frame may be requested again, up to a limit.
+*/
+class GatFrameRetries
+{
+public:
+    bool retry(); //!< Counts a retry of the current frame; false (not counted) when its retries are used up.
+    void nextFrame() { frameRetryCount_ = 0; }
+    void reset() { frameRetryCount_ = 0; retryCount_ = 0; }
+
+    void setLimit(uint value) { limit_ = value; } //!< Per frame; 0 disables retries.
+    uint limit() const { return limit_; }
+    uint frameRetryCount() const { return frameRetryCount_; } //!< Of the current frame.
+    uint retryCount() const { return retryCount_; } //!< Of all frames (since 'reset()').
+
+    explicit GatFrameRetries(uint limit) : limit_(limit), frameRetryCount_(0), retryCount_(0) {}
+
+private:
+    uint limit_;
+    uint frameRetryCount_;
+    uint retryCount_;
+};
+
+
 class GatMultipktRply
     : public QObject
 {
@@ -65,15 +110,61 @@ public slots:
 
 protected:
     virtual bool transmitLarq();
-    virtual void onTimeout();
-    virtual void onInvalidResponse();
+    virtual void onTimeout(); //!< Fails the transfer.
+    virtual void onInvalidResponse(); //!< Fails the transfer.
+    //! @}
+
+    //! \name LARQ/LARR (also used by 'gatReadFrames()')
+    //! @{
+public:
+    enum class FrameCheck : size_t
+    {
+        Accept, //!< The frame requested.
+        Retry,  //!< Lost, corrupt, or another frame: request it again (while its retries last).
+        Fail,   //!< The GM reported an error; asking again will not help.
+        Undefined // Must always be last.
+    };
+    static size_t const frameCheck_Count = static_cast<size_t>(FrameCheck::Undefined) + 1;
+
+    static QByteArray larqPayload(GatDataFormat dataFormat, uint frameNumber);
+    static FrameCheck checkFrame(GatLinkLayer::ResultType resultType, GatByteView const &reply, uint frameNumber);
+    //! @}
+
+    //! \name Frame Retry
+    //! @{
+public:
+    static uint const defaultFrameRetryLimit = 3;
+
+    void setFrameRetryLimit(uint value) { frameRetries_.setLimit(value); } //!< Per frame; 0 disables retries.
+    uint frameRetryLimit() const { return frameRetries_.limit(); }
+    uint retryCount() const { return frameRetries_.retryCount(); } //!< Of the transfer (all frames).
+
+protected:
+    virtual bool retryFrame(); //!< Requests the current frame again; false when its retries are exhausted.
+
+private:
+    GatFrameRetries frameRetries_;
+    //! @}
+
+    //! \name Frame Sink
+    //! @{
+public:
+    //! While set, frames are delivered to 'sink' and not accumulated ('reply()' stays empty).
+    void setFrameSink(GatFrameSinkInterface *sink) { frameSink_ = sink; }
+    GatFrameSinkInterface * frameSink() const { return frameSink_; }
+
+private:
+    void deliverFrame(uint frameNumber, GatByteView const &frameData, bool lastFrame);
+    void failFrameSink();
+
+    GatFrameSinkInterface *frameSink_;
     //! @}
 
     //! \name Results
     //! @{
 public:
-    typedef ::std::pair<void const *, uint> reply_type; // Data pointer + number of bytes addressed.
-    reply_type reply() { return reply_type(&results_[0], results_.size()); }
+    typedef GatByteChain reply_type;
+    reply_type const & reply() const { return results_; } //!< Frame data of the reply (views of the link layer's reply packets; no copies).
 
     enum class ResultType : size_t {
         Reply,
@@ -96,8 +187,7 @@ protected:
 private:
     GatDataFormat dataFormat_;
     uint frameNumber_;
-    typedef std::vector<uint8_t> results_type;
-    results_type results_;
+    GatByteChain results_;
     ResultType resultType_;
     //! @}
 
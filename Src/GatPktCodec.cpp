@@ -0,0 +1,52 @@
+/*!
+    \file "GatPktCodec.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    GAT packet layouts (compile-time descriptions), their encoders, and typed (zero-allocation) reply views.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatPktCodec.hpp"
+#include <string.h>
+
+
+size_t
+GatPktFrameCodec::encode(uint8_t *packet, uint8_t command, void const *payload, size_t payloadSize)
+{
+    Q_ASSERT(GAT_MAX_PYLD_SIZE >= payloadSize);
+    size_t const packetSize = payloadSize + overhead;
+    Command::encode(packet, command);
+    Length::encode(packet, static_cast<uint32_t>(packetSize));
+    if (nullptr != payload && 0 < payloadSize && packet + payloadOffset != payload)
+    {
+        memmove(packet + payloadOffset, payload, payloadSize);
+    }
+    size_t const crcOffset = payloadOffset + payloadSize;
+    GatPktBigEndian<2>::write(packet + crcOffset, calcGatCrc16(packet, crcOffset));
+    return packetSize;
+}
+
+
+bool
+GatPktFrameCodec::crcIsValid(uint8_t const *packet, size_t packetSize)
+{
+    if (overhead > packetSize) { return false; }
+    size_t const crcOffset = packetSize - 2;
+    return GatPktBigEndian<2>::read(packet + crcOffset) == calcGatCrc16(packet, crcOffset);
+}
+
+
+/*
+    End of "GatPktCodec.cpp"
+*/
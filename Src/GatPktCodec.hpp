@@ -0,0 +1,249 @@
+/*!
+    \file "GatPktCodec.hpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    GAT packet layouts (compile-time descriptions), their encoders, and typed (zero-allocation) reply views.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#ifndef GATPKTCODEC_HPP__F4AB5142_7324_4567_A429_4E9CE8DE4168__INCLUDED
+#define GATPKTCODEC_HPP__F4AB5142_7324_4567_A429_4E9CE8DE4168__INCLUDED
+
+
+#pragma once
+
+
+#include "Defs.hpp"
+
+
+//! \name Field Descriptions
+//! @{
+
+//! Big endian (network order) unsigned integer of 'tSize' bytes; unrolled at compile time.
+template <size_t tSize> struct GatPktBigEndian
+{
+    static uint32_t read(uint8_t const *bytes)
+    {
+        return (GatPktBigEndian<tSize - 1>::read(bytes) << 8) | static_cast<uint32_t>(bytes[tSize - 1]);
+    }
+    static void write(uint8_t *bytes, uint32_t value)
+    {
+        GatPktBigEndian<tSize - 1>::write(bytes, value >> 8);
+        bytes[tSize - 1] = static_cast<uint8_t>(value & 0xff);
+    }
+};
+
+template <> struct GatPktBigEndian<1>
+{
+    static uint32_t read(uint8_t const *bytes) { return static_cast<uint32_t>(bytes[0]); }
+    static void write(uint8_t *bytes, uint32_t value) { bytes[0] = static_cast<uint8_t>(value & 0xff); }
+};
+
+
+//! Unsigned integer field of 'tSize' bytes at byte 'tOffset' of a packet.
+template <size_t tOffset, size_t tSize> struct GatPktField
+{
+    static_assert(0 < tSize && sizeof(uint32_t) >= tSize, "GAT packet fields are 1 to 4 bytes.");
+
+    static size_t const offset = tOffset;
+    static size_t const end = tOffset + tSize; //!< One past the field.
+
+    static uint32_t decode(uint8_t const *packet) { return GatPktBigEndian<tSize>::read(packet + tOffset); }
+    static void encode(uint8_t *packet, uint32_t value) { GatPktBigEndian<tSize>::write(packet + tOffset, value); }
+};
+
+
+//! Field of 'tWidth' bits, 'tShift' bits from the least significant bit of byte 'tOffset' of a packet.
+template <size_t tOffset, uint tShift, uint tWidth> struct GatPktBits
+{
+    static_assert(8 >= tShift + tWidth && 0 < tWidth, "GAT packet bit fields are within one byte.");
+
+    static size_t const offset = tOffset;
+    static size_t const end = tOffset + 1; //!< One past the field.
+    static uint const mask = (1u << tWidth) - 1;
+
+    static uint decode(uint8_t const *packet) { return (packet[tOffset] >> tShift) & mask; }
+    static void encode(uint8_t *packet, uint value)
+    {
+        packet[tOffset] = static_cast<uint8_t>((packet[tOffset] & ~(mask << tShift)) | ((value & mask) << tShift));
+    }
+};
+//! @}
+
+
+//! \name Framing
+//! @{
+
+/*!
+    \brief Framing common to every GAT packet: command, length (of the whole packet), payload, CRC (big endian).
+*/
+struct GatPktFrameCodec
+{
+    typedef GatPktField<0, 1> Command;
+    typedef GatPktField<1, 1> Length;
+    static size_t const payloadOffset = Length::end;
+    static size_t const overhead = 4; // command + length + CRC
+
+    //! Frames 'payload' (which may already be in place at 'packet + payloadOffset'); returns the packet size.
+    static size_t encode(uint8_t *packet, uint8_t command, void const *payload, size_t payloadSize);
+    static bool crcIsValid(uint8_t const *packet, size_t packetSize);
+};
+
+
+/*!
+    \brief Description of one packet type: its command and payload size (range).
+
+    A packet of this type is 'isValid()' when its command, length byte, and actual size agree with the
+    description.  The CRC is not checked again (the link layer only delivers packets whose CRC is valid).
+*/
+template <uint tCommand, size_t tMinPayloadSize, size_t tMaxPayloadSize = tMinPayloadSize> struct GatPktDesc
+    : public GatPktFrameCodec
+{
+    static_assert(tMinPayloadSize <= tMaxPayloadSize && GAT_MAX_PYLD_SIZE >= tMaxPayloadSize,
+                  "Payload size is out of range.");
+
+    static uint8_t const command = static_cast<uint8_t>(tCommand);
+    static size_t const minSize = tMinPayloadSize + overhead;
+    static size_t const maxSize = tMaxPayloadSize + overhead;
+
+    static bool isValid(uint8_t const *packet, size_t packetSize)
+    {
+        return nullptr != packet && minSize <= packetSize && maxSize >= packetSize &&
+               command == packet[0] && packetSize == packet[1];
+    }
+};
+//! @}
+
+
+//! \name Packet Descriptions
+//! @{
+
+//! SQ (0x01): status query.
+struct GatPktDesc_SQ : public GatPktDesc<GatRqstCmd::SQ, 0> {};
+
+//! SR (0x81): status query result.
+struct GatPktDesc_SR : public GatPktDesc<GatRqstCmd::SQ | 0x80, 4>
+{
+    typedef GatPktField<2, 2> VersionInBcd;
+    typedef GatPktBits<4, 0, 1> CalculationInProgress;
+    typedef GatPktBits<4, 1, 1> AuthResultsReady;
+    typedef GatPktBits<4, 2, 2> CalculationStatus;
+    typedef GatPktField<5, 1> DataFormats; // Bitmask of data format codes.
+};
+
+//! LASQ (0x02): last authentication status query.
+struct GatPktDesc_LASQ : public GatPktDesc<GatRqstCmd::LASQ, 0> {};
+
+//! LASR (0x82): last authentication status result.
+struct GatPktDesc_LASR : public GatPktDesc<GatRqstCmd::LASQ | 0x80, 5>
+{
+    typedef GatPktField<2, 1> AuthLevel;
+    typedef GatPktField<3, 4> SecondsSinceLastCalculation;
+};
+
+//! LARQ (0x03): last authentication results query (one frame).
+struct GatPktDesc_LARQ : public GatPktDesc<GatRqstCmd::LARQ, 3>
+{
+    typedef GatPktField<2, 1> DataFormat; // Data format code.
+    typedef GatPktField<3, 2> FrameNumber;
+};
+
+//! LARR (0x83): last authentication results (one frame).
+struct GatPktDesc_LARR : public GatPktDesc<GatRqstCmd::LARQ | 0x80, 3, GAT_MAX_PYLD_SIZE>
+{
+    typedef GatPktBits<2, 0, 1> GatError;
+    typedef GatPktBits<2, 1, 1> LastFrame;
+    typedef GatPktField<3, 2> FrameNumber;
+    static size_t const dataOffset = FrameNumber::end;
+};
+
+//! IACQ (0x04): initiate authentication calculation (special function text).
+struct GatPktDesc_IACQ : public GatPktDesc<GatRqstCmd::IACQ, 0, GAT_MAX_PYLD_SIZE> {};
+
+//! IACR (0x84): initiate authentication calculation acknowledgement.
+struct GatPktDesc_IACR : public GatPktDesc<GatRqstCmd::IACQ | 0x80, 0, GAT_MAX_PYLD_SIZE> {};
+//! @}
+
+
+//! \name Reply Views
+//! @{
+
+/*!
+    \brief Typed view of a received packet (no copy; the packet must outlive the view).
+*/
+template <typename tDesc> class GatPktView
+{
+public:
+    typedef tDesc desc_type;
+
+    bool isValid() const { return tDesc::isValid(packet_, size_); }
+    uint8_t const * packet() const { return packet_; }
+    size_t size() const { return size_; }
+    uint8_t const * payload() const { return packet_ + tDesc::payloadOffset; }
+    size_t payloadSize() const { return size_ - tDesc::overhead; } //!< When valid.
+
+    GatPktView(void const *packet, size_t packetSize)
+        : packet_(static_cast<uint8_t const *>(packet))
+        , size_(packetSize)
+    {
+        // Do nothing.
+    }
+
+protected:
+    uint8_t const *packet_;
+    size_t size_;
+};
+
+
+class GatPktView_LASR
+    : public GatPktView<GatPktDesc_LASR>
+{
+public:
+    uint authLevel() const { return desc_type::AuthLevel::decode(packet_); }
+    uint32_t secondsSinceLastCalculation() const { return desc_type::SecondsSinceLastCalculation::decode(packet_); }
+
+    GatPktView_LASR(void const *packet, size_t packetSize) : GatPktView(packet, packetSize) {}
+};
+
+
+class GatPktView_LARR
+    : public GatPktView<GatPktDesc_LARR>
+{
+public:
+    bool gatError() const { return 0 != desc_type::GatError::decode(packet_); }
+    bool lastFrame() const { return 0 != desc_type::LastFrame::decode(packet_); }
+    uint frameNumber() const { return desc_type::FrameNumber::decode(packet_); }
+    uint dataOffset() const { return desc_type::dataOffset; } //!< Of the frame data in the packet.
+    uint8_t const * data() const { return packet_ + desc_type::dataOffset; } //!< Frame data.
+    uint dataSize() const { return static_cast<uint>(size_ - desc_type::minSize); } //!< When valid.
+
+    GatPktView_LARR(void const *packet, size_t packetSize) : GatPktView(packet, packetSize) {}
+};
+
+
+class GatPktView_IACR
+    : public GatPktView<GatPktDesc_IACR>
+{
+public:
+    GatPktView_IACR(void const *packet, size_t packetSize) : GatPktView(packet, packetSize) {}
+};
+//! @}
+
+
+#endif // #ifndef GATPKTCODEC_HPP__F4AB5142_7324_4567_A429_4E9CE8DE4168__INCLUDED
+
+
+/*
+    End of "GatPktCodec.hpp"
+*/
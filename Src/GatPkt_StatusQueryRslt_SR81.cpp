@@ -17,25 +17,22 @@
 
 #include "Defs.hpp"
 #include "GatPkt_StatusQueryRslt_SR81.hpp"
+#include "GatPktCodec.hpp"
 
 
 bool
 GatPkt_StatusQueryRslt_SR81::parseResultPacket(uint8_t const *replyBytes, size_t const replySize)
 {
-    if (8 <= replySize &&
-        (gatRqstToCode(GatRqst::SQ_01) | 0x80) == replyBytes[0] &&
-        8 == replyBytes[1])
+    if (GatPktDesc_SR::isValid(replyBytes, replySize))
     {
-        uint const versionInBcd = (static_cast<uint16_t>(replyBytes[2]) << 8) | static_cast<uint16_t>(replyBytes[3]);
+        uint const versionInBcd = GatPktDesc_SR::VersionInBcd::decode(replyBytes);
         if (0x350 <= versionInBcd)
         {
             versionInBcd_ = versionInBcd;
-            calculationInPgrs_ = 0x1 == (replyBytes[4] & 0x1);
-            authResultsReady_ = 0x2 == (replyBytes[4] & 0x2);
-            calculationStatus_ = static_cast<CalculationStatus>((replyBytes[4] >> 2) & 0x3);
-            dataFormats_.clear();
-            if (0x01 == (replyBytes[5] & 0x01)) { dataFormats_.push_back(GatDataFormat::PlainText); }
-            if (0x02 == (replyBytes[5] & 0x02)) { dataFormats_.push_back(GatDataFormat::Xml); }
+            calculationInPgrs_ = 0 != GatPktDesc_SR::CalculationInProgress::decode(replyBytes);
+            authResultsReady_ = 0 != GatPktDesc_SR::AuthResultsReady::decode(replyBytes);
+            calculationStatus_ = static_cast<CalculationStatus>(GatPktDesc_SR::CalculationStatus::decode(replyBytes));
+            dataFormats_ = GatPktDesc_SR::DataFormats::decode(replyBytes);
 
             return true;
         }
@@ -50,6 +47,7 @@ GatPkt_StatusQueryRslt_SR81::GatPkt_StatusQueryRslt_SR81()
     , authResultsReady_(false)
     , calculationStatus_(CalculationStatus::Requested)
     , versionInBcd_(0)
+    , dataFormats_(0)
 {
     // Do nothing.
 }
@@ -34,13 +34,14 @@ public:
     };
     size_t const calculationStatus_Count = static_cast<size_t>(CalculationStatus::Error) + 1;
 
-    typedef std::vector<GatDataFormat> data_formats_type;
+    typedef uint data_formats_type; // Bitmask of data format codes (see 'gatDataFormatIdToCode()').
 
     bool calculationInProgress() const { return calculationInPgrs_; }
     bool authResultsReady() const { return authResultsReady_; }
     CalculationStatus calculationStatus() const { return calculationStatus_; }
     uint versionInBcd() const { return versionInBcd_; }
-    data_formats_type const& dataFormats() const { return dataFormats_; }
+    data_formats_type dataFormats() const { return dataFormats_; }
+    bool hasDataFormat(GatDataFormat value) const { return 0 != (dataFormats_ & gatDataFormatIdToCode(value)); }
 
     bool parseResultPacket(uint8_t const *replyBytes, size_t const replySize);
 
@@ -0,0 +1,121 @@
+/*!
+    \file "GatReplyTimingModel.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Reply timing statistics of one GM (smoothed latency and deviation per request command).
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatReplyTimingModel.hpp"
+
+
+const uint calibrationSampleCount = 8; // Samples of a command before its timeout is derived from them.
+const uint maximumBackoffShift = 5; // Consecutive timeouts that double a command's timeout (32 times at most).
+
+
+void
+GatReplyTimingModel::Estimator::add(qint64 sample)
+{
+    if (0 == sampleCount_++)
+    {
+        mean_ = sample;
+        deviation_ = sample / 2;
+        return;
+    }
+
+    qint64 const error = sample - mean_;
+    mean_ += error / 8;
+    deviation_ += ((0 > error ? -error : error) - deviation_) / 4;
+}
+
+
+qint64
+GatReplyTimingModel::Estimator::bound() const
+{
+    return mean_ + 4 * deviation_;
+}
+
+
+void
+GatReplyTimingModel::addReply(uint8_t requestCmd, qint64 firstByteLatencyInMicroseconds,
+                              qint64 packetDurationInMicroseconds)
+{
+    CmdTiming &timing = cmdTimings_[cmdIndex(requestCmd)];
+    timing.firstByteLatency_.add((std::max)(firstByteLatencyInMicroseconds, static_cast<qint64>(0)));
+    timing.packetDuration_.add((std::max)(packetDurationInMicroseconds, static_cast<qint64>(0)));
+    timing.consecutiveTimeouts_ = 0;
+    consecutiveTimeouts_ = 0;
+}
+
+
+void
+GatReplyTimingModel::addTimeout(uint8_t requestCmd)
+{
+    CmdTiming &timing = cmdTimings_[cmdIndex(requestCmd)];
+    timing.consecutiveTimeouts_ = (std::min)(timing.consecutiveTimeouts_ + 1, maximumBackoffShift);
+    ++consecutiveTimeouts_;
+}
+
+
+void
+GatReplyTimingModel::reset()
+{
+    memset(cmdTimings_, 0, sizeof(cmdTimings_));
+    consecutiveTimeouts_ = 0;
+}
+
+
+bool
+GatReplyTimingModel::isCalibrated(uint8_t requestCmd) const
+{
+    return calibrationSampleCount <= cmdTimings_[cmdIndex(requestCmd)].firstByteLatency_.sampleCount_;
+}
+
+
+qint64
+GatReplyTimingModel::firstByteTimeoutInMicroseconds(uint8_t requestCmd, qint64 floor, qint64 limit) const
+{
+    if (!isCalibrated(requestCmd)) { return limit; }
+
+    CmdTiming const &timing = cmdTimings_[cmdIndex(requestCmd)];
+    qint64 const timeout = (std::max)(timing.firstByteLatency_.bound(), floor) << timing.consecutiveTimeouts_;
+    return (std::min)(timeout, limit);
+}
+
+
+qint64
+GatReplyTimingModel::meanFirstByteLatencyInMicroseconds(uint8_t requestCmd) const
+{
+    Estimator const &estimator = cmdTimings_[cmdIndex(requestCmd)].firstByteLatency_;
+    return 0 == estimator.sampleCount_ ? -1 : estimator.mean_;
+}
+
+
+qint64
+GatReplyTimingModel::meanPacketDurationInMicroseconds(uint8_t requestCmd) const
+{
+    Estimator const &estimator = cmdTimings_[cmdIndex(requestCmd)].packetDuration_;
+    return 0 == estimator.sampleCount_ ? -1 : estimator.mean_;
+}
+
+
+GatReplyTimingModel::GatReplyTimingModel()
+{
+    reset();
+}
+
+
+/*
+    End of "GatReplyTimingModel.cpp"
+*/
@@ -0,0 +1,87 @@
+/*!
+    \file "GatReplyTimingModel.hpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Reply timing statistics of one GM (smoothed latency and deviation per request command).
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#ifndef GATREPLYTIMINGMODEL_HPP__95F0B2F6_8DDF_4960_8784_BF58AFF3B12E__INCLUDED
+#define GATREPLYTIMINGMODEL_HPP__95F0B2F6_8DDF_4960_8784_BF58AFF3B12E__INCLUDED
+
+
+#pragma once
+
+
+#include "Defs.hpp"
+
+
+/*!
+    \brief Reply timing statistics of one GM (smoothed latency and deviation per request command).
+
+    For each request command the latency until the first byte of the reply and the duration of the reply packet are
+    tracked as an exponentially weighted moving average and mean deviation (the estimator TCP uses for its
+    retransmission timeout: gain 1/8 for the average, 1/4 for the deviation).  Once a command has enough samples, its
+    first byte timeout is the average plus four deviations, never less than the given floor nor more than the given
+    limit (the GAT deadline).  Each consecutive timeout of a command doubles its timeout (up to the limit) until it
+    is answered again, so a GM that is merely slow is not given up on after one tight deadline.
+*/
+class GatReplyTimingModel
+{
+public:
+    //! Valid reply to 'requestCmd'.  Microseconds from the last byte of the request, and from the first byte.
+    void addReply(uint8_t requestCmd, qint64 firstByteLatencyInMicroseconds, qint64 packetDurationInMicroseconds);
+    void addTimeout(uint8_t requestCmd); //!< No reply to 'requestCmd'.
+    void reset();
+
+    bool isCalibrated(uint8_t requestCmd) const; //!< Has enough samples.
+    qint64 firstByteTimeoutInMicroseconds(uint8_t requestCmd, qint64 floor, qint64 limit) const;
+
+    qint64 meanFirstByteLatencyInMicroseconds(uint8_t requestCmd) const; //!< -1 when no sample.
+    qint64 meanPacketDurationInMicroseconds(uint8_t requestCmd) const; //!< -1 when no sample.
+    uint consecutiveTimeouts() const { return consecutiveTimeouts_; } //!< Of any command (GM unresponsive).
+
+    GatReplyTimingModel();
+
+private:
+    struct Estimator
+    {
+        qint64 mean_; // Microseconds.
+        qint64 deviation_; // Mean deviation (microseconds).
+        uint sampleCount_;
+
+        void add(qint64 sample);
+        qint64 bound() const; //!< Mean plus four deviations.
+    };
+
+    struct CmdTiming
+    {
+        Estimator firstByteLatency_;
+        Estimator packetDuration_;
+        uint consecutiveTimeouts_;
+    };
+
+    static size_t cmdIndex(uint8_t requestCmd) { return requestCmd & 0x7F; } // Request commands are < 0x80.
+
+    CmdTiming cmdTimings_[0x80];
+    uint consecutiveTimeouts_;
+};
+
+
+#endif // #ifndef GATREPLYTIMINGMODEL_HPP__95F0B2F6_8DDF_4960_8784_BF58AFF3B12E__INCLUDED
+
+
+/*
+    End of "GatReplyTimingModel.hpp"
+*/
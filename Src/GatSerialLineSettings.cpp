@@ -0,0 +1,83 @@
+/*!
+    \file "GatSerialLineSettings.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Serial line settings (baud rate, character framing, flow control) of one port.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatSerialLineSettings.hpp"
+
+
+bool
+GatSerialLineSettings::isValid() const
+{
+    return 0 < baudRate_ &&
+           5 <= dataBits_ && 8 >= dataBits_ &&
+           Parity::Undefined != parity_ &&
+           (1 == stopBits_ || 2 == stopBits_) &&
+           FlowControl::Undefined != flowControl_;
+}
+
+
+uint
+GatSerialLineSettings::bitsPerCharacter() const
+{
+    return 1/* start */ + dataBits_ + (Parity::None == parity_ ? 0 : 1) + stopBits_;
+}
+
+
+uint
+GatSerialLineSettings::microsecondsPerCharacter() const
+{
+    if (0 == baudRate_) { return 0; }
+
+    return (bitsPerCharacter() * 1000000u + baudRate_ - 1) / baudRate_;
+}
+
+
+uint
+GatSerialLineSettings::millisecondsToTransmit(uint characterCount) const
+{
+    return (characterCount * microsecondsPerCharacter() + 999u) / 1000u;
+}
+
+
+auto
+GatSerialLineSettings::standardBaudRates() -> baud_rates_type const &
+{
+    static uint const rates[] = { 921600, 460800, 230400, 115200, 57600, 38400, 19200, 9600, 4800, 2400, 1200 };
+    static baud_rates_type const result(rates, rates + arycap(rates));
+    return result;
+}
+
+
+GatSerialLineSettings::GatSerialLineSettings()
+    : baudRate_(9600)
+    , dataBits_(8)
+    , parity_(Parity::None)
+    , stopBits_(1)
+    , flowControl_(FlowControl::None)
+    , autoBaud_(false)
+    , autoBaudRates_(standardBaudRates())
+    , lowLatency_(false)
+    , adaptiveReplyTimeout_(true)
+{
+    // Do nothing.
+}
+
+
+/*
+    End of "GatSerialLineSettings.cpp"
+*/
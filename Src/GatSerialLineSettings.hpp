@@ -0,0 +1,89 @@
+/*!
+    \file "GatSerialLineSettings.hpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Serial line settings (baud rate, character framing, flow control) of one port.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#ifndef GATSERIALLINESETTINGS_HPP__9E1A0D44_FE9B_42E5_BEA0_4D46CCFD1067__INCLUDED
+#define GATSERIALLINESETTINGS_HPP__9E1A0D44_FE9B_42E5_BEA0_4D46CCFD1067__INCLUDED
+
+
+#pragma once
+
+
+#include "Defs.hpp"
+#include <vector>
+
+
+/*!
+    \brief Serial line settings (baud rate, character framing, flow control) of one port.
+
+    The defaults are the GAT defaults: 9600 baud, 8N1, no flow control.  When 'autoBaud_' is set the port probes
+    'baudRate_' and then each of 'autoBaudRates_' (in order) with a status query (SQ) once it is opened, and keeps
+    the first rate at which the GM returns a valid SR.  When 'lowLatency_' is set the port then switches the device
+    to low latency mode (see 'GatSerialLowLatency') and logs the SQ round-trip time measured before and after.
+    When 'adaptiveReplyTimeout_' is set (the default) the link layer waits for the first byte of a reply only as long
+    as the GM's observed latency supports, never longer than the GAT deadline (see 'GatReplyTimingModel').
+*/
+struct GatSerialLineSettings
+{
+    enum class Parity : size_t
+    {
+        None,
+        Even,
+        Odd,
+        Undefined // Must always be last.
+    };
+    static size_t const parity_Count = static_cast<size_t>(Parity::Undefined) + 1;
+
+    enum class FlowControl : size_t
+    {
+        None,
+        Hardware, //!< RTS/CTS.
+        Software, //!< XON/XOFF.
+        Undefined // Must always be last.
+    };
+    static size_t const flowControl_Count = static_cast<size_t>(FlowControl::Undefined) + 1;
+
+    typedef std::vector<uint> baud_rates_type;
+
+    uint baudRate_;
+    uint dataBits_; //!< 5 - 8.
+    Parity parity_;
+    uint stopBits_; //!< 1 or 2.
+    FlowControl flowControl_;
+    bool autoBaud_;
+    baud_rates_type autoBaudRates_; //!< Rates probed after 'baudRate_' (when 'autoBaud_').
+    bool lowLatency_; //!< Opt-in; changes kernel and adapter settings of the device while it is open.
+    bool adaptiveReplyTimeout_; //!< The GAT deadline until the GM has answered a command enough times.
+
+    bool isValid() const;
+    uint bitsPerCharacter() const; //!< Start bit + data bits + parity bit + stop bits.
+    uint microsecondsPerCharacter() const;
+    uint millisecondsToTransmit(uint characterCount) const; //!< Rounded up.
+
+    static baud_rates_type const & standardBaudRates(); //!< Fastest first.
+
+    GatSerialLineSettings();
+};
+
+
+#endif // #ifndef GATSERIALLINESETTINGS_HPP__9E1A0D44_FE9B_42E5_BEA0_4D46CCFD1067__INCLUDED
+
+
+/*
+    End of "GatSerialLineSettings.hpp"
+*/
@@ -0,0 +1,181 @@
+/*!
+    \file "GatSerialLowLatency.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Low latency mode of a serial device (kernel low latency flag and USB-serial adapter latency timer).
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatSerialLowLatency.hpp"
+#include <QStringList>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+
+
+bool
+GatSerialLowLatency::enable(int fileDescriptor, QString const &serialDevicePathname)
+{
+    restore();
+    if (-1 == fileDescriptor) { return false; }
+    fd_ = fileDescriptor;
+
+    // Kernel low latency flag (also makes ftdi_sio drop its latency timer to 1ms).
+    serial_struct serialInfo;
+    memset(&serialInfo, 0, sizeof(serialInfo));
+    if (0 == ioctl(fd_, TIOCGSERIAL, &serialInfo))
+    {
+        lowLatencyFlag_ = 0 != (serialInfo.flags & ASYNC_LOW_LATENCY);
+        if (!lowLatencyFlag_)
+        {
+            serialInfo.flags |= ASYNC_LOW_LATENCY;
+            lowLatencyFlag_ = lowLatencyFlagSet_ = 0 == ioctl(fd_, TIOCSSERIAL, &serialInfo);
+            if (!lowLatencyFlagSet_) { qWarning() << "TIOCSSERIAL(ASYNC_LOW_LATENCY) failed: " << errnoToStr(errno); }
+        }
+    }
+
+    // USB-serial adapter latency timer: /sys/class/tty/<device>/device/latency_timer.
+    char resolvedPathname[PATH_MAX];
+    std::string const pathname(toStdStr(serialDevicePathname));
+    if (nullptr != realpath(pathname.c_str(), resolvedPathname))
+    {
+        std::string deviceName(resolvedPathname);
+        deviceName.erase(0, deviceName.find_last_of('/') + 1);
+        latencyTimerPathname_ = "/sys/class/tty/" + deviceName + "/device/latency_timer";
+        int latencyTimer = -1;
+        if (readLatencyTimer(latencyTimerPathname_, latencyTimer))
+        {
+            latencyTimer_ = latencyTimer;
+            if (1 < latencyTimer && writeLatencyTimer(latencyTimerPathname_, 1))
+            {
+                originalLatencyTimer_ = latencyTimer;
+                readLatencyTimer(latencyTimerPathname_, latencyTimer_);
+            }
+        }
+        else
+        {
+            latencyTimerPathname_.clear(); // Not a USB-serial adapter with a latency timer.
+        }
+    }
+
+    enabled_ = lowLatencyFlag_ || (0 <= latencyTimer_ && 1 >= latencyTimer_);
+
+    return enabled_;
+}
+
+
+void
+GatSerialLowLatency::restore()
+{
+    if (0 <= originalLatencyTimer_ && !latencyTimerPathname_.empty())
+    {
+        writeLatencyTimer(latencyTimerPathname_, originalLatencyTimer_);
+    }
+
+    if (lowLatencyFlagSet_ && -1 != fd_)
+    {
+        serial_struct serialInfo;
+        memset(&serialInfo, 0, sizeof(serialInfo));
+        if (0 == ioctl(fd_, TIOCGSERIAL, &serialInfo))
+        {
+            serialInfo.flags &= ~ASYNC_LOW_LATENCY;
+            ioctl(fd_, TIOCSSERIAL, &serialInfo);
+        }
+    }
+
+    fd_ = -1;
+    enabled_ = false;
+    lowLatencyFlag_ = false;
+    lowLatencyFlagSet_ = false;
+    latencyTimerPathname_.clear();
+    originalLatencyTimer_ = -1;
+    latencyTimer_ = -1;
+}
+
+
+uint
+GatSerialLowLatency::adapterLatencyInMilliseconds(uint defaultValue) const
+{
+    if (0 <= latencyTimer_) { return static_cast<uint>(latencyTimer_); }
+    return lowLatencyFlag_ ? 1u : defaultValue;
+}
+
+
+QString
+GatSerialLowLatency::description() const
+{
+    QStringList changes;
+    if (lowLatencyFlag_) { changes << (lowLatencyFlagSet_ ? "ASYNC_LOW_LATENCY" : "ASYNC_LOW_LATENCY (already set)"); }
+    if (0 <= originalLatencyTimer_)
+    {
+        changes << QString("latency_timer %1ms -> %2ms").arg(originalLatencyTimer_).arg(latencyTimer_);
+    }
+    else if (0 <= latencyTimer_)
+    {
+        changes << QString("latency_timer %1ms").arg(latencyTimer_);
+    }
+    return changes.isEmpty() ? QString("unchanged") : changes.join(", ");
+}
+
+
+bool
+GatSerialLowLatency::readLatencyTimer(std::string const &pathname, int &value)
+{
+    std::ifstream ifs(pathname.c_str());
+    int latencyTimer = -1;
+    if (!(ifs >> latencyTimer) || 0 > latencyTimer) { return false; }
+    value = latencyTimer;
+    return true;
+}
+
+
+bool
+GatSerialLowLatency::writeLatencyTimer(std::string const &pathname, int value)
+{
+    std::ofstream ofs(pathname.c_str());
+    ofs << value << std::endl;
+    if (!ofs)
+    {
+        qWarning() << "Unable to write " << value << " to \"" << pathname.c_str() << "\" (requires write access).";
+        return false;
+    }
+    return true;
+}
+
+
+GatSerialLowLatency::GatSerialLowLatency()
+    : fd_(-1)
+    , enabled_(false)
+    , lowLatencyFlag_(false)
+    , lowLatencyFlagSet_(false)
+    , originalLatencyTimer_(-1)
+    , latencyTimer_(-1)
+{
+    // Do nothing.
+}
+
+
+GatSerialLowLatency::~GatSerialLowLatency()
+{
+    // Do nothing.  'restore()' needs the device to be open, so its owner must call it before closing the device.
+}
+
+
+/*
+    End of "GatSerialLowLatency.cpp"
+*/
@@ -0,0 +1,73 @@
+/*!
+    \file "GatSerialLowLatency.hpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Low latency mode of a serial device (kernel low latency flag and USB-serial adapter latency timer).
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#ifndef GATSERIALLOWLATENCY_HPP__1403D452_6874_4023_867A_C6749215AE7F__INCLUDED
+#define GATSERIALLOWLATENCY_HPP__1403D452_6874_4023_867A_C6749215AE7F__INCLUDED
+
+
+#pragma once
+
+
+#include "Defs.hpp"
+
+
+/*!
+    \brief Low latency mode of a serial device (kernel low latency flag and USB-serial adapter latency timer).
+
+    FTDI-style USB-serial adapters hold received bytes for up to their latency timer (16ms by default) before
+    delivering them to the host.  Enabling sets ASYNC_LOW_LATENCY on the tty (TIOCSSERIAL) and writes 1 to the
+    adapter's sysfs "latency_timer" (when it has one).  'restore()' puts both back the way they were, and must be
+    called while the device is still open.
+*/
+class GatSerialLowLatency
+{
+public:
+    bool enable(int fileDescriptor, QString const &serialDevicePathname); //!< False when not low latency.
+    void restore();
+
+    bool isEnabled() const { return enabled_; }
+    uint adapterLatencyInMilliseconds(uint defaultValue) const; //!< Once enabled.
+    QString description() const; //!< What was changed (for logs).
+
+    GatSerialLowLatency();
+    ~GatSerialLowLatency();
+
+private:
+    static bool readLatencyTimer(std::string const &pathname, int &value);
+    static bool writeLatencyTimer(std::string const &pathname, int value);
+
+    int fd_;
+    bool enabled_;
+    bool lowLatencyFlag_; // ASYNC_LOW_LATENCY is set.
+    bool lowLatencyFlagSet_; // ASYNC_LOW_LATENCY was set by this.
+    std::string latencyTimerPathname_;
+    int originalLatencyTimer_; // Milliseconds; -1 when not changed by this.
+    int latencyTimer_; // Milliseconds; -1 when unknown.
+
+    GatSerialLowLatency(GatSerialLowLatency const&) = delete; //!< No cloning; leave unimplemented!
+    GatSerialLowLatency& operator=(GatSerialLowLatency const&) = delete; //!< No cloning; leave unimplemented!
+};
+
+
+#endif // #ifndef GATSERIALLOWLATENCY_HPP__1403D452_6874_4023_867A_C6749215AE7F__INCLUDED
+
+
+/*
+    End of "GatSerialLowLatency.hpp"
+*/
@@ -16,6 +16,7 @@
 
 
 #include "GatSpecialFunctionExec.hpp"
+#include "GatCalcDurationModel.hpp"
 #include "GatPkt_StatusQueryRslt_SR81.hpp"
 
 
@@ -23,10 +24,12 @@
 
 
 #ifdef ENABLE_GAT_SPEC_FXN_DEBUG_TIMING
-    const int statusPollPeriodInMilliseconds = 5000;
+    const int initialStatusPollPeriodInMilliseconds = 1000;
+    const int maxStatusPollPeriodInMilliseconds = 5000;
     const int maxStatusPollDurationInMilliseconds = 5u/* min */ * 60u/* sec */ * 1000u/* ms */;
 #else
-    const int statusPollPeriodInMilliseconds = 1000;
+    const int initialStatusPollPeriodInMilliseconds = GatStatusPollPolicy::defaultInitialPeriod;
+    const int maxStatusPollPeriodInMilliseconds = GatStatusPollPolicy::defaultMaxPeriod;
     const int maxStatusPollDurationInMilliseconds = 20u/* min */ * 60u/* sec */ * 1000u/* ms */;
 #endif
 
@@ -58,22 +61,14 @@ GatSpecialFunctionExec::sendRequest(QStringList const &params)
     bool const thisIsBusy = StateId::Ready != state();
     if (thisIsBusy) { return false; }
 
-    // Formulate authentication request.
-    QString authParam;
-    for (QStringList::const_iterator iter = params.begin(); params.end() != iter; ++iter)
-    {
-        if (params.begin() != iter) { authParam += "\t"; }
-        authParam += *iter;
-    }
-    QByteArray asciiAuthParam("\xba");
-    asciiAuthParam.append('\x00');
-    asciiAuthParam.append(authParam.toLatin1());
-
-    // Fail when the authentication request is too large.
-    if (GAT_MAX_PYLD_SIZE < static_cast<size_t>(asciiAuthParam.size())) { return false; }
+    // Formulate authentication request (fail when it is too large).
+    QByteArray const asciiAuthParam(requestPayload(params));
+    if (asciiAuthParam.isEmpty()) { return false; }
 
     clearResults();
 
+    statusPollFunctionKey_ = durationKey(params);
+
     // Send authentication request.
     auto const sendRqstRslt = linkLayer()->sendRequest(GatRqst::IACQ_04, asciiAuthParam.constData(), asciiAuthParam.size());
     if (GatLinkLayer::RequestResult::Success != sendRqstRslt &&
@@ -88,6 +83,49 @@ GatSpecialFunctionExec::sendRequest(QStringList const &params)
 }
 
 
+QByteArray
+GatSpecialFunctionExec::requestPayload(QStringList const &params)
+{
+    QString authParam;
+    for (QStringList::const_iterator iter = params.begin(); params.end() != iter; ++iter)
+    {
+        if (params.begin() != iter) { authParam += "\t"; }
+        authParam += *iter;
+    }
+    QByteArray asciiAuthParam("\xba");
+    asciiAuthParam.append('\x00');
+    asciiAuthParam.append(authParam.toLatin1());
+
+    if (GAT_MAX_PYLD_SIZE < static_cast<size_t>(asciiAuthParam.size())) { return QByteArray(); }
+    return asciiAuthParam;
+}
+
+
+QString
+GatSpecialFunctionExec::durationKey(QStringList const &params)
+{
+    // Calculation durations are remembered per special function and its (first) argument, e.g. component name.
+    return QStringList(params.mid(0, 2)).join("\t");
+}
+
+
+GatStatusPollPolicy
+GatSpecialFunctionExec::defaultStatusPollPolicy()
+{
+    GatStatusPollPolicy policy;
+    policy.setInitialPeriod(initialStatusPollPeriodInMilliseconds);
+    policy.setMaxPeriod(maxStatusPollPeriodInMilliseconds);
+    return policy;
+}
+
+
+uint
+GatSpecialFunctionExec::maxStatusPollDuration()
+{
+    return maxStatusPollDurationInMilliseconds;
+}
+
+
 void
 GatSpecialFunctionExec::onLinkLayerStateChangedDuringRequest(GatLinkLayer::StateId newState)
 {
@@ -141,12 +179,7 @@ GatSpecialFunctionExec::onLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer
             break;
         }
 
-        // When polling for auth results availability:
-        case StateId::WaitingForReply:
-        {
-            onLinkLayerStateChangedWhileWaitingForReply(newState);
-            break;
-        }
+        // (Polls for auth results availability are answered through 'statusQueries()'.)
 
         default: break; // Prevent compiler warning.
     }
@@ -158,6 +191,12 @@ GatSpecialFunctionExec::startPollingForReplyReady()
 {
     // Remember when polling for reply started (to determine when to stop).
     statusPollStartTime_ = monotonicClock32();
+    statusPollHistoryKey_.clear(); // Until the GM reports its GAT version (in the first poll response).
+    statusPollDeadline_ = maxStatusPollDuration_; // Until the history of this calculation is known.
+    statusPollPolicy_.setExpectedDuration(0);
+    statusPollPolicy_.start();
+    cancelStatusPoll();
+    statusPollReplyTime_ = statusPollStartTime_;
 
     setState(StateId::WaitingForReply);
 
@@ -171,58 +210,75 @@ GatSpecialFunctionExec::pollForReplyReady()
     if (StateId::WaitingForReply == state())
     {
         // Stop status polling when max poll time has elapsed.
-        if (monotonicClock32() - statusPollStartTime_ >= maxStatusPollDuration_)
+        if (monotonicClock32() - statusPollStartTime_ >= statusPollDeadline_)
         {
             setState(StateId::ReplyUnavailable_Timeout);
             setState(StateId::Ready);
         }
-        else
+        else if (nullptr == statusQueries_)
         {
-            GatLinkLayer::StateId linkLayerState = linkLayer()->state();
-            bool const statusPollInPgrs = GatLinkLayer::StateId::WaitForNextTxTime == linkLayerState ||
-                                          GatLinkLayer::StateId::Transmit == linkLayerState ||
-                                          GatLinkLayer::StateId::Receive == linkLayerState;
-            if (!statusPollInPgrs)
-            {
-                // Stop poll timer, if it's running.
-                timer_.stop();
+            // Fail.
+            setState(StateId::ReplyFailed);
+            setState(StateId::Ready);
+        }
+        else if (0 == statusPollSubscription_)
+        {
+            // Stop poll timer, if it's running.
+            timer_.stop();
 
-                // Send status query poll (SQ 0x01).
-                auto const sendRqstRslt = linkLayer()->sendRequest(GatRqst::SQ_01, nullptr, 0);
-                if (GatLinkLayer::RequestResult::Success == sendRqstRslt ||
-                    GatLinkLayer::RequestResult::Pending == sendRqstRslt)
-                {
-                    // Start poll timer.
-                    timer_.setInterval(statusPollPeriod_); // Time until timeout.
-                    timer_.setSingleShot(true);
-                    timer_.start();
-                }
-                else
-                {
-                    // Fail.
-                    setState(StateId::ReplyFailed);
-                    setState(StateId::Ready);
-                }
-            }
-            else
-            {
-                // Do nothing.
-                // (Poll currently in progress.
-                //  Send another when response comes back and auth results are not ready yet.
-                //  This happens in 'ProcessReplyReadyPollResponse()'.)
-            }
+            // Send status query poll (SQ 0x01), or share the one (or the reply) of another command on this port.
+            // Never accept a reply older than the last one processed here: that status is already known.
+            using namespace std::placeholders;
+            statusPollSubscription_ =
+                statusQueries_->query(std::bind(&GatSpecialFunctionExec::onStatusPollReply, this, _1, _2),
+                                      monotonicClock32() - statusPollReplyTime_);
+
+            // Start poll timer (unless already answered, by a shared reply; see 'onStatusPollReply()').
+            if (0 != statusPollSubscription_) { startPollTimer(); }
+        }
+        else
+        {
+            // Do nothing.
+            // (Poll currently in progress.
+            //  Send another when response comes back and auth results are not ready yet.
+            //  This happens in 'processReplyReadyPollResponse()'.)
         }
     }
 }
 
 
 void
-GatSpecialFunctionExec::onLinkLayerStateChangedWhileWaitingForReply(GatLinkLayer::StateId newState)
+GatSpecialFunctionExec::startPollTimer()
 {
-    switch (newState)
+    timer_.setInterval(statusPollPolicy_.nextPeriod(monotonicClock32() - statusPollStartTime_)); // Time until poll.
+    timer_.setSingleShot(true);
+    timer_.start();
+}
+
+
+void
+GatSpecialFunctionExec::cancelStatusPoll()
+{
+    if (nullptr != statusQueries_ && 0 != statusPollSubscription_)
+    {
+        statusQueries_->unsubscribe(statusPollSubscription_);
+    }
+    statusPollSubscription_ = 0;
+}
+
+
+void
+GatSpecialFunctionExec::onStatusPollReply(GatLinkLayer::ResultType resultType, GatByteView const &reply)
+{
+    statusPollSubscription_ = 0;
+    if (StateId::WaitingForReply != state()) { return; } // Polling stopped (e.g. timed out) while in flight.
+
+    statusPollReplyTime_ = monotonicClock32();
+
+    switch (resultType)
     {
         // Request failed.
-        case GatLinkLayer::StateId::Timeout:
+        case GatLinkLayer::ResultType::Timeout:
         {
             // Stop poll timer, if it's running.
             timer_.stop();
@@ -234,49 +290,52 @@ GatSpecialFunctionExec::onLinkLayerStateChangedWhileWaitingForReply(GatLinkLayer
         }
 
         // Request complete.
-        case GatLinkLayer::StateId::Reply:
+        case GatLinkLayer::ResultType::Reply:
         {
-            // If request succeeded:
-            if (GatLinkLayer::ResultType::Reply == linkLayer()->resultType())
-            {
-                // Start polling for completion status.
-                processReplyReadyPollResponse();
-            }
-            else // Received invalid response, timeout, ...
-            {
-                // Stop poll timer, if it's running.
-                timer_.stop();
+            processReplyReadyPollResponse(reply);
+            break;
+        }
 
-                setState(StateId::ReplyFailed);
-                setState(StateId::Ready);
-            }
+        default: // Received invalid response, could not send, ...
+        {
+            // Stop poll timer, if it's running.
+            timer_.stop();
+
+            setState(StateId::ReplyFailed);
+            setState(StateId::Ready);
 
             break;
         }
-
-        default: break; // Prevent compiler warning.
     }
 }
 
 
 void
-GatSpecialFunctionExec::processReplyReadyPollResponse()
+GatSpecialFunctionExec::processReplyReadyPollResponse(GatByteView const &reply)
 {
     bool failed = true;
 
-    GatLinkLayer::ResultType const resultType = linkLayer()->resultType();
-    if (GatLinkLayer::ResultType::Reply == resultType)
+    if (!reply.isEmpty())
     {
-        GatLinkLayer::reply_type reply(linkLayer()->reply());
-        uint8_t const *replyBytes = reinterpret_cast<uint8_t const *>(reply.first);
-        uint const replySize = reply.second;
         GatPkt_StatusQueryRslt_SR81 statusQueryResult;
-        if (statusQueryResult.parseResultPacket(replyBytes, replySize))
+        if (statusQueryResult.parseResultPacket(reply.data(), reply.size()))
         {
             bool const calculationInPgrs = statusQueryResult.calculationInProgress();
             bool const authResultsReady = statusQueryResult.authResultsReady();
             GatPkt_StatusQueryRslt_SR81::CalculationStatus const calculationStatus = statusQueryResult.calculationStatus();
 
+            // Aim the polls at the typical (median) end of such calculations on GMs of this GAT version, and give
+            // up once well past the slowest of them (instead of after the fixed maximum).
+            if (statusPollHistoryKey_.isEmpty())
+            {
+                GatCalcDurationModel const &durations = GatCalcDurationModel::instance();
+                statusPollHistoryKey_ = GatCalcDurationModel::key(statusQueryResult.versionInBcd(),
+                                                                  statusPollFunctionKey_);
+                statusPollPolicy_.setExpectedDuration(durations.percentile(statusPollHistoryKey_, 50));
+                uint const deadline = durations.deadline(statusPollHistoryKey_);
+                if (0 < deadline) { statusPollDeadline_ = deadline; }
+            }
+
             // If calculating (pending or in progress):
             if (calculationInPgrs ||
                 GatPkt_StatusQueryRslt_SR81::CalculationStatus::Calculating == calculationStatus ||
@@ -289,11 +348,14 @@ GatSpecialFunctionExec::processReplyReadyPollResponse()
                 if (!timer_.isActive())
                 {
                     // Start poll timer.
-                    timer_.setInterval(statusPollPeriod_); // Time until timeout.
-                    timer_.setSingleShot(true);
-                    timer_.start();
+                    startPollTimer();
                 }
                 Q_ASSERT(timer_.isActive());
+                if (0 < receivers(SIGNAL(calculationProgress(GatSpecialFunctionExec *, uint, uint))))
+                {
+                    emit calculationProgress(this, monotonicClock32() - statusPollStartTime_,
+                                             statusPollPolicy_.expectedDuration());
+                }
                 // Note: The timer will cause the next status query poll to be sent.
                 failed = false;
             }
@@ -301,6 +363,9 @@ GatSpecialFunctionExec::processReplyReadyPollResponse()
             else if (authResultsReady &&
                      GatPkt_StatusQueryRslt_SR81::CalculationStatus::Finished == calculationStatus)
             {
+                GatCalcDurationModel::instance().addDuration(statusPollHistoryKey_,
+                                                             monotonicClock32() - statusPollStartTime_);
+
                 // Calculation complete; begin receiving result(s).
                 if (gatMultipktReply_.sendRequest(GatDataFormat::Xml))
                 {
@@ -368,10 +433,7 @@ GatSpecialFunctionExec::onMultipktRplyStateChangedWhileReceivingReply(GatMultipk
                 if (GatMultipktRply::ResultType::Reply == resultType)
                 {
                     // Record results.
-                    GatMultipktRply::reply_type reply(gatMultipktReply_.reply());
-                    uint8_t const *rplyBytes = reinterpret_cast<uint8_t const *>(reply.first);
-                    uint const replySize = reply.second;
-                    std::copy(rplyBytes, rplyBytes + replySize, std::back_inserter(results_));
+                    results_.append(gatMultipktReply_.reply());
 
                     // Move to next state.
                     setState(StateId::ReplyReady);
@@ -448,18 +510,33 @@ GatSpecialFunctionExec::setLinkLayer(GatLinkLayer *value)
 }
 
 
+void
+GatSpecialFunctionExec::setStatusQueries(GatStatusQueryCoalescer *value)
+{
+    if (statusQueries_ != value)
+    {
+        cancelStatusPoll();
+        statusQueries_ = value;
+    }
+}
+
+
 GatSpecialFunctionExec::GatSpecialFunctionExec(GatLinkLayer *linkLayer, QObject *parent)
     : QObject(parent)
     , currentState_(StateId::Undefined)
-    , statusPollPeriod_(statusPollPeriodInMilliseconds)
     , maxStatusPollDuration_(maxStatusPollDurationInMilliseconds)
     , statusPollStartTime_(0)
+    , statusPollDeadline_(maxStatusPollDurationInMilliseconds)
+    , statusPollSubscription_(0)
+    , statusPollReplyTime_(0)
     , gatDataFormat_(GatDataFormat::Undefined)
     , resultTypeId_(ResultTypeId::Undefined)
     , linkLayer_(nullptr)
+    , statusQueries_(nullptr)
 {
     gatMultipktReply_.setParent(this);
     timer_.setParent(this);
+    statusPollPolicy_ = defaultStatusPollPolicy();
     setLinkLayer(linkLayer);
     connect(&timer_, SIGNAL(timeout()), this, SLOT(onTimer()));
     connect(&gatMultipktReply_, SIGNAL(stateChanged(GatMultipktRply *, GatMultipktRply::StateId)),
@@ -472,6 +549,7 @@ GatSpecialFunctionExec::~GatSpecialFunctionExec()
     disconnect(&gatMultipktReply_, SIGNAL(stateChanged(GatMultipktRply *, GatMultipktRply::StateId)),
                this, SLOT(onMultipktRplyStateChanged(GatMultipktRply *, GatMultipktRply::StateId)));
     disconnect(&timer_, SIGNAL(timeout()), this, SLOT(onTimer()));
+    cancelStatusPoll(); // Its reply would otherwise be delivered to this (destroyed) object.
     setLinkLayer(nullptr);
 }
 
@@ -24,6 +24,8 @@
 
 #include "Defs.hpp"
 #include "GatMultipktRply.hpp"
+#include "GatStatusPollPolicy.hpp"
+#include "GatStatusQueryCoalescer.hpp"
 #include <QTimer>
 
 
@@ -64,6 +66,8 @@ public:
 
 signals:
     void specialFunctionExecStateChanged(GatSpecialFunctionExec *host, GatSpecialFunctionExec::StateId newState);
+    //! While the GM calculates; 'expected' is the median duration of such calculations (0 when unknown).
+    void calculationProgress(GatSpecialFunctionExec *host, uint elapsedInMilliseconds, uint expectedInMilliseconds);
 
 protected:
     StateId setState(StateId value);
@@ -77,6 +81,15 @@ private:
 public slots:
     bool sendRequest(QStringList const &params);
 
+public:
+    GatStatusPollPolicy& statusPollPolicy() { return statusPollPolicy_; } //!< Configure before 'sendRequest()'.
+
+    // Also used by 'gatSpecialFunction()'.
+    static QByteArray requestPayload(QStringList const &params); //!< IACQ payload; empty when too large.
+    static QString durationKey(QStringList const &params); //!< Of the calculation (see 'GatCalcDurationModel').
+    static GatStatusPollPolicy defaultStatusPollPolicy();
+    static uint maxStatusPollDuration(); //!< Milliseconds; when the calculation has no history.
+
 protected slots:
     virtual void onLinkLayerStateChanged(GatLinkLayer *host, GatLinkLayer::StateId newState);
     virtual void onMultipktRplyStateChanged(GatMultipktRply *host, GatMultipktRply::StateId newState);
@@ -84,27 +97,38 @@ protected slots:
 
 protected:
     virtual void onLinkLayerStateChangedDuringRequest(GatLinkLayer::StateId newState);
-    virtual void onLinkLayerStateChangedWhileWaitingForReply(GatLinkLayer::StateId newState);
     virtual void onMultipktRplyStateChangedWhileReceivingReply(GatMultipktRply::StateId newState);
 
 private:
     void startPollingForReplyReady();
     void pollForReplyReady();
-    void processReplyReadyPollResponse();
+    void onStatusPollReply(GatLinkLayer::ResultType resultType, GatByteView const &reply);
+    void processReplyReadyPollResponse(GatByteView const &reply);
+    void startPollTimer();
+    void cancelStatusPoll(); //!< The poll in flight (if any) is no longer of interest.
 
 private:
     GatMultipktRply gatMultipktReply_;
     QTimer timer_;
-    uint statusPollPeriod_;        // Milliseconds between status polls (1/frequency).
-    uint maxStatusPollDuration_;   // Milliseconds; maximum duration to perform status polling.
+    GatStatusPollPolicy statusPollPolicy_;
+    QString statusPollFunctionKey_; // Special function (and argument) being calculated.
+    QString statusPollHistoryKey_; // GAT version and 'statusPollFunctionKey_'; empty until the first poll response.
+    uint maxStatusPollDuration_;   // Milliseconds; maximum duration to perform status polling (without history).
     uint32_t statusPollStartTime_; // GetMonotonicClock32() when polling starts.
+    uint statusPollDeadline_;      // Milliseconds; from history ('GatCalcDurationModel'), else the maximum.
+    uint statusPollSubscription_;  // Of the poll in flight ('GatStatusQueryCoalescer'); 0 when none.
+    uint32_t statusPollReplyTime_; // GetMonotonicClock32() when the last poll response was processed.
     //! @}
 
     //! \name Results
     //! @{
 public:
-    typedef ::std::pair<void const *, uint> reply_type; // Data pointer + number of bytes addressed.
-    reply_type reply() { return reply_type(&results_[0], results_.size()); }
+    typedef GatByteChain reply_type;
+    reply_type const & reply() const { return results_; } //!< Result data (views of the reply packets; no copies).
+
+    //! Delivers the reply frames to 'sink' as they arrive ('reply()' stays empty); see 'GatFrameSinkInterface'.
+    void setFrameSink(GatFrameSinkInterface *sink) { gatMultipktReply_.setFrameSink(sink); }
+    GatFrameSinkInterface * frameSink() const { return gatMultipktReply_.frameSink(); }
 
     enum class ResultTypeId : size_t
     {
@@ -125,8 +149,7 @@ protected:
 
 private:
     GatDataFormat gatDataFormat_;
-    typedef std::vector<uint8_t> results_type;
-    results_type results_;
+    GatByteChain results_;
     ResultTypeId resultTypeId_;
     //! @}
 
@@ -136,8 +159,13 @@ public:
     GatLinkLayer * setLinkLayer(GatLinkLayer *value);
     GatLinkLayer * linkLayer() const { return linkLayer_; }
 
+    //! Status polls go through these (shared with the other commands of the port); required.
+    void setStatusQueries(GatStatusQueryCoalescer *value);
+    GatStatusQueryCoalescer * statusQueries() const { return statusQueries_; }
+
 private:
     GatLinkLayer *linkLayer_;
+    GatStatusQueryCoalescer *statusQueries_; // Over 'linkLayer_'.
     //! @}
 
     //! \name Construction, Destruciton, and Assignment
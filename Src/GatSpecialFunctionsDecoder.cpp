@@ -0,0 +1,232 @@
+/*!
+    \file "GatSpecialFunctionsDecoder.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Incremental (frame by frame) decoding of the "Get Special Functions" XML reply.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatSpecialFunctionsDecoder.hpp"
+#include <QTextCodec>
+#include <ctype.h>
+
+
+int const utf8Mib = 106;   // IANA MIB of UTF-8.
+int const utf16Mib = 1015; // IANA MIB of UTF-16 (byte order mark, else host byte order).
+
+
+void
+GatSpecialFunctionsDecoder::onFrame(GatMultipktRply & /*host*/, uint frameNumber, GatByteView const &frameData,
+                                    bool lastFrame)
+{
+    if (1 == frameNumber) { reset(); }
+    if (hasError()) { return; }
+
+    decode(frameData.data(), frameData.size());
+    if (hasError() || !lastFrame) { return; }
+
+    if (!documentEnded_)
+    {
+        fail(reader_.hasError() && QXmlStreamReader::PrematureEndOfDocumentError != reader_.error()
+             ? reader_.errorString() : QString("Incomplete XML document."));
+    }
+    else if (0 == specialFunctionsDepth_)
+    {
+        fail("No 'SpecialFunctions' element.");
+    }
+    else
+    {
+        complete_ = true;
+    }
+}
+
+
+void
+GatSpecialFunctionsDecoder::onTransferFailed(GatMultipktRply & /*host*/)
+{
+    if (!hasError()) { fail("Transfer failed."); }
+}
+
+
+void
+GatSpecialFunctionsDecoder::decode(uint8_t const *data, uint dataSize)
+{
+    if (textEnded_ || 0 == dataSize) { return; }
+
+    if (nullptr == textDecoder_)
+    {
+        // Same test as was applied to the whole reply, applied to its first frame.
+        bool const isUtf16 = Encoding::Auto == encoding_
+                             ? (2 <= dataSize && (!isprint(data[0]) || !isprint(data[1])))
+                             : Encoding::Utf16 == encoding_;
+        QTextCodec *codec = QTextCodec::codecForMib(isUtf16 ? utf16Mib : utf8Mib);
+        if (nullptr == codec) { fail("No text codec."); return; }
+        textDecoder_.reset(codec->makeDecoder());
+    }
+
+    QString chunk(textDecoder_->toUnicode(reinterpret_cast<char const *>(data), static_cast<int>(dataSize)));
+    int const nulIndex = chunk.indexOf(QChar(0));
+    if (0 <= nulIndex)
+    {
+        chunk.truncate(nulIndex);
+        textEnded_ = true;
+    }
+    if (chunk.isEmpty()) { return; }
+
+    text_.append(chunk);
+    reader_.addData(chunk);
+    parse();
+}
+
+
+void
+GatSpecialFunctionsDecoder::parse()
+{
+    while (!reader_.atEnd() && !documentEnded_)
+    {
+        switch (reader_.readNext())
+        {
+            default:
+                // Do nothing.
+                break;
+
+            case QXmlStreamReader::StartElement:
+            {
+                ++depth_;
+                if (0 == specialFunctionsDepth_ && QLatin1String("SpecialFunctions") == reader_.name())
+                {
+                    specialFunctionsDepth_ = depth_;
+                }
+                else if (0 < specialFunctionsDepth_ && specialFunctionsDepth_ + 1 == depth_ &&
+                         QLatin1String("Function") == reader_.name())
+                {
+                    inFunction_ = true;
+                    haveFeature_ = false;
+                    feature_.clear();
+                    parameters_.clear();
+                }
+                else if (inFunction_ && specialFunctionsDepth_ + 2 == depth_ &&
+                         (QLatin1String("Feature") == reader_.name() || QLatin1String("Parameter") == reader_.name()))
+                {
+                    capturing_ = true;
+                    capturedText_.clear();
+                }
+                break;
+            }
+
+            case QXmlStreamReader::Characters:
+            {
+                if (capturing_) { capturedText_.append(reader_.text()); }
+                break;
+            }
+
+            case QXmlStreamReader::EndElement:
+            {
+                if (capturing_ && specialFunctionsDepth_ + 2 == depth_)
+                {
+                    // Only the first feature counts; parameters keep their order.
+                    capturing_ = false;
+                    if (QLatin1String("Parameter") == reader_.name()) { parameters_.append(capturedText_); }
+                    else if (!haveFeature_) { feature_ = capturedText_; haveFeature_ = true; }
+                }
+                else if (inFunction_ && specialFunctionsDepth_ + 1 == depth_)
+                {
+                    inFunction_ = false;
+                    if (!haveFeature_) { fail("'Function' element without a 'Feature' element."); return; }
+
+                    QStringList functionDefinition(feature_);
+                    functionDefinition.append(parameters_);
+                    ++functionCount_;
+                    if (functionHandler_)
+                    {
+                        try { functionHandler_(functionDefinition); } catch (...) { qWarning("Unexpected exception caught and discarded in GatSpecialFunctionsDecoder::parse(). " STRINGIZE(__LINE__)); }
+                    }
+                }
+                else if (specialFunctionsDepth_ == depth_)
+                {
+                    specialFunctionsDepth_ = -1;
+                }
+
+                if (0 == --depth_) { documentEnded_ = true; }
+                break;
+            }
+        }
+    }
+
+    // Running out of data (mid frame) is expected; the next frame continues where this one stopped.
+    if (reader_.hasError() && QXmlStreamReader::PrematureEndOfDocumentError != reader_.error())
+    {
+        fail(reader_.errorString());
+    }
+}
+
+
+void
+GatSpecialFunctionsDecoder::fail(QString const &description)
+{
+    errorString_ = description.isEmpty() ? QString("Bad XML.") : description;
+    complete_ = false;
+}
+
+
+void
+GatSpecialFunctionsDecoder::reset()
+{
+    textDecoder_.reset();
+    textEnded_ = false;
+    text_.clear();
+    reader_.clear();
+
+    depth_ = 0;
+    specialFunctionsDepth_ = 0;
+    documentEnded_ = false;
+    inFunction_ = false;
+    haveFeature_ = false;
+    capturing_ = false;
+    feature_.clear();
+    parameters_.clear();
+    capturedText_.clear();
+
+    functionCount_ = 0;
+    complete_ = false;
+    errorString_.clear();
+}
+
+
+GatSpecialFunctionsDecoder::GatSpecialFunctionsDecoder(Encoding encoding, function_handler_type functionHandler)
+    : encoding_(encoding)
+    , functionHandler_(functionHandler)
+    , textEnded_(false)
+    , depth_(0)
+    , specialFunctionsDepth_(0)
+    , documentEnded_(false)
+    , inFunction_(false)
+    , haveFeature_(false)
+    , capturing_(false)
+    , functionCount_(0)
+    , complete_(false)
+{
+    // Do nothing.
+}
+
+
+GatSpecialFunctionsDecoder::~GatSpecialFunctionsDecoder()
+{
+    // Do nothing.
+}
+
+
+/*
+    End of "GatSpecialFunctionsDecoder.cpp"
+*/
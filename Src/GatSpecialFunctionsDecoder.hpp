@@ -0,0 +1,121 @@
+/*!
+    \file "GatSpecialFunctionsDecoder.hpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Incremental (frame by frame) decoding of the "Get Special Functions" XML reply.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#ifndef GATSPECIALFUNCTIONSDECODER_HPP__686E6294_483F_4519_B047_4FBB1409CAA2__INCLUDED
+#define GATSPECIALFUNCTIONSDECODER_HPP__686E6294_483F_4519_B047_4FBB1409CAA2__INCLUDED
+
+
+#pragma once
+
+
+#include "Defs.hpp"
+#include "GatMultipktRply.hpp"
+#include <QStringList>
+#include <QXmlStreamReader>
+#include <functional>
+#include <memory>
+
+
+class QTextDecoder;
+
+
+/*!
+    \brief Decodes the "Get Special Functions" reply as its frames arrive (a 'GatFrameSinkInterface').
+
+    The XML is parsed with a 'QXmlStreamReader' fed one frame at a time, and each '<Function>' of the
+    '<SpecialFunctions>' element is handed to the function handler as soon as its end tag arrives, as a list of
+    strings: the feature, then the parameters (in order).  Nothing but the decoded text is kept.
+
+    Runs on the GAT I/O thread (where frames are delivered), as does the function handler.  A frame numbered 1
+    starts a new document.
+*/
+class GatSpecialFunctionsDecoder
+    : public GatFrameSinkInterface
+{
+public:
+    enum class Encoding : size_t {
+        Auto,  //!< UTF-16 when either of the first two bytes is not printable, else UTF-8.
+        Utf8,
+        Utf16, //!< Host byte order unless there is a byte order mark.
+        Undefined // Must always be last.
+    };
+    static size_t const encoding_Count = static_cast<size_t>(Encoding::Undefined) + 1;
+
+    typedef std::function<void (QStringList const &functionDefinition)> function_handler_type;
+
+    //! \name GatFrameSinkInterface
+    //! @{
+public:
+    virtual void onFrame(GatMultipktRply &host, uint frameNumber, GatByteView const &frameData, bool lastFrame);
+    virtual void onTransferFailed(GatMultipktRply &host);
+    //! @}
+
+    //! \name Results
+    //! @{
+public:
+    void reset();
+
+    bool isComplete() const { return complete_; } //!< The last frame arrived and the XML is well formed.
+    bool hasError() const { return !errorString_.isEmpty(); }
+    QString errorString() const { return errorString_; }
+    QString text() const { return text_; } //!< Decoded so far (for display).
+    uint functionCount() const { return functionCount_; }
+    //! @}
+
+    GatSpecialFunctionsDecoder(Encoding encoding, function_handler_type functionHandler);
+    ~GatSpecialFunctionsDecoder();
+
+private:
+    void decode(uint8_t const *data, uint dataSize);
+    void parse();
+    void fail(QString const &description);
+
+    Encoding encoding_;
+    function_handler_type functionHandler_;
+    std::unique_ptr<QTextDecoder> textDecoder_; // Keeps characters split across frames.
+    bool textEnded_; // A NUL character ends the text (as it did when the reply was one C string).
+    QString text_;
+    QXmlStreamReader reader_;
+
+    // Parser state.
+    int depth_; // Of the current element (the document element is 1).
+    int specialFunctionsDepth_; // 0 until '<SpecialFunctions>' starts; -1 after it ends (only the first counts).
+    bool documentEnded_; // The document element ended.
+    bool inFunction_;
+    bool haveFeature_;
+    bool capturing_; // Inside '<Feature>' or '<Parameter>' of a function.
+    QString feature_;
+    QStringList parameters_;
+    QString capturedText_;
+
+    uint functionCount_;
+    bool complete_;
+    QString errorString_;
+
+    GatSpecialFunctionsDecoder(GatSpecialFunctionsDecoder const&) = delete; //!< No cloning.
+    GatSpecialFunctionsDecoder& operator=(GatSpecialFunctionsDecoder const&) = delete; //!< No cloning.
+};
+
+
+#endif // #ifndef GATSPECIALFUNCTIONSDECODER_HPP__686E6294_483F_4519_B047_4FBB1409CAA2__INCLUDED
+
+
+/*
+    End of "GatSpecialFunctionsDecoder.hpp"
+*/
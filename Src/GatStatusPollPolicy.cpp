@@ -0,0 +1,69 @@
+/*!
+    \file "GatStatusPollPolicy.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    When to poll a GM (SQ) for the end of an authentication calculation.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatStatusPollPolicy.hpp"
+
+
+void
+GatStatusPollPolicy::start()
+{
+    period_ = (std::min)(initialPeriod_, maxPeriod_);
+    expectedDurationPassed_ = false;
+    pollCount_ = 0;
+}
+
+
+uint
+GatStatusPollPolicy::nextPeriod(uint elapsed)
+{
+    uint result = period_;
+    // Rounded up, so any backoff over 100% grows even a period of 1ms.
+    period_ = static_cast<uint>((std::min)(static_cast<quint64>(maxPeriod_),
+                                           (static_cast<quint64>(period_) * backoffPercent_ + 99u) / 100u));
+
+    // Land on the expected end instead of passing it, then poll quickly (again) from there.
+    if (0 < expectedDuration_ && !expectedDurationPassed_ && elapsed + result >= expectedDuration_)
+    {
+        expectedDurationPassed_ = true;
+        result = (std::max)(expectedDuration_ > elapsed ? expectedDuration_ - elapsed : 0u,
+                            (std::min)(initialPeriod_, maxPeriod_));
+        period_ = (std::min)(initialPeriod_, maxPeriod_);
+    }
+
+    ++pollCount_;
+    return result;
+}
+
+
+GatStatusPollPolicy::GatStatusPollPolicy()
+    : initialPeriod_(defaultInitialPeriod)
+    , maxPeriod_(defaultMaxPeriod)
+    , backoffPercent_(defaultBackoffPercent)
+    , expectedDuration_(0)
+    , period_(defaultInitialPeriod)
+    , expectedDurationPassed_(false)
+    , pollCount_(0)
+{
+    // Do nothing.
+}
+
+
+/*
+    End of "GatStatusPollPolicy.cpp"
+*/
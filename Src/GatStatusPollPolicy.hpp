@@ -0,0 +1,79 @@
+/*!
+    \file "GatStatusPollPolicy.hpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    When to poll a GM (SQ) for the end of an authentication calculation.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#ifndef GATSTATUSPOLLPOLICY_HPP__44AA2798_587E_4485_A6BB_195FBBDF696E__INCLUDED
+#define GATSTATUSPOLLPOLICY_HPP__44AA2798_587E_4485_A6BB_195FBBDF696E__INCLUDED
+
+
+#pragma once
+
+
+#include "Defs.hpp"
+
+
+/*!
+    \brief Status poll periods: fast at first, then backing off geometrically, and aimed at the expected end.
+
+    Quick calculations are found finished by the first few (closely spaced) polls, and long ones are polled less
+    and less often (up to the maximum period), which keeps the load on the GM down.  When the duration of the
+    calculation is expected (see 'GatCalcDurationModel'), the poll that would pass it is moved to land on it, and
+    backoff starts over from there, since that is when the calculation most likely ends.
+*/
+class GatStatusPollPolicy
+{
+public:
+    static uint const defaultInitialPeriod = 100; // Milliseconds.
+    static uint const defaultMaxPeriod = 3000;    // Milliseconds.
+    static uint const defaultBackoffPercent = 150; // Each period is this percentage of the one before.
+
+    void setInitialPeriod(uint milliseconds) { initialPeriod_ = (std::max)(1u, milliseconds); }
+    uint initialPeriod() const { return initialPeriod_; }
+    void setMaxPeriod(uint milliseconds) { maxPeriod_ = (std::max)(1u, milliseconds); }
+    uint maxPeriod() const { return maxPeriod_; }
+    void setBackoffPercent(uint percent) { backoffPercent_ = (std::max)(100u, percent); }
+    uint backoffPercent() const { return backoffPercent_; }
+
+    //! Milliseconds from the start of polling; 0 when unknown (backoff only).
+    void setExpectedDuration(uint milliseconds) { expectedDuration_ = milliseconds; }
+    uint expectedDuration() const { return expectedDuration_; }
+
+    void start(); //!< Polling (of one calculation) starts.
+    uint nextPeriod(uint elapsed); //!< Milliseconds until the next poll; 'elapsed' since 'start()'.
+    uint pollCount() const { return pollCount_; } //!< Periods handed out since 'start()'.
+
+    GatStatusPollPolicy();
+
+private:
+    uint initialPeriod_;
+    uint maxPeriod_;
+    uint backoffPercent_;
+    uint expectedDuration_;
+
+    uint period_; // Next backoff period.
+    bool expectedDurationPassed_;
+    uint pollCount_;
+};
+
+
+#endif // #ifndef GATSTATUSPOLLPOLICY_HPP__44AA2798_587E_4485_A6BB_195FBBDF696E__INCLUDED
+
+
+/*
+    End of "GatStatusPollPolicy.hpp"
+*/
@@ -0,0 +1,147 @@
+/*!
+    \file "GatStatusQueryCoalescer.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    One status query (SQ) in flight per GM, shared by everyone who asks.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatStatusQueryCoalescer.hpp"
+
+
+uint
+GatStatusQueryCoalescer::query(subscriber_type subscriber, uint maxAgeInMilliseconds)
+{
+    if (!subscriber) { return 0; }
+
+    if (!queryInFlight_ && replyIsFresh(maxAgeInMilliseconds))
+    {
+        ++queriesAnswered_;
+        GatByteView const reply(keptReply_); // The subscriber may query again (and so replace the kept reply).
+        try { subscriber(GatLinkLayer::ResultType::Reply, reply); } catch (...) { qWarning("Unexpected exception caught and discarded in GatStatusQueryCoalescer::query(). " STRINGIZE(__LINE__)); }
+        return 0;
+    }
+
+    if (!queryInFlight_)
+    {
+        using namespace std::placeholders;
+        GatLinkLayer::RequestResult const result =
+            linkLayer_.sendRequest(GatRqst::SQ_01, nullptr, 0,
+                                   std::bind(&GatStatusQueryCoalescer::onReply, this, _1, _2, generation_));
+        if (GatLinkLayer::RequestResult::Success != result && GatLinkLayer::RequestResult::Pending != result)
+        {
+            try { subscriber(GatLinkLayer::ResultType::Undefined, GatByteView()); } catch (...) { qWarning("Unexpected exception caught and discarded in GatStatusQueryCoalescer::query(). " STRINGIZE(__LINE__)); }
+            return 0;
+        }
+        queryInFlight_ = true;
+        ++queriesSent_;
+    }
+
+    // Zero is "no subscription"; skip it when the ids wrap.
+    if (0 == nextSubscriptionId_) { ++nextSubscriptionId_; }
+    Subscription subscription;
+    subscription.id_ = nextSubscriptionId_++;
+    subscription.subscriber_ = subscriber;
+    subscriptions_.push_back(subscription);
+
+    return subscription.id_;
+}
+
+
+void
+GatStatusQueryCoalescer::unsubscribe(uint subscriptionId)
+{
+    for (subscriptions_type::iterator subscription = subscriptions_.begin(); subscriptions_.end() != subscription;
+         ++subscription)
+    {
+        if (subscriptionId == subscription->id_)
+        {
+            subscriptions_.erase(subscription);
+            break;
+        }
+    }
+
+    // The query stays in flight (it cannot be recalled); its reply is kept for whoever asks next.
+}
+
+
+void
+GatStatusQueryCoalescer::discardSubscribers()
+{
+    subscriptions_.clear();
+    queryInFlight_ = false;
+    ++generation_;
+    keptReply_ = GatByteView();
+}
+
+
+void
+GatStatusQueryCoalescer::onReply(GatLinkLayer &host, GatLinkLayer::ResultType resultType, uint generation)
+{
+    if (generation_ != generation) { return; } // Discarded.
+
+    queryInFlight_ = false;
+    ++generation_;
+
+    GatByteView reply;
+    if (GatLinkLayer::ResultType::Reply == resultType)
+    {
+        reply = host.replyView();
+        keptReply_ = reply;
+        keptReplyTime_ = monotonicClock32();
+        keptReplyTransmitCount_ = host.transmitCount();
+    }
+    else
+    {
+        keptReply_ = GatByteView();
+    }
+
+    // Subscribers may query again from here, which starts a new query (with subscribers of its own).
+    subscriptions_type subscriptions;
+    subscriptions.swap(subscriptions_);
+    for (Subscription const &subscription : subscriptions)
+    {
+        ++queriesAnswered_;
+        try { subscription.subscriber_(resultType, reply); } catch (...) { qWarning("Unexpected exception caught and discarded in GatStatusQueryCoalescer::onReply(). " STRINGIZE(__LINE__)); }
+    }
+}
+
+
+bool
+GatStatusQueryCoalescer::replyIsFresh(uint maxAgeInMilliseconds) const
+{
+    return !keptReply_.isEmpty() &&
+           (std::min)(maxAgeInMilliseconds, stalenessWindow_) > monotonicClock32() - keptReplyTime_ &&
+           keptReplyTransmitCount_ == linkLayer_.transmitCount();
+}
+
+
+GatStatusQueryCoalescer::GatStatusQueryCoalescer(GatLinkLayer &linkLayer)
+    : linkLayer_(linkLayer)
+    , nextSubscriptionId_(1)
+    , queryInFlight_(false)
+    , generation_(0)
+    , stalenessWindow_(defaultStalenessWindow)
+    , keptReplyTime_(0)
+    , keptReplyTransmitCount_(0)
+    , queriesSent_(0)
+    , queriesAnswered_(0)
+{
+    // Do nothing.
+}
+
+
+/*
+    End of "GatStatusQueryCoalescer.cpp"
+*/
@@ -0,0 +1,127 @@
+/*!
+    \file "GatStatusQueryCoalescer.hpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    One status query (SQ) in flight per GM, shared by everyone who asks.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#ifndef GATSTATUSQUERYCOALESCER_HPP__9B4C3A51_C1FC_4E32_BB67_AB8E2CD0B520__INCLUDED
+#define GATSTATUSQUERYCOALESCER_HPP__9B4C3A51_C1FC_4E32_BB67_AB8E2CD0B520__INCLUDED
+
+
+#pragma once
+
+
+#include "Defs.hpp"
+#include "GatBuffer.hpp"
+#include "GatLinkLayer.hpp"
+#include <functional>
+#include <vector>
+
+
+/*!
+    \brief Coalesces the status queries (SQ/SR) of one GM.
+
+    Everyone who asks while a query is in flight is answered by its reply, so the GM sees one SQ however many
+    clients poll it.  A reply is also kept, and answers later queries for as long as it is fresh: younger than the
+    staleness window (or the age the client asks for), and no other request was sent to the GM since (which may
+    have changed its status, e.g. an IACQ starting a calculation).  Lives in the thread of its link layer.
+*/
+class GatStatusQueryCoalescer
+{
+public:
+    //! 'reply' is the SR packet (a view of the link layer's reply) when 'resultType' is 'Reply', else empty.
+    typedef std::function<void (GatLinkLayer::ResultType resultType, GatByteView const &reply)> subscriber_type;
+
+    static uint const defaultStalenessWindow = 100; // Milliseconds.
+
+    //! \name Queries
+    //! @{
+public:
+    /*!
+        Calls 'subscriber' exactly once with the status of the GM, unless unsubscribed (or discarded) first.  Returns
+        the subscription, or 0 when 'subscriber' was already called (a fresh reply was kept, or the query could not
+        be sent, in which case the result type is 'Undefined').
+    */
+    uint query(subscriber_type subscriber) { return query(subscriber, stalenessWindow_); }
+    uint query(subscriber_type subscriber, uint maxAgeInMilliseconds);
+
+    void unsubscribe(uint subscriptionId); //!< Its subscriber is not called.
+    void discardSubscribers(); //!< None are called (e.g. the link layer discarded its requests).
+
+    bool queryInFlight() const { return queryInFlight_; }
+    uint subscriberCount() const { return static_cast<uint>(subscriptions_.size()); }
+
+private:
+    struct Subscription
+    {
+        uint id_;
+        subscriber_type subscriber_;
+    };
+    typedef std::vector<Subscription> subscriptions_type;
+
+    void onReply(GatLinkLayer &host, GatLinkLayer::ResultType resultType, uint generation);
+
+    GatLinkLayer &linkLayer_;
+    subscriptions_type subscriptions_; // In the order they subscribed.
+    uint nextSubscriptionId_;
+    bool queryInFlight_;
+    uint generation_; // Of the query in flight; replies to discarded queries are ignored.
+    //! @}
+
+    //! \name Kept Reply
+    //! @{
+public:
+    void setStalenessWindow(uint milliseconds) { stalenessWindow_ = milliseconds; } //!< 0 keeps nothing.
+    uint stalenessWindow() const { return stalenessWindow_; }
+
+private:
+    bool replyIsFresh(uint maxAgeInMilliseconds) const;
+
+    uint stalenessWindow_;
+    GatByteView keptReply_; // Empty when none.
+    uint32_t keptReplyTime_; // monotonicClock32() when received.
+    uint keptReplyTransmitCount_; // 'GatLinkLayer::transmitCount()' when received.
+    //! @}
+
+    //! \name Statistics
+    //! @{
+public:
+    uint queriesSent() const { return queriesSent_; } //!< SQs sent to the GM.
+    uint queriesAnswered() const { return queriesAnswered_; } //!< Subscribers called (from sent or kept replies).
+
+private:
+    uint queriesSent_;
+    uint queriesAnswered_;
+    //! @}
+
+    //! \name Construction, Destruction, and Assignment
+    //! @{
+public:
+    GatStatusQueryCoalescer(GatLinkLayer &linkLayer);
+
+private:
+    GatStatusQueryCoalescer(GatStatusQueryCoalescer const&) = delete; //!< No cloning; leave unimplemented!
+    GatStatusQueryCoalescer& operator=(GatStatusQueryCoalescer const&) = delete; //!< No cloning; leave unimplemented!
+    //! @}
+};
+
+
+#endif // #ifndef GATSTATUSQUERYCOALESCER_HPP__9B4C3A51_C1FC_4E32_BB67_AB8E2CD0B520__INCLUDED
+
+
+/*
+    End of "GatStatusQueryCoalescer.hpp"
+*/
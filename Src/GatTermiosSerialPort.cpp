@@ -0,0 +1,347 @@
+/*!
+    \file "GatTermiosSerialPort.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Raw (termios) serial device transport for the GAT link layer.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatTermiosSerialPort.hpp"
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/serial.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+
+bool
+GatTermiosSerialPort::baudRateToSpeed(uint baudRate, speed_t &speed)
+{
+    static struct BaudRateMap {
+        uint baudRate_;
+        speed_t speed_;
+    } const speeds[] = {
+        { 1200, B1200, },
+        { 2400, B2400, },
+        { 4800, B4800, },
+        { 9600, B9600, },
+        { 19200, B19200, },
+        { 38400, B38400, },
+        { 57600, B57600, },
+        { 115200, B115200, },
+        { 230400, B230400, },
+        { 460800, B460800, },
+        { 921600, B921600, },
+    };
+    for (size_t idx = 0; arycap(speeds) > idx; ++idx)
+    {
+        if (speeds[idx].baudRate_ == baudRate)
+        {
+            speed = speeds[idx].speed_;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/*!
+    Configures an open serial device raw with the given framing and flow control.  VMIN = VTIME = 0 so that reads
+    never block.
+*/
+bool
+GatTermiosSerialPort::configureRawDevice(int fileDescriptor, GatSerialLineSettings const &lineSettings)
+{
+    speed_t speed = B9600;
+    if (!lineSettings.isValid() || !baudRateToSpeed(lineSettings.baudRate_, speed))
+    {
+        errno = EINVAL;
+        return false;
+    }
+
+    termios tty;
+    if (0 != tcgetattr(fileDescriptor, &tty)) { return false; }
+
+    static tcflag_t const characterSizes[] = { CS5, CS6, CS7, CS8 };
+    cfmakeraw(&tty);
+    tty.c_cflag &= ~(CSTOPB | PARENB | PARODD | CRTSCTS | CSIZE);
+    tty.c_cflag |= characterSizes[lineSettings.dataBits_ - 5] | CLOCAL | CREAD;
+    if (2 == lineSettings.stopBits_) { tty.c_cflag |= CSTOPB; }
+    if (GatSerialLineSettings::Parity::None != lineSettings.parity_) { tty.c_cflag |= PARENB; }
+    if (GatSerialLineSettings::Parity::Odd == lineSettings.parity_) { tty.c_cflag |= PARODD; }
+    if (GatSerialLineSettings::FlowControl::Hardware == lineSettings.flowControl_) { tty.c_cflag |= CRTSCTS; }
+    tty.c_iflag &= ~(IXON | IXOFF | IXANY);
+    if (GatSerialLineSettings::FlowControl::Software == lineSettings.flowControl_) { tty.c_iflag |= IXON | IXOFF; }
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+
+    return 0 == cfsetispeed(&tty, speed) &&
+           0 == cfsetospeed(&tty, speed) &&
+           0 == tcsetattr(fileDescriptor, TCSANOW, &tty) &&
+           0 == tcflush(fileDescriptor, TCIOFLUSH); // Discard anything sent or received at the previous settings.
+}
+
+
+/*!
+    Opens a serial device non-blocking and configures it raw (see 'configureRawDevice()').
+*/
+int
+GatTermiosSerialPort::openRawDevice(QString const &serialDevicePathname, GatSerialLineSettings const &lineSettings,
+                                    QString &errorDescription)
+{
+    speed_t speed = B9600;
+    if (!baudRateToSpeed(lineSettings.baudRate_, speed))
+    {
+        errorDescription = QString("Unsupported baud rate %1 for serial port \"%2\".")
+                           .arg(lineSettings.baudRate_).arg(serialDevicePathname);
+        return -1;
+    }
+
+    std::string const pathname(toStdStr(serialDevicePathname));
+    int fd = ::open(pathname.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+
+    bool const success = -1 != fd &&
+                         0 == ioctl(fd, TIOCEXCL) && // Port is always exclusive to this thread.
+                         configureRawDevice(fd, lineSettings);
+    if (!success)
+    {
+        int const errorNumber = errno;
+        if (-1 != fd) { ::close(fd); }
+        fd = -1;
+        errorDescription = QString("Unable to open serial port \"%1\".\n%2")
+                           .arg(serialDevicePathname).arg(errnoToStr(errorNumber));
+        qWarning() << errorDescription;
+    }
+
+    return fd;
+}
+
+
+bool
+GatTermiosSerialPort::open(QString const &serialDevicePathname, GatSerialLineSettings const &lineSettings,
+                           QString &errorDescription)
+{
+    close();
+
+    fd_ = openRawDevice(serialDevicePathname, lineSettings, errorDescription);
+    if (-1 == fd_) { return false; }
+
+    if (!reactor_.add(fd_, EPOLLIN | EPOLLET, this))
+    {
+        ::close(fd_);
+        fd_ = -1;
+        errorDescription = QString("Unable to watch serial port \"%1\" (epoll).").arg(serialDevicePathname);
+        qWarning() << errorDescription;
+        return false;
+    }
+
+    // Without the timer the link layer times the gap after received data itself (QTimer).
+    if (!interByteTimer_.open()) { qWarning() << "Inter-byte timer unavailable; using the link layer's timer."; }
+    if (!transmitTimer_.open()) { qWarning() << "Transmit timer unavailable; using estimated transmit times."; }
+    microsecondsPerCharacter_ = lineSettings.microsecondsPerCharacter();
+
+    return true;
+}
+
+
+bool
+GatTermiosSerialPort::setLineSettings(GatSerialLineSettings const &lineSettings)
+{
+    if (-1 == fd_) { return false; }
+
+    if (!configureRawDevice(fd_, lineSettings))
+    {
+        qWarning() << "Unable to change serial line settings: " << errnoToStr(errno);
+        return false;
+    }
+    microsecondsPerCharacter_ = lineSettings.microsecondsPerCharacter();
+
+    return true;
+}
+
+
+void
+GatTermiosSerialPort::close()
+{
+    if (-1 == fd_) { return; }
+
+    interByteTimer_.close();
+    transmitTimer_.close();
+    reactor_.remove(fd_);
+    ::close(fd_);
+    fd_ = -1;
+}
+
+
+uint
+GatTermiosSerialPort::write(GatLinkLayer & /*host*/, void const *data, uint dataSizeInBytes)
+{
+    if (-1 == fd_) { return 0; }
+
+    // Packets are much smaller than the tty output buffer, so this practically never blocks (or is short).
+    uint8_t const *bytes = reinterpret_cast<uint8_t const *>(data);
+    uint byteCountWritten = 0;
+    while (dataSizeInBytes > byteCountWritten)
+    {
+        ssize_t const result = ::write(fd_, bytes + byteCountWritten, dataSizeInBytes - byteCountWritten);
+        if (-1 == result)
+        {
+            if (EINTR == errno) { continue; }
+            qWarning() << "write() failed: " << errnoToStr(errno);
+            break;
+        }
+        byteCountWritten += static_cast<uint>(result);
+    }
+
+    // Check the output queue once the request could have been sent.
+    if (0 < byteCountWritten && transmitTimer_.isOpen())
+    {
+        transmitTimer_.start(static_cast<qint64>(byteCountWritten) * microsecondsPerCharacter_);
+    }
+
+    return byteCountWritten;
+}
+
+
+void
+GatTermiosSerialPort::onLinkToHost(GatLinkLayer *host)
+{
+    linkLayer_ = host;
+}
+
+
+void
+GatTermiosSerialPort::onEpollEvents(uint32_t events)
+{
+    if (0 != (events & (EPOLLIN | EPOLLERR | EPOLLHUP)))
+    {
+        readAll();
+    }
+}
+
+
+/*!
+    Reads until the device is drained (required by edge triggered epoll).  Data is read directly into the link
+    layer's reply buffer whenever it can accept data.
+*/
+void
+GatTermiosSerialPort::readAll()
+{
+    for (;;)
+    {
+        GatLinkLayer::receive_buffer_type buffer(nullptr, 0);
+        if (nullptr != linkLayer_) { buffer = linkLayer_->receiveBuffer(); }
+        uint8_t discardBuffer[GAT_MAX_PACKET_SIZE];
+        bool const readIntoLinkLayer = nullptr != buffer.first && 0 < buffer.second;
+        if (!readIntoLinkLayer) { buffer = GatLinkLayer::receive_buffer_type(discardBuffer, sizeof(discardBuffer)); }
+
+        ssize_t const result = ::read(fd_, buffer.first, buffer.second);
+        if (0 < result)
+        {
+            if (nullptr == linkLayer_) { continue; }
+            onChunkReceived();
+            if (readIntoLinkLayer) { linkLayer_->receivedIntoBuffer(static_cast<size_t>(result)); }
+            else                   { linkLayer_->receiveData(discardBuffer, static_cast<size_t>(result)); }
+        }
+        else if (-1 == result && EINTR == errno)
+        {
+            continue;
+        }
+        else
+        {
+            if (-1 == result && EAGAIN != errno && EWOULDBLOCK != errno)
+            {
+                qWarning() << "read() failed: " << errnoToStr(errno);
+            }
+            break; // Drained (or device gone).
+        }
+    }
+}
+
+
+void
+GatTermiosSerialPort::onChunkReceived()
+{
+    lastReceiveTime_ = GatTimerFd::monotonicMicroseconds();
+    if (interByteTimer_.isOpen() && !interByteTimer_.isActive())
+    {
+        interByteTimer_.start(linkLayer_->interByteTimeoutInMicroseconds());
+    }
+}
+
+
+void
+GatTermiosSerialPort::onTimerFdExpired(GatTimerFd &timer)
+{
+    if (nullptr == linkLayer_) { return; }
+
+    if (&transmitTimer_ == &timer)
+    {
+        checkTransmitComplete();
+        return;
+    }
+
+    qint64 const gap = GatTimerFd::monotonicMicroseconds() - lastReceiveTime_;
+    qint64 const interByteTimeout = linkLayer_->interByteTimeoutInMicroseconds();
+    if (interByteTimeout > gap) { interByteTimer_.start(interByteTimeout - gap); } // Data arrived meanwhile.
+    else                        { linkLayer_->interByteTimeoutElapsed(); }
+}
+
+
+void
+GatTermiosSerialPort::checkTransmitComplete()
+{
+    int pendingByteCount = 0;
+    if (0 != ioctl(fd_, TIOCOUTQ, &pendingByteCount)) { return; } // Unknown; the link layer keeps its estimate.
+
+    // The UART's shift register (not counted by TIOCOUTQ) where the driver reports it; USB adapters do not.
+    unsigned int lineStatus = TIOCSER_TEMT;
+    if (0 == pendingByteCount && 0 == ioctl(fd_, TIOCSERGETLSR, &lineStatus) && 0 == (lineStatus & TIOCSER_TEMT))
+    {
+        pendingByteCount = 1;
+    }
+
+    if (0 < pendingByteCount)
+    {
+        transmitTimer_.start(static_cast<qint64>(pendingByteCount) * microsecondsPerCharacter_);
+        return;
+    }
+
+    linkLayer_->transmitComplete();
+}
+
+
+GatTermiosSerialPort::GatTermiosSerialPort(GatEpollReactor &reactor)
+    : fd_(-1)
+    , microsecondsPerCharacter_(GatSerialLineSettings().microsecondsPerCharacter())
+    , linkLayer_(nullptr)
+    , reactor_(reactor)
+    , interByteTimer_(reactor, *this)
+    , lastReceiveTime_(0)
+    , transmitTimer_(reactor, *this)
+{
+    // Do nothing.
+}
+
+
+GatTermiosSerialPort::~GatTermiosSerialPort()
+{
+    close();
+}
+
+
+/*
+    End of "GatTermiosSerialPort.cpp"
+*/
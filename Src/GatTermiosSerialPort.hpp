@@ -0,0 +1,130 @@
+/*!
+    \file "GatTermiosSerialPort.hpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Raw (termios) serial device transport for the GAT link layer.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#ifndef GATTERMIOSSERIALPORT_HPP__37DF24B9_B28F_471F_AA95_38DF3E389179__INCLUDED
+#define GATTERMIOSSERIALPORT_HPP__37DF24B9_B28F_471F_AA95_38DF3E389179__INCLUDED
+
+
+#pragma once
+
+
+#include "Defs.hpp"
+#include "GatEpollReactor.hpp"
+#include "GatLinkLayer.hpp"
+#include "GatSerialLineSettings.hpp"
+#include "GatTimerFd.hpp"
+#include <termios.h>
+
+
+/*!
+    \brief Raw (termios) serial device transport for the GAT link layer.
+
+    This is an alternative to QSerialPort.  The device is opened non-blocking, configured raw (per the port's line
+    settings) with termios, and registered (edge triggered) with the host's epoll reactor.  The thread only wakes
+    when data arrives, and received data is read directly into the link layer's reply buffer (no intermediate copy).
+
+    The gap after received data (end of reply) is timed here with a timerfd on the same reactor, instead of by the
+    link layer's QTimer.  The timer is armed once per gap, not per chunk: when it expires early (data arrived while
+    it ran) it is rearmed for the remainder, measured from when the last chunk was read.
+
+    When a request is written a second timerfd is armed for its transmit time, after which the driver's output
+    queue (TIOCOUTQ, and the UART's transmitter empty flag where the driver reports it) is checked, and rechecked
+    after the remaining characters' time, until the request has left; the link layer is then told (see
+    'GatLinkLayer::transmitComplete()').  tcdrain() would report the same instant, but it blocks the thread.
+*/
+class GatTermiosSerialPort
+    : public GatLinkLayerStrategyInterface
+    , public GatEpollHandlerInterface
+    , public GatTimerFdHandlerInterface
+{
+    //! \name Device
+    //! @{
+public:
+    bool open(QString const &serialDevicePathname, GatSerialLineSettings const &lineSettings,
+              QString &errorDescription);
+    bool setLineSettings(GatSerialLineSettings const &lineSettings); //!< Changes the settings of the open device.
+    void close();
+    bool isOpen() const { return -1 != fd_; }
+    int handle() const { return fd_; }
+
+    static bool baudRateToSpeed(uint baudRate, speed_t &speed);
+    static bool configureRawDevice(int fileDescriptor, GatSerialLineSettings const &lineSettings);
+    static int openRawDevice(QString const &serialDevicePathname, GatSerialLineSettings const &lineSettings,
+                             QString &errorDescription); //!< Returns the file descriptor, or -1.
+
+private:
+    int fd_;
+    uint microsecondsPerCharacter_;
+    //! @}
+
+    //! \name GatLinkLayerStrategyInterface
+    //! @{
+public:
+    virtual uint write(GatLinkLayer &host, void const *data, uint dataSizeInBytes);
+    virtual void onLinkToHost(GatLinkLayer *host);
+    virtual bool providesInterByteTimeout() const { return interByteTimer_.isOpen(); }
+
+private:
+    GatLinkLayer *linkLayer_;
+    //! @}
+
+    //! \name GatEpollHandlerInterface
+    //! @{
+public:
+    virtual void onEpollEvents(uint32_t events);
+
+private:
+    void readAll();
+
+    GatEpollReactor &reactor_;
+    //! @}
+
+    //! \name GatTimerFdHandlerInterface
+    //! @{
+public:
+    virtual void onTimerFdExpired(GatTimerFd &timer);
+
+private:
+    void onChunkReceived();
+    void checkTransmitComplete();
+
+    GatTimerFd interByteTimer_;
+    qint64 lastReceiveTime_; // Monotonic microseconds (see 'GatTimerFd::monotonicMicroseconds()').
+    GatTimerFd transmitTimer_;
+    //! @}
+
+    //! \name Construction, Destruction, and Assignment
+    //! @{
+public:
+    GatTermiosSerialPort(GatEpollReactor &reactor);
+    virtual ~GatTermiosSerialPort();
+
+private:
+    GatTermiosSerialPort(GatTermiosSerialPort const&) = delete; //!< No cloning; leave unimplemented!
+    GatTermiosSerialPort& operator=(GatTermiosSerialPort const&) = delete; //!< No cloning; leave unimplemented!
+    //! @}
+};
+
+
+#endif // #ifndef GATTERMIOSSERIALPORT_HPP__37DF24B9_B28F_471F_AA95_38DF3E389179__INCLUDED
+
+
+/*
+    End of "GatTermiosSerialPort.hpp"
+*/
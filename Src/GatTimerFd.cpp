@@ -0,0 +1,135 @@
+/*!
+    \file "GatTimerFd.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    One-shot microsecond timer (timerfd) serviced by an epoll reactor.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatTimerFd.hpp"
+#include <errno.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+
+bool
+GatTimerFd::open()
+{
+    if (-1 != fd_) { return true; }
+
+    fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (-1 == fd_)
+    {
+        qWarning() << "timerfd_create() failed: " << errnoToStr(errno);
+        return false;
+    }
+
+    if (!reactor_.add(fd_, EPOLLIN, this))
+    {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    return true;
+}
+
+
+void
+GatTimerFd::close()
+{
+    if (-1 == fd_) { return; }
+
+    reactor_.remove(fd_);
+    ::close(fd_);
+    fd_ = -1;
+    active_ = false;
+}
+
+
+bool
+GatTimerFd::start(qint64 microseconds)
+{
+    if (-1 == fd_) { return false; }
+
+    // A zero 'it_value' disarms the timer, so the shortest delay is 1us.
+    qint64 const delay = (std::max)(microseconds, static_cast<qint64>(1));
+    itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = static_cast<time_t>(delay / 1000000);
+    spec.it_value.tv_nsec = static_cast<long>((delay % 1000000) * 1000);
+    active_ = 0 == timerfd_settime(fd_, 0, &spec, nullptr);
+    if (!active_) { qWarning() << "timerfd_settime() failed: " << errnoToStr(errno); }
+
+    return active_;
+}
+
+
+void
+GatTimerFd::stop()
+{
+    if (!active_) { return; }
+
+    itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    timerfd_settime(fd_, 0, &spec, nullptr);
+    active_ = false;
+}
+
+
+qint64
+GatTimerFd::monotonicMicroseconds()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<qint64>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+
+void
+GatTimerFd::onEpollEvents(uint32_t events)
+{
+    if (0 == (events & EPOLLIN)) { return; }
+
+    // Consume the expiration count (level triggered), ignoring an expiry that raced with 'stop()' or 'start()'.
+    uint64_t expirations = 0;
+    ssize_t const result = ::read(fd_, &expirations, sizeof(expirations));
+    if (static_cast<ssize_t>(sizeof(expirations)) != result || 0 == expirations || !active_) { return; }
+
+    active_ = false;
+    handler_.onTimerFdExpired(*this);
+}
+
+
+GatTimerFd::GatTimerFd(GatEpollReactor &reactor, GatTimerFdHandlerInterface &handler)
+    : fd_(-1)
+    , active_(false)
+    , reactor_(reactor)
+    , handler_(handler)
+{
+    // Do nothing.
+}
+
+
+GatTimerFd::~GatTimerFd()
+{
+    close();
+}
+
+
+/*
+    End of "GatTimerFd.cpp"
+*/
@@ -0,0 +1,83 @@
+/*!
+    \file "GatTimerFd.hpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    One-shot microsecond timer (timerfd) serviced by an epoll reactor.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#ifndef GATTIMERFD_HPP__91758791_522C_4AF6_BA8E_37839C97E60B__INCLUDED
+#define GATTIMERFD_HPP__91758791_522C_4AF6_BA8E_37839C97E60B__INCLUDED
+
+
+#pragma once
+
+
+#include "Defs.hpp"
+#include "GatEpollReactor.hpp"
+
+
+class GatTimerFd;
+
+
+struct GatTimerFdHandlerInterface
+{
+    virtual void onTimerFdExpired(GatTimerFd &timer) = 0;
+};
+
+
+/*!
+    \brief One-shot microsecond timer (timerfd) serviced by an epoll reactor.
+
+    Unlike QTimer (millisecond resolution, and coarse by default), the timer expires on the monotonic clock with the
+    kernel's high resolution timer precision, and it wakes the thread through the reactor it shares with the serial
+    devices, so expiry and received data are serviced in the same wakeup.  The timer must be used only by the thread
+    that owns the reactor.
+*/
+class GatTimerFd
+    : public GatEpollHandlerInterface
+{
+public:
+    bool open();
+    void close();
+    bool isOpen() const { return -1 != fd_; }
+
+    bool start(qint64 microseconds); //!< (Re)starts; expires once, 'microseconds' from now.
+    void stop();
+    bool isActive() const { return active_; }
+
+    static qint64 monotonicMicroseconds(); //!< CLOCK_MONOTONIC (the clock the timer runs on).
+
+    virtual void onEpollEvents(uint32_t events);
+
+    GatTimerFd(GatEpollReactor &reactor, GatTimerFdHandlerInterface &handler);
+    virtual ~GatTimerFd();
+
+private:
+    int fd_;
+    bool active_;
+    GatEpollReactor &reactor_;
+    GatTimerFdHandlerInterface &handler_;
+
+    GatTimerFd(GatTimerFd const&) = delete; //!< No cloning; leave unimplemented!
+    GatTimerFd& operator=(GatTimerFd const&) = delete; //!< No cloning; leave unimplemented!
+};
+
+
+#endif // #ifndef GATTIMERFD_HPP__91758791_522C_4AF6_BA8E_37839C97E60B__INCLUDED
+
+
+/*
+    End of "GatTimerFd.hpp"
+*/
@@ -0,0 +1,400 @@
+/*!
+    \file "GatUringEngine.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Batches serial device reads and writes for many ports through one io_uring.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatUringEngine.hpp"
+#include <QApplication>
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#ifdef ENABLE_GAT_IO_URING
+#   include <liburing.h>
+#else
+struct io_uring { };
+#endif // #ifdef ENABLE_GAT_IO_URING
+
+
+namespace
+{
+    uint const ringEntryCount = 256; // Three per port may be in flight (poll, read, write); the rest wait in the ring.
+    size_t const completionBatchSize = 64;
+}
+
+
+bool
+GatUringEngine::isSupported()
+{
+#ifdef ENABLE_GAT_IO_URING
+    return true;
+#else
+    return false;
+#endif // #ifdef ENABLE_GAT_IO_URING
+}
+
+
+bool
+GatUringEngine::open()
+{
+    if (nullptr != ring_) { return true; }
+
+#ifdef ENABLE_GAT_IO_URING
+    std::unique_ptr<io_uring> ring(new io_uring);
+    int const result = io_uring_queue_init(ringEntryCount, ring.get(), 0);
+    if (0 > result)
+    {
+        qWarning() << "io_uring_queue_init() failed: " << errnoToStr(-result);
+        return false;
+    }
+
+    eventFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (-1 == eventFd_ || 0 > io_uring_register_eventfd(ring.get(), eventFd_))
+    {
+        qWarning() << "Unable to signal io_uring completions with an eventfd: " << errnoToStr(errno);
+        if (-1 != eventFd_) { ::close(eventFd_); }
+        eventFd_ = -1;
+        io_uring_queue_exit(ring.get());
+        return false;
+    }
+
+    ring_ = std::move(ring);
+    notifier_ = new QSocketNotifier(eventFd_, QSocketNotifier::Read, this);
+    connect(notifier_, SIGNAL(activated(int)), this, SLOT(onActivated(int)));
+
+    return true;
+#else
+    qWarning("io_uring support was not built (qmake CONFIG += gat_io_uring).");
+    return false;
+#endif // #ifdef ENABLE_GAT_IO_URING
+}
+
+
+void
+GatUringEngine::close()
+{
+    Q_ASSERT(0 == operationsInFlightCount_);
+
+    if (nullptr != notifier_)
+    {
+        notifier_->setEnabled(false);
+        delete notifier_;
+        notifier_ = nullptr;
+    }
+
+#ifdef ENABLE_GAT_IO_URING
+    if (nullptr != ring_)
+    {
+#ifdef DEBUG
+        qDebug("io_uring: %llu submit calls, %llu SQEs, %llu completion passes, %llu CQEs.",
+               static_cast<unsigned long long>(statistics_.submitCallCount_),
+               static_cast<unsigned long long>(statistics_.sqeCount_),
+               static_cast<unsigned long long>(statistics_.completionPassCount_),
+               static_cast<unsigned long long>(statistics_.cqeCount_));
+#endif // #ifdef DEBUG
+        io_uring_unregister_eventfd(ring_.get());
+        io_uring_queue_exit(ring_.get());
+    }
+#endif // #ifdef ENABLE_GAT_IO_URING
+    ring_.reset();
+    unsubmittedSqeCount_ = 0;
+    submitScheduled_ = false;
+
+    if (-1 != eventFd_)
+    {
+        ::close(eventFd_);
+        eventFd_ = -1;
+    }
+}
+
+
+/*!
+    Returns 'sqeCount' consecutive submission queue entries (the first is returned), submitting what is queued
+    when the submission queue is too full.
+*/
+io_uring_sqe *
+GatUringEngine::acquireSqe(uint sqeCount)
+{
+#ifdef ENABLE_GAT_IO_URING
+    if (!open()) { return nullptr; }
+
+    if (sqeCount > io_uring_sq_space_left(ring_.get())) { submit(); }
+    if (sqeCount > io_uring_sq_space_left(ring_.get())) { return nullptr; }
+
+    return io_uring_get_sqe(ring_.get());
+#else
+    Q_UNUSED(sqeCount);
+    open(); // Reports that support was not built.
+    return nullptr;
+#endif // #ifdef ENABLE_GAT_IO_URING
+}
+
+
+bool
+GatUringEngine::queuePollAndRead(int fileDescriptor, GatUringOperation &pollOperation,
+                                 GatUringOperation &readOperation, void *buffer, size_t bufferSizeInBytes)
+{
+    Q_ASSERT(!pollOperation.inFlight_ && !readOperation.inFlight_);
+    if (-1 == fileDescriptor || nullptr == buffer || 0 == bufferSizeInBytes) { return false; }
+
+#ifdef ENABLE_GAT_IO_URING
+    // The poll and read must be in the same submission, or the link is broken.
+    io_uring_sqe *pollSqe = acquireSqe(2);
+    if (nullptr == pollSqe) { return false; }
+    io_uring_prep_poll_add(pollSqe, fileDescriptor, POLLIN);
+    io_uring_sqe_set_data(pollSqe, &pollOperation);
+    io_uring_sqe_set_flags(pollSqe, IOSQE_IO_LINK);
+
+    io_uring_sqe *readSqe = io_uring_get_sqe(ring_.get());
+    Q_ASSERT(nullptr != readSqe);
+    io_uring_prep_read(readSqe, fileDescriptor, buffer, static_cast<unsigned>(bufferSizeInBytes), 0);
+    io_uring_sqe_set_data(readSqe, &readOperation);
+
+    pollOperation.inFlight_ = true;
+    readOperation.inFlight_ = true;
+    operationsInFlightCount_ += 2;
+    unsubmittedSqeCount_ += 2;
+    scheduleSubmit();
+
+    return true;
+#else
+    Q_UNUSED(pollOperation);
+    Q_UNUSED(readOperation);
+    acquireSqe(); // Reports that support was not built.
+    return false;
+#endif // #ifdef ENABLE_GAT_IO_URING
+}
+
+
+bool
+GatUringEngine::queueWrite(int fileDescriptor, GatUringOperation &writeOperation, void const *data,
+                           size_t dataSizeInBytes)
+{
+    Q_ASSERT(!writeOperation.inFlight_);
+    if (-1 == fileDescriptor || nullptr == data || 0 == dataSizeInBytes) { return false; }
+
+#ifdef ENABLE_GAT_IO_URING
+    io_uring_sqe *sqe = acquireSqe();
+    if (nullptr == sqe) { return false; }
+    io_uring_prep_write(sqe, fileDescriptor, data, static_cast<unsigned>(dataSizeInBytes), 0);
+    io_uring_sqe_set_data(sqe, &writeOperation);
+
+    writeOperation.inFlight_ = true;
+    ++operationsInFlightCount_;
+    ++unsubmittedSqeCount_;
+    scheduleSubmit();
+
+    return true;
+#else
+    Q_UNUSED(writeOperation);
+    acquireSqe(); // Reports that support was not built.
+    return false;
+#endif // #ifdef ENABLE_GAT_IO_URING
+}
+
+
+void
+GatUringEngine::cancel(GatUringOperation &operation)
+{
+    if (!operation.inFlight_) { return; }
+
+#ifdef ENABLE_GAT_IO_URING
+    io_uring_sqe *sqe = acquireSqe();
+    if (nullptr != sqe)
+    {
+        io_uring_prep_cancel(sqe, &operation, 0);
+        io_uring_sqe_set_data(sqe, nullptr); // The cancel request's own completion is ignored.
+        ++unsubmittedSqeCount_;
+    }
+#endif // #ifdef ENABLE_GAT_IO_URING
+
+    waitFor(operation);
+}
+
+
+/*!
+    Blocks (the event loop) until 'operation' completes, dispatching every completion that arrives meanwhile.
+    Only used to tear down a port, whose outstanding operations complete promptly once cancelled.
+*/
+void
+GatUringEngine::waitFor(GatUringOperation &operation)
+{
+#ifdef ENABLE_GAT_IO_URING
+    while (operation.inFlight_ && nullptr != ring_)
+    {
+        submit();
+
+        io_uring_cqe *cqe = nullptr;
+        int const result = io_uring_wait_cqe(ring_.get(), &cqe);
+        if (0 > result && -EINTR != result)
+        {
+            qWarning() << "io_uring_wait_cqe() failed: " << errnoToStr(-result);
+            break;
+        }
+
+        reapCompletions();
+    }
+#else
+    Q_UNUSED(operation);
+#endif // #ifdef ENABLE_GAT_IO_URING
+}
+
+
+void
+GatUringEngine::submit()
+{
+#ifdef ENABLE_GAT_IO_URING
+    if (0 == unsubmittedSqeCount_ || nullptr == ring_) { return; }
+
+    int result = 0;
+    do
+    {
+        result = io_uring_submit(ring_.get());
+        ++statistics_.submitCallCount_;
+        if (-EBUSY == result || -EAGAIN == result)
+        {
+            reapCompletions(); // Make room in the completion queue, then retry.
+            result = -EINTR;
+        }
+    } while (-EINTR == result);
+
+    if (0 > result)
+    {
+        qWarning() << "io_uring_submit() failed: " << errnoToStr(-result);
+    }
+    else
+    {
+        statistics_.sqeCount_ += static_cast<quint64>(result);
+        unsubmittedSqeCount_ -= (std::min)(unsubmittedSqeCount_, static_cast<uint>(result));
+    }
+#endif // #ifdef ENABLE_GAT_IO_URING
+}
+
+
+void
+GatUringEngine::scheduleSubmit()
+{
+    if (!submitScheduled_)
+    {
+        // Post an event to this to invoke a DPC that submits everything queued by this pass of the event loop.
+        submitScheduled_ = true;
+        QEvent *event = new QEvent(static_cast<QEvent::Type>(LocalEventType::SubmitPending));
+        QApplication::postEvent(this, event);
+    }
+}
+
+
+/*!
+    Dispatches every completion in the completion queue.  Completions are copied and retired before any handler is
+    called, so handlers may queue (or wait for) more operations.
+*/
+void
+GatUringEngine::reapCompletions()
+{
+#ifdef ENABLE_GAT_IO_URING
+    if (nullptr == ring_) { return; }
+
+    io_uring_cqe *cqes[completionBatchSize];
+    struct Completion {
+        GatUringOperation *operation_;
+        int result_;
+    } completions[completionBatchSize];
+    for (;;)
+    {
+        uint const cqeCount = io_uring_peek_batch_cqe(ring_.get(), cqes, static_cast<unsigned>(arycap(cqes)));
+        for (uint idx = 0; cqeCount > idx; ++idx)
+        {
+            completions[idx].operation_ = static_cast<GatUringOperation *>(io_uring_cqe_get_data(cqes[idx]));
+            completions[idx].result_ = cqes[idx]->res;
+        }
+        io_uring_cq_advance(ring_.get(), cqeCount);
+        statistics_.cqeCount_ += cqeCount;
+
+        for (uint idx = 0; cqeCount > idx; ++idx)
+        {
+            GatUringOperation *operation = completions[idx].operation_;
+            if (nullptr == operation) { continue; } // Cancel request.
+
+            Q_ASSERT(operation->inFlight_ && 0 < operationsInFlightCount_);
+            operation->inFlight_ = false;
+            --operationsInFlightCount_;
+            if (nullptr != operation->handler_)
+            {
+                try { operation->handler_->onUringCompletion(*operation, completions[idx].result_); } catch (...) { qWarning("Unexpected exception caught and discarded in GatUringEngine::reapCompletions(). " STRINGIZE(__LINE__)); }
+            }
+        }
+
+        if (arycap(cqes) > cqeCount) { break; }
+    }
+#endif // #ifdef ENABLE_GAT_IO_URING
+}
+
+
+void
+GatUringEngine::customEvent(QEvent *event)
+{
+    QObject::customEvent(event);
+
+    if (nullptr != event)
+    {
+        if (static_cast<uint>(LocalEventType::SubmitPending) == static_cast<uint>(event->type()))
+        {
+            submitScheduled_ = false;
+            submit();
+        }
+    }
+}
+
+
+/*!
+    The eventfd is readable whenever completions have been posted.  Every completion is dispatched, then every
+    operation the handlers queued (e.g. reads re-armed) is submitted with one system call.
+*/
+void
+GatUringEngine::onActivated(int /*socket*/)
+{
+    uint64_t counter = 0;
+    while (-1 == ::read(eventFd_, &counter, sizeof(counter)) && EINTR == errno) { }
+
+    ++statistics_.completionPassCount_;
+    reapCompletions();
+    submit();
+}
+
+
+GatUringEngine::GatUringEngine(QObject *parent)
+    : QObject(parent)
+    , eventFd_(-1)
+    , notifier_(nullptr)
+    , unsubmittedSqeCount_(0)
+    , operationsInFlightCount_(0)
+    , submitScheduled_(false)
+{
+    memset(&statistics_, 0, sizeof(statistics_));
+    // The ring is created on first use, in the thread that uses it.
+}
+
+
+GatUringEngine::~GatUringEngine()
+{
+    close();
+}
+
+
+/*
+    End of "GatUringEngine.cpp"
+*/
@@ -0,0 +1,152 @@
+/*!
+    \file "GatUringEngine.hpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Batches serial device reads and writes for many ports through one io_uring.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#ifndef GATURINGENGINE_HPP__85CDDA47_9894_4FB7_AAAF_541B508F6AED__INCLUDED
+#define GATURINGENGINE_HPP__85CDDA47_9894_4FB7_AAAF_541B508F6AED__INCLUDED
+
+
+#pragma once
+
+
+#include "Defs.hpp"
+#include <QEvent>
+#include <QObject>
+#include <QSocketNotifier>
+
+
+struct io_uring;
+struct io_uring_sqe;
+struct GatUringOperation;
+
+
+struct GatUringCompletionHandlerInterface
+{
+    virtual void onUringCompletion(GatUringOperation &operation, int result) = 0; //!< 'result' is 'io_uring_cqe::res'.
+};
+
+
+/*!
+    \brief One asynchronous operation (owned by its handler).
+
+    An operation may be queued again only after it has completed.
+*/
+struct GatUringOperation
+{
+    GatUringCompletionHandlerInterface *handler_;
+    bool inFlight_;
+
+    GatUringOperation(GatUringCompletionHandlerInterface *handler) : handler_(handler), inFlight_(false) { }
+};
+
+
+/*!
+    \brief Batches serial device reads and writes for many ports through one io_uring.
+
+    Operations queued while the event loop services one batch of events (timers, completions, etc.) are submitted
+    to the kernel together, by a single system call, when control returns to the event loop.  Completions are
+    signaled through an eventfd that is watched by the Qt event loop (via a QSocketNotifier), and every completion
+    that is ready is dispatched in one pass.  The engine must be used only by the thread that owns it.  The ring is
+    created on first use (in that thread).
+
+    io_uring support is optional (qmake CONFIG += gat_io_uring, which requires liburing).  When it was not built,
+    queueing fails and 'isSupported()' returns false.
+*/
+class GatUringEngine
+    : public QObject
+{
+    Q_OBJECT
+
+    //! \name Operations
+    //! @{
+public:
+    static bool isSupported();
+
+    //! Reads from 'fileDescriptor' when it becomes readable (a poll linked to a read, for non-blocking devices).
+    bool queuePollAndRead(int fileDescriptor, GatUringOperation &pollOperation, GatUringOperation &readOperation,
+                          void *buffer, size_t bufferSizeInBytes);
+    bool queueWrite(int fileDescriptor, GatUringOperation &writeOperation, void const *data, size_t dataSizeInBytes);
+    void cancel(GatUringOperation &operation); //!< Returns once 'operation' is no longer in flight.
+    void waitFor(GatUringOperation &operation); //!< Returns once 'operation' is no longer in flight.
+    void close(); //!< Releases the ring; no operations may be in flight.
+
+private:
+    bool open();
+    io_uring_sqe * acquireSqe(uint sqeCount = 1);
+    void submit();
+    void scheduleSubmit();
+    void reapCompletions();
+
+    std::unique_ptr<io_uring> ring_;
+    int eventFd_;
+    QSocketNotifier *notifier_;
+    uint unsubmittedSqeCount_;
+    uint operationsInFlightCount_;
+    bool submitScheduled_;
+    //! @}
+
+    //! \name Statistics
+    //! @{
+public:
+    struct Statistics
+    {
+        quint64 submitCallCount_; //!< io_uring_enter() calls made to submit.
+        quint64 sqeCount_; //!< Submission queue entries submitted.
+        quint64 completionPassCount_; //!< Completion notifications (wakeups) serviced.
+        quint64 cqeCount_; //!< Completion queue entries dispatched.
+    };
+
+    Statistics const & statistics() const { return statistics_; }
+
+private:
+    Statistics statistics_;
+    //! @}
+
+    //! \name Event Processing
+    //! @{
+protected:
+    enum class LocalEventType : int
+    {
+        SubmitPending = QEvent::User
+    };
+
+    void customEvent(QEvent *event);
+
+protected slots:
+    virtual void onActivated(int socket);
+    //! @}
+
+    //! \name Construction, Destruction, and Assignment
+    //! @{
+public:
+    GatUringEngine(QObject *parent = nullptr);
+    virtual ~GatUringEngine();
+
+private:
+    GatUringEngine(GatUringEngine const&) = delete; //!< No cloning; leave unimplemented!
+    GatUringEngine& operator=(GatUringEngine const&) = delete; //!< No cloning; leave unimplemented!
+    //! @}
+};
+
+
+#endif // #ifndef GATURINGENGINE_HPP__85CDDA47_9894_4FB7_AAAF_541B508F6AED__INCLUDED
+
+
+/*
+    End of "GatUringEngine.hpp"
+*/
@@ -0,0 +1,206 @@
+/*!
+    \file "GatUringSerialPort.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    io_uring serial device transport for the GAT link layer.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatUringSerialPort.hpp"
+#include "GatTermiosSerialPort.hpp"
+#include <errno.h>
+#include <unistd.h>
+
+
+bool
+GatUringSerialPort::open(QString const &serialDevicePathname, GatSerialLineSettings const &lineSettings,
+                         QString &errorDescription)
+{
+    close();
+
+    if (!GatUringEngine::isSupported())
+    {
+        errorDescription = QString("Unable to open serial port \"%1\".\n"
+                                   "io_uring support was not built (qmake CONFIG += gat_io_uring).")
+                           .arg(serialDevicePathname);
+        qWarning() << errorDescription;
+        return false;
+    }
+
+    fd_ = GatTermiosSerialPort::openRawDevice(serialDevicePathname, lineSettings, errorDescription);
+    if (-1 == fd_) { return false; }
+
+    if (!queueRead())
+    {
+        ::close(fd_);
+        fd_ = -1;
+        errorDescription = QString("Unable to queue reads for serial port \"%1\" (io_uring).")
+                           .arg(serialDevicePathname);
+        qWarning() << errorDescription;
+        return false;
+    }
+
+    return true;
+}
+
+
+bool
+GatUringSerialPort::setLineSettings(GatSerialLineSettings const &lineSettings)
+{
+    if (-1 == fd_) { return false; }
+
+    if (!GatTermiosSerialPort::configureRawDevice(fd_, lineSettings))
+    {
+        qWarning() << "Unable to change serial line settings: " << errnoToStr(errno);
+        return false;
+    }
+
+    return true;
+}
+
+
+void
+GatUringSerialPort::close()
+{
+    if (-1 == fd_) { return; }
+
+    // Outstanding operations reference the buffers and the file descriptor, so wait for them to finish.
+    closing_ = true;
+    engine_.cancel(pollOperation_); // The linked read is cancelled with it.
+    engine_.cancel(readOperation_);
+    engine_.waitFor(writeOperation_);
+    closing_ = false;
+
+    ::close(fd_);
+    fd_ = -1;
+    writeOffset_ = writeSize_ = 0;
+}
+
+
+bool
+GatUringSerialPort::queueRead()
+{
+    return engine_.queuePollAndRead(fd_, pollOperation_, readOperation_, readBuffer_, sizeof(readBuffer_));
+}
+
+
+bool
+GatUringSerialPort::queueWrite()
+{
+    Q_ASSERT(writeSize_ > writeOffset_);
+    return engine_.queueWrite(fd_, writeOperation_, writeBuffer_ + writeOffset_, writeSize_ - writeOffset_);
+}
+
+
+uint
+GatUringSerialPort::write(GatLinkLayer & /*host*/, void const *data, uint dataSizeInBytes)
+{
+    if (-1 == fd_ || nullptr == data) { return 0; }
+
+    // The link layer sends one packet per request, with a gap between requests, so the previous packet has
+    // practically always been written already.  Keep packets in order when it has not.
+    if (writeOperation_.inFlight_) { engine_.waitFor(writeOperation_); }
+
+    uint const byteCountToWrite = (std::min)(dataSizeInBytes, static_cast<uint>(sizeof(writeBuffer_)));
+    memcpy(writeBuffer_, data, byteCountToWrite);
+    writeOffset_ = 0;
+    writeSize_ = byteCountToWrite;
+    if (!queueWrite())
+    {
+        writeSize_ = 0;
+        return 0;
+    }
+
+    return byteCountToWrite;
+}
+
+
+void
+GatUringSerialPort::onLinkToHost(GatLinkLayer *host)
+{
+    linkLayer_ = host;
+}
+
+
+void
+GatUringSerialPort::onUringCompletion(GatUringOperation &operation, int result)
+{
+    if (&readOperation_ == &operation)
+    {
+        if (closing_) { return; }
+
+        if (0 < result)
+        {
+            if (nullptr != linkLayer_) { linkLayer_->receiveData(readBuffer_, static_cast<size_t>(result)); }
+        }
+        else if (0 == result)
+        {
+            // The poll reported the device readable but it had nothing to read: it was hung up (e.g. unplugged).
+            qWarning() << "Serial device hung up (read() returned 0); reads stopped.";
+            return;
+        }
+        else if (-EAGAIN != result && -EINTR != result)
+        {
+            qWarning() << "io_uring read failed: " << errnoToStr(-result) << "; reads stopped.";
+            return;
+        }
+
+        if (!queueRead()) { qWarning() << "Unable to re-queue io_uring read; reads stopped."; }
+    }
+    else if (&writeOperation_ == &operation)
+    {
+        if (0 < result)
+        {
+            writeOffset_ += static_cast<uint>(result);
+        }
+        else if (-EAGAIN != result && -EINTR != result)
+        {
+            if (!closing_) { qWarning() << "io_uring write failed: " << errnoToStr(-result); }
+            writeOffset_ = writeSize_;
+        }
+
+        // Finish a short write.
+        if (!closing_ && writeSize_ > writeOffset_ && !queueWrite()) { writeOffset_ = writeSize_; }
+    }
+    else
+    {
+        // Poll completions are of no interest; the linked read reports the outcome.
+    }
+}
+
+
+GatUringSerialPort::GatUringSerialPort(GatUringEngine &engine)
+    : fd_(-1)
+    , closing_(false)
+    , writeOffset_(0)
+    , writeSize_(0)
+    , linkLayer_(nullptr)
+    , engine_(engine)
+    , pollOperation_(this)
+    , readOperation_(this)
+    , writeOperation_(this)
+{
+    // Do nothing.
+}
+
+
+GatUringSerialPort::~GatUringSerialPort()
+{
+    close();
+}
+
+
+/*
+    End of "GatUringSerialPort.cpp"
+*/
@@ -0,0 +1,110 @@
+/*!
+    \file "GatUringSerialPort.hpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    io_uring serial device transport for the GAT link layer.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#ifndef GATURINGSERIALPORT_HPP__86CC9570_873A_4F06_ADA0_8945AC0CB11D__INCLUDED
+#define GATURINGSERIALPORT_HPP__86CC9570_873A_4F06_ADA0_8945AC0CB11D__INCLUDED
+
+
+#pragma once
+
+
+#include "Defs.hpp"
+#include "GatLinkLayer.hpp"
+#include "GatSerialLineSettings.hpp"
+#include "GatUringEngine.hpp"
+
+
+/*!
+    \brief io_uring serial device transport for the GAT link layer.
+
+    The device is opened and configured exactly like 'GatTermiosSerialPort', but reads and writes are queued on the
+    host's io_uring engine, which submits the I/O of every port in batches and completes it in one pass.  A read is
+    always outstanding (a poll linked to a read, because the device is non-blocking), and it is re-armed when it
+    completes.  Received data is passed to the link layer via 'GatLinkLayer::receiveData()'.
+
+    'write()' copies the packet and queues it, so it reports the whole packet as written; it is sent by the next
+    submission (when control returns to the event loop).
+*/
+class GatUringSerialPort
+    : public GatLinkLayerStrategyInterface
+    , public GatUringCompletionHandlerInterface
+{
+    //! \name Device
+    //! @{
+public:
+    bool open(QString const &serialDevicePathname, GatSerialLineSettings const &lineSettings,
+              QString &errorDescription);
+    bool setLineSettings(GatSerialLineSettings const &lineSettings); //!< Changes the settings of the open device.
+    void close();
+    bool isOpen() const { return -1 != fd_; }
+    int handle() const { return fd_; }
+
+private:
+    bool queueRead();
+    bool queueWrite();
+
+    int fd_;
+    bool closing_;
+    uint8_t readBuffer_[GAT_MAX_PACKET_SIZE];
+    uint8_t writeBuffer_[GAT_MAX_PACKET_SIZE];
+    uint writeOffset_;
+    uint writeSize_;
+    //! @}
+
+    //! \name GatLinkLayerStrategyInterface
+    //! @{
+public:
+    virtual uint write(GatLinkLayer &host, void const *data, uint dataSizeInBytes);
+    virtual void onLinkToHost(GatLinkLayer *host);
+
+private:
+    GatLinkLayer *linkLayer_;
+    //! @}
+
+    //! \name GatUringCompletionHandlerInterface
+    //! @{
+public:
+    virtual void onUringCompletion(GatUringOperation &operation, int result);
+
+private:
+    GatUringEngine &engine_;
+    GatUringOperation pollOperation_;
+    GatUringOperation readOperation_;
+    GatUringOperation writeOperation_;
+    //! @}
+
+    //! \name Construction, Destruction, and Assignment
+    //! @{
+public:
+    GatUringSerialPort(GatUringEngine &engine);
+    virtual ~GatUringSerialPort();
+
+private:
+    GatUringSerialPort(GatUringSerialPort const&) = delete; //!< No cloning; leave unimplemented!
+    GatUringSerialPort& operator=(GatUringSerialPort const&) = delete; //!< No cloning; leave unimplemented!
+    //! @}
+};
+
+
+#endif // #ifndef GATURINGSERIALPORT_HPP__86CC9570_873A_4F06_ADA0_8945AC0CB11D__INCLUDED
+
+
+/*
+    End of "GatUringSerialPort.hpp"
+*/
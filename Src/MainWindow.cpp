@@ -24,13 +24,12 @@
 #include "GatCmdSpec.hpp"
 #include "SelectSerialPortDlg.hpp"
 #include "GatPkt_StatusQueryRslt_SR81.hpp"
+#include "GatPktCodec.hpp"
 #include <QHBoxLayout>
 #include <QFontMetrics>
 #include <QScrollBar>
 #include <QMessageBox>
 #include <QtSerialPort/QSerialPortInfo>
-#include <QDomDocument>
-#include <QDomNodeList>
 
 
 int const specialFunctionsIndex = 0;        // Tab UI widget index.
@@ -41,8 +40,6 @@ int const logIndex = 2;                     // Tab UI widget index.
 QString
 StatusQueryCmd::gatSpecialFunctionName() const
 {
-    //QMutexLocker syncDomainLock(SyncDomainGuard());
-
     return "Status Query (SQ 0x01)";
 }
 
@@ -50,16 +47,13 @@ StatusQueryCmd::gatSpecialFunctionName() const
 void
 StatusQueryCmd::onCmdStateChanged()
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
-    GatHostCmd::onCmdStateChanged();
+    GatHostStatusQueryCmd::onCmdStateChanged();
 
     switch (cmdState())
     {
         case CmdState::Started:
         {
-            // Send request.
-            sendRequest(GatRqst::SQ_01);
+            // Do nothing.  The request is (or was) sent by the port's status query coalescer.
             break;
         }
 
@@ -88,7 +82,7 @@ StatusQueryCmd::onCmdStateChanged()
 
 
 StatusQueryCmd::StatusQueryCmd(MainWindow &mainWindow, GatHost &host)
-    : GatHostCmd(host)
+    : GatHostStatusQueryCmd(host)
     , mainWindow_(mainWindow)
 {
     // Do nothing.
@@ -101,8 +95,6 @@ StatusQueryCmd::StatusQueryCmd(MainWindow &mainWindow, GatHost &host)
 QString
 LastAuthStatusQueryCmd::gatSpecialFunctionName() const
 {
-    //QMutexLocker syncDomainLock(SyncDomainGuard());
-
     return "Last Authentication Status Query (LASQ 0x02)";
 }
 
@@ -110,8 +102,6 @@ LastAuthStatusQueryCmd::gatSpecialFunctionName() const
 void
 LastAuthStatusQueryCmd::onCmdStateChanged()
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
     GatHostCmd::onCmdStateChanged();
 
     switch (cmdState())
@@ -151,7 +141,7 @@ LastAuthStatusQueryCmd::LastAuthStatusQueryCmd(MainWindow &mainWindow, GatHost &
     : GatHostCmd(host)
     , mainWindow_(mainWindow)
 {
-    // Do nothing.
+    setPriority(Priority::High);
 }
 
 
@@ -161,8 +151,6 @@ LastAuthStatusQueryCmd::LastAuthStatusQueryCmd(MainWindow &mainWindow, GatHost &
 void
 GetSpecialFunctionsCmd::onCmdStateChanged()
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
     GatHostGetSpecialFunctionsCmd::onCmdStateChanged();
 
     switch (cmdState())
@@ -188,18 +176,36 @@ GetSpecialFunctionsCmd::onCmdStateChanged()
 
         case CmdState::Completed:
         {
-            mainWindow_.setResult_GetSpecialFunctions(this, lastGatOpResult());
+            mainWindow_.setResult_GetSpecialFunctions(this, decoder_.text(),
+                                                      decoder_.isComplete() ? QString() : decoder_.errorString());
             break;
         }
     }
 }
 
 
-GetSpecialFunctionsCmd::GetSpecialFunctionsCmd(MainWindow &mainWindow, GatHost &host)
+void
+GetSpecialFunctionsCmd::onSpecialFunction(QStringList const &functionDefinition)
+{
+    mainWindow_.addSpecialFunction(this, functionDefinition);
+}
+
+
+void
+GetSpecialFunctionsCmd::onCalculationProgress(GatSpecialFunctionExec * /*host*/, uint elapsedInMilliseconds,
+                                              uint expectedInMilliseconds)
+{
+    mainWindow_.setCalculationProgress(this, elapsedInMilliseconds, expectedInMilliseconds);
+}
+
+
+GetSpecialFunctionsCmd::GetSpecialFunctionsCmd(MainWindow &mainWindow, GatHost &host,
+                                               GatSpecialFunctionsDecoder::Encoding encoding)
     : GatHostGetSpecialFunctionsCmd(host)
     , mainWindow_(mainWindow)
+    , decoder_(encoding, std::bind(&GetSpecialFunctionsCmd::onSpecialFunction, this, std::placeholders::_1))
 {
-    // Do nothing.
+    gatSpecialFunctionExec().setFrameSink(&decoder_);
 }
 
 
@@ -209,8 +215,6 @@ GetSpecialFunctionsCmd::GetSpecialFunctionsCmd(MainWindow &mainWindow, GatHost &
 void
 getComponentCmd::onCmdStateChanged()
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
     GatHostGetComponentCmd::onCmdStateChanged();
 
     switch (cmdState())
@@ -243,6 +247,14 @@ getComponentCmd::onCmdStateChanged()
 }
 
 
+void
+getComponentCmd::onCalculationProgress(GatSpecialFunctionExec * /*host*/, uint elapsedInMilliseconds,
+                                       uint expectedInMilliseconds)
+{
+    mainWindow_.setCalculationProgress(this, elapsedInMilliseconds, expectedInMilliseconds);
+}
+
+
 getComponentCmd::getComponentCmd(MainWindow &mainWindow, GatHost &host,
                                  QString const &componentName, QStringList const *params)
     : GatHostGetComponentCmd(host, componentName, params)
@@ -258,8 +270,6 @@ getComponentCmd::getComponentCmd(MainWindow &mainWindow, GatHost &host,
 void
 GetFileCmd::onCmdStateChanged()
 {
-    QMutexLocker syncDomainLock(syncDomainGuard());
-
     GatHostGetFileCmd::onCmdStateChanged();
 
     switch (cmdState())
@@ -292,6 +302,14 @@ GetFileCmd::onCmdStateChanged()
 }
 
 
+void
+GetFileCmd::onCalculationProgress(GatSpecialFunctionExec * /*host*/, uint elapsedInMilliseconds,
+                                  uint expectedInMilliseconds)
+{
+    mainWindow_.setCalculationProgress(this, elapsedInMilliseconds, expectedInMilliseconds);
+}
+
+
 GetFileCmd::GetFileCmd(MainWindow &mainWindow, GatHost &host, QString const &componentName, QStringList const *params)
     : GatHostGetFileCmd(host, componentName, params)
     , mainWindow_(mainWindow)
@@ -342,18 +360,25 @@ MainWindow::setResult_StatusQuery_Dpc(GatHostCmd *command, QByteArray const &res
                     << "Last Authentication Results " << (statusQueryResult.authResultsReady() ? "A" : "Una") << "vailable" << endl
                     << "Current Calculation: " << calculationStatusNames[static_cast<size_t>(statusQueryResult.calculationStatus())] << endl
                     << "Data Formats: ";
-                if (statusQueryResult.dataFormats().empty()) { oss << "<none>"; }
-                for (GatPkt_StatusQueryRslt_SR81::data_formats_type::const_iterator iter = statusQueryResult.dataFormats().begin();
-                     statusQueryResult.dataFormats().end() != iter;
-                     ++iter)
+                GatPkt_StatusQueryRslt_SR81::data_formats_type unrecognized = statusQueryResult.dataFormats();
+                if (0 == unrecognized) { oss << "<none>"; }
+                char const *separator = "";
+                if (statusQueryResult.hasDataFormat(GatDataFormat::PlainText))
                 {
-                    if (statusQueryResult.dataFormats().begin() != iter) { oss << ", "; }
-                    switch (*iter)
-                    {
-                        case GatDataFormat::PlainText: oss << "Plain text (0x01)"; break;
-                        case GatDataFormat::Xml: oss << "XML (0x02)"; break;
-                        default: oss << "Unrecognized (0x" << hex << uppercase << setw(2) << setfill('0') << ")"; break;
-                    }
+                    oss << separator << "Plain text (0x01)";
+                    separator = ", ";
+                    unrecognized &= ~gatDataFormatIdToCode(GatDataFormat::PlainText);
+                }
+                if (statusQueryResult.hasDataFormat(GatDataFormat::Xml))
+                {
+                    oss << separator << "XML (0x02)";
+                    separator = ", ";
+                    unrecognized &= ~gatDataFormatIdToCode(GatDataFormat::Xml);
+                }
+                if (0 != unrecognized)
+                {
+                    oss << separator << "Unrecognized (0x" << hex << uppercase << setw(2) << setfill('0') << unrecognized
+                        << ")";
                 }
                 oss << endl;
             }
@@ -394,13 +419,11 @@ MainWindow::setResult_LastAuthStatusQuery_Dpc(GatHostCmd *command, QByteArray co
 
     try
     {
-        if (9 == result.size() && 9 == result[1])
+        GatPktView_LASR const lastAuthStatus(result.constData(), result.size());
+        if (lastAuthStatus.isValid())
         {
-            uint const authLevel = static_cast<unsigned char>(result[2]);
-            uint_least32_t const secondsSinceLastCalculation = static_cast<uint_least32_t>(result[3]) << 24 |
-                                                               static_cast<uint_least32_t>(result[4]) << 16 |
-                                                               static_cast<uint_least32_t>(result[5]) <<  8 |
-                                                               static_cast<uint_least32_t>(result[6]) <<  0;
+            uint const authLevel = lastAuthStatus.authLevel();
+            uint_least32_t const secondsSinceLastCalculation = lastAuthStatus.secondsSinceLastCalculation();
             oss << "Authentication Level: " << hex << setw(2) << setfill('0') << authLevel << endl
                 << "Time: " << dec << secondsSinceLastCalculation << endl;
         }
@@ -421,71 +444,60 @@ MainWindow::setResult_LastAuthStatusQuery_Dpc(GatHostCmd *command, QByteArray co
 
 
 void
-MainWindow::setResult_GetSpecialFunctions(GatHostCmd *command, const QByteArray &result)
+MainWindow::addSpecialFunction(GatHostCmd *command, QStringList const &functionDefinition)
 {
-    scheduleDpc(std::bind(&MainWindow::setResult_GetSpecialFunctions_Dpc, this, command, result));
+    scheduleDpc(std::bind(&MainWindow::addSpecialFunction_Dpc, this, command, functionDefinition));
 }
 
 
 void
-MainWindow::setResult_GetSpecialFunctions_Dpc(GatHostCmd *command, const QByteArray &result)
+MainWindow::addSpecialFunction_Dpc(GatHostCmd *command, QStringList const &functionDefinition)
 {
     // Do nothing when this is not from the active command.
     if (activeGatCmd_.get() != command) { return; }
-    GatHost::gat_host_cmd_ptr_type gatCmdInProgress(activeGatCmd_);
-    activeGatCmd_ = nullptr;
 
-    bool const isUtf16 = ui->rdoXmlAuto->isChecked()
-                         ? (2 <= result.size() && (!isprint(result[0]) || !isprint(result[1])))
-                         : ui->rdoXmlUtf16->isChecked();
-
-    QString resultText(isUtf16 ? QString::fromUtf16(reinterpret_cast<ushort const *>(result.data()))
-                               : QString::fromUtf8(reinterpret_cast<char const *>(result.data())));
+    specialFunctionDefs_.push_back(functionDefinition);
+    specialFunctionColumnCount_ = (std::max)(specialFunctionColumnCount_, static_cast<uint>(functionDefinition.size()));
+    appendSpecialFunctionsViewRow(functionDefinition);
 
-    populateOperationResults(resultText);
+    // Show the first function as soon as it arrives.
+    if (1 == specialFunctionDefs_.size() && logIndex != ui->tabWidget->currentIndex())
+    {
+        ui->tabWidget->setCurrentIndex(specialFunctionsIndex);
+    }
+}
 
-    typedef QList<QStringList> TStringsColl;
-    TStringsColl functionDefs;
-    uint columnCount = 0;
 
-    try
-    {
-        QDomDocument doc; // See: http://doc.qt.digia.com/qt/qdomdocument.html
-        doc.setContent(resultText);
-        QDomNodeList specialFunctionsNodes(doc.elementsByTagName("SpecialFunctions"));
-        if (specialFunctionsNodes.isEmpty()) { throw int(-1); }
-        QDomNode specialFunctionsNode(specialFunctionsNodes.at(0));
-        for (QDomElement element(specialFunctionsNode.firstChildElement("Function"));
-             !element.isNull();
-             element = element.nextSiblingElement("Function"))
-        {
-            QDomElement feature(element.firstChildElement("Feature"));
-            if (feature.isNull()) { throw int(-1); }
+void
+MainWindow::setResult_GetSpecialFunctions(GatHostCmd *command, QString const &resultText, QString const &errorText)
+{
+    scheduleDpc(std::bind(&MainWindow::setResult_GetSpecialFunctions_Dpc, this, command, resultText, errorText));
+}
 
-            QStringList stringList;
-            stringList.push_back(feature.text());
 
-            for (QDomElement parameter(element.firstChildElement("Parameter"));
-                 !parameter.isNull();
-                 parameter = parameter.nextSiblingElement("Parameter"))
-            {
-                stringList.push_back(parameter.text());
-            }
+void
+MainWindow::setResult_GetSpecialFunctions_Dpc(GatHostCmd *command, QString const &resultText,
+                                              QString const &errorText)
+{
+    // Do nothing when this is not from the active command.
+    if (activeGatCmd_.get() != command) { return; }
+    GatHost::gat_host_cmd_ptr_type gatCmdInProgress(activeGatCmd_);
+    activeGatCmd_ = nullptr;
 
-            functionDefs.push_back(stringList);
-            columnCount = (std::max)(columnCount, static_cast<uint>(stringList.size()));
-        }
+    populateOperationResults(resultText);
 
-        initSpecialFunctionsView(functionDefs, columnCount);
-        populateSpecialFunctionsView(functionDefs);
-        if (logIndex != ui->tabWidget->currentIndex()) { ui->tabWidget->setCurrentIndex(specialFunctionsIndex); }
-    }
-    catch (...)
+    if (!errorText.isEmpty())
     {
         activeGatCmd_ = gatCmdInProgress;
-        operationFailed_Dpc(command, "Get Special Functions", "Bad XML data received from GM.", resultText);
+        operationFailed_Dpc(command, "Get Special Functions", "Bad XML data received from GM (" + errorText + ").",
+                            resultText);
         return;
     }
+
+    // The rows were added as the functions arrived; now fit the columns to them and sort them.
+    initSpecialFunctionsView(specialFunctionDefs_, specialFunctionColumnCount_);
+    populateSpecialFunctionsView(specialFunctionDefs_);
+    if (logIndex != ui->tabWidget->currentIndex()) { ui->tabWidget->setCurrentIndex(specialFunctionsIndex); }
 }
 
 
@@ -539,6 +551,33 @@ MainWindow::setResult_GetFile_Dpc(GatHostCmd *command, const QByteArray &result)
 }
 
 
+void
+MainWindow::setCalculationProgress(GatHostCmd *command, uint elapsedInMilliseconds, uint expectedInMilliseconds)
+{
+    scheduleDpc(std::bind(&MainWindow::setCalculationProgress_Dpc, this, command, elapsedInMilliseconds,
+                          expectedInMilliseconds));
+}
+
+
+void
+MainWindow::setCalculationProgress_Dpc(GatHostCmd *command, uint elapsedInMilliseconds, uint expectedInMilliseconds)
+{
+    // Do nothing when this is not from the active command.
+    if (activeGatCmd_.get() != command) { return; }
+
+    // The expectation is the median duration of such calculations on GMs of this GAT version (see
+    // 'GatCalcDurationModel').
+    QString messageText(QString("Executing: %1 (calculating %2 s").arg(command->gatSpecialFunctionName())
+                                                                .arg(elapsedInMilliseconds / 1000u));
+    if (expectedInMilliseconds > elapsedInMilliseconds)
+    {
+        uint const remainingInSeconds = (expectedInMilliseconds - elapsedInMilliseconds + 999u) / 1000u;
+        messageText += QString(", about %1 s to go").arg(remainingInSeconds);
+    }
+    ui->statusBar->showMessage(messageText + ")");
+}
+
+
 void
 MainWindow::operationFailed(GatHostCmd *command, QString const &specialFuncionName,
                             QString const &description, const QString &operationResultDescription)
@@ -724,6 +763,32 @@ MainWindow::onRxPacket(GatLinkLayer * /*host*/, QByteArray pktData, bool invalid
 }
 
 
+void
+MainWindow::onBaudRateDetected(GatPort *port, uint baudRate, bool detected)
+{
+    QString const pathname(nullptr != port ? port->serialDevicePathname() : QString());
+    writeToLog(QString("<font color=\"%1\">Auto-baud: %2 at %3 baud (\"%4\").</font>")
+               .arg(detected ? "green" : "red")
+               .arg(detected ? "GM found" : "GM not found; using")
+               .arg(baudRate)
+               .arg(pathname));
+}
+
+
+void
+MainWindow::onLowLatencyReport(GatPort *port, uint roundTripBeforeInMicroseconds, uint roundTripAfterInMicroseconds,
+                               QString changes)
+{
+    QString const pathname(nullptr != port ? port->serialDevicePathname() : QString());
+    writeToLog(QString("<font color=\"purple\">Low latency mode (\"%1\"): %2; SQ round trip %3us before, %4us after."
+                       "</font>")
+               .arg(pathname)
+               .arg(changes)
+               .arg(roundTripBeforeInMicroseconds)
+               .arg(roundTripAfterInMicroseconds));
+}
+
+
 void
 MainWindow::syncUiWidgets()
 {
@@ -904,6 +969,23 @@ MainWindow::populateSpecialFunctionsView(QList<QStringList> const &functionDefin
 }
 
 
+void
+MainWindow::appendSpecialFunctionsViewRow(QStringList const &functionDefinition)
+{
+    ui->tableWidget->setSortingEnabled(false); // Until the last row (see 'populateSpecialFunctionsView()').
+
+    int const rowIdx = ui->tableWidget->rowCount();
+    ui->tableWidget->setRowCount(rowIdx + 1);
+    ui->tableWidget->setColumnCount((std::max)(ui->tableWidget->columnCount(), functionDefinition.size()));
+    for (int colIdx = 0; functionDefinition.size() > colIdx; ++colIdx)
+    {
+        QTableWidgetItem *twi = nullptr;
+        ui->tableWidget->setItem(rowIdx, colIdx, (twi = new QTableWidgetItem(functionDefinition[colIdx])));
+        twi->setFlags(twi->flags() & ~Qt::ItemIsEditable);
+    }
+}
+
+
 /*!
    \brief Cancels command in progress (if any) and schedules a new one.
    \param apNewCommand Command to schedule.
@@ -918,7 +1000,9 @@ MainWindow::scheduleGatCommand(GatHost::gat_host_cmd_ptr_type newCommand)
 
     try
     {
-        // Schedule new command.
+        // Schedule new command.  This window shows one operation at a time, so it replaces the ones scheduled
+        // from here before (which other clients' commands do not).
+        newCommand->setSchedulingFlags(GatHostCmd::Preempts | GatHostCmd::Preemptible);
         activeGatCmd_ = newCommand;
         if (nullptr != activeGatCmd_)
         {
@@ -1002,7 +1086,16 @@ MainWindow::on_actionShowSerialDevices_triggered()
 void
 MainWindow::on_actionGetSpecialFunctions_triggered()
 {
-    GatHost::gat_host_cmd_ptr_type newCmd(new GetSpecialFunctionsCmd(*this, gatHost_));
+    GatSpecialFunctionsDecoder::Encoding const encoding = ui->rdoXmlAuto->isChecked()
+                                                          ? GatSpecialFunctionsDecoder::Encoding::Auto
+                                                          : ui->rdoXmlUtf16->isChecked()
+                                                            ? GatSpecialFunctionsDecoder::Encoding::Utf16
+                                                            : GatSpecialFunctionsDecoder::Encoding::Utf8;
+
+    specialFunctionDefs_.clear();
+    specialFunctionColumnCount_ = 0;
+
+    GatHost::gat_host_cmd_ptr_type newCmd(new GetSpecialFunctionsCmd(*this, gatHost_, encoding));
     if (!scheduleGatCommand(newCmd))
     {
         QErrMsgBox("Failed to schedule " + newCmd->gatSpecialFunctionName() + ".", this);
@@ -1221,6 +1314,7 @@ MainWindow::on_actionAboutApplication_triggered()
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , specialFunctionColumnCount_(0)
     , ioLogMsgSerialNumber_(0)
 {
     ui->setupUi(this);
@@ -1238,6 +1332,10 @@ MainWindow::MainWindow(QWidget *parent)
             this, SLOT(onRxD(GatLinkLayer *, QByteArray)));
     connect(&gatHost_.gatLinkLayer(), SIGNAL(onReceivePacket(GatLinkLayer *, QByteArray, bool)),
             this, SLOT(onRxPacket(GatLinkLayer *, QByteArray, bool)));
+    connect(&gatHost_.port(0), SIGNAL(baudRateDetected(GatPort *, uint, bool)),
+            this, SLOT(onBaudRateDetected(GatPort *, uint, bool)));
+    connect(&gatHost_.port(0), SIGNAL(lowLatencyReport(GatPort *, uint, uint, QString)),
+            this, SLOT(onLowLatencyReport(GatPort *, uint, uint, QString)));
 
     // Select a default serial port (if one is available and not already selected).
     if (ui->serialDeviceEdit->text().trimmed().isEmpty())
@@ -23,6 +23,7 @@
 
 #include "Defs.hpp"
 #include "GatHost.hpp"
+#include "GatSpecialFunctionsDecoder.hpp"
 #include <QMainWindow>
 #include <QTableWidgetItem>
 
@@ -40,9 +41,11 @@ class MainWindow
 public:
     void setResult_StatusQuery(GatHostCmd *command, QByteArray const &result);
     void setResult_LastAuthStatusQuery(GatHostCmd *command, QByteArray const &result);
-    void setResult_GetSpecialFunctions(GatHostCmd *command, QByteArray const &result);
+    void addSpecialFunction(GatHostCmd *command, QStringList const &functionDefinition);
+    void setResult_GetSpecialFunctions(GatHostCmd *command, QString const &resultText, QString const &errorText);
     void setResult_GetComponent(GatHostCmd *command, QByteArray const &result);
     void setResult_GetFile(GatHostCmd *command, const QByteArray &result);
+    void setCalculationProgress(GatHostCmd *command, uint elapsedInMilliseconds, uint expectedInMilliseconds);
     void operationFailed(GatHostCmd *command, QString const &specialFuncionName, QString const &description,
                          QString const &operationResultDescription);
 
@@ -97,14 +100,17 @@ protected:
 private:
     void setResult_StatusQuery_Dpc(GatHostCmd *command, QByteArray const &result);
     void setResult_LastAuthStatusQuery_Dpc(GatHostCmd *command, QByteArray const &result);
-    void setResult_GetSpecialFunctions_Dpc(GatHostCmd *command, QByteArray const &result);
+    void addSpecialFunction_Dpc(GatHostCmd *command, QStringList const &functionDefinition);
+    void setResult_GetSpecialFunctions_Dpc(GatHostCmd *command, QString const &resultText, QString const &errorText);
     void setResult_GetComponent_Dpc(GatHostCmd *command, QByteArray const &result);
     void setResult_GetFile_Dpc(GatHostCmd *command, QByteArray const &result);
+    void setCalculationProgress_Dpc(GatHostCmd *command, uint elapsedInMilliseconds, uint expectedInMilliseconds);
     void operationFailed_Dpc(GatHostCmd *command, QString const &specialFunctionName, QString const &description,
                              QString const &operationResultDescription);
 
     void initSpecialFunctionsView(QList<QStringList> const &functionDefinitions, uint columns);
     void populateSpecialFunctionsView(QList<QStringList> const &functionDefinitions);
+    void appendSpecialFunctionsViewRow(QStringList const &functionDefinition);
 
     bool scheduleGatCommand(GatHost::gat_host_cmd_ptr_type newCommand);
 
@@ -123,6 +129,9 @@ private slots:
     void onTxPacket(GatLinkLayer *host, QByteArray pktData);
     void onRxD(GatLinkLayer *host, QByteArray rawData);
     void onRxPacket(GatLinkLayer *host, QByteArray pktData, bool invalidPkt);
+    void onBaudRateDetected(GatPort *port, uint baudRate, bool detected);
+    void onLowLatencyReport(GatPort *port, uint roundTripBeforeInMicroseconds, uint roundTripAfterInMicroseconds,
+                            QString changes);
 
     void on_actionOpenSerialDevice_triggered();
     void on_actionExitApplication_triggered();
@@ -145,6 +154,8 @@ private:
     Ui::MainWindow *ui;
     GatHost gatHost_;
     GatHost::gat_host_cmd_ptr_type activeGatCmd_;
+    QList<QStringList> specialFunctionDefs_; // Of the active "Get Special Functions" command, as they arrive.
+    uint specialFunctionColumnCount_;
     uint ioLogMsgSerialNumber_;
     int edtIoLogLineHeight_;
     int edtLogTextLineHeight_;
@@ -157,7 +168,7 @@ private:
 // This is being placed in the header only to simplify interaction with moc,
 // which expects declarations in headers and not cpp files.
 class StatusQueryCmd
-    : public GatHostCmd
+    : public GatHostStatusQueryCmd
 {
     Q_OBJECT
 
@@ -200,13 +211,18 @@ class GetSpecialFunctionsCmd
     Q_OBJECT
 
 public:
-    GetSpecialFunctionsCmd(MainWindow &mainWindow, GatHost &host);
+    GetSpecialFunctionsCmd(MainWindow &mainWindow, GatHost &host, GatSpecialFunctionsDecoder::Encoding encoding);
 
 protected:
     virtual void onCmdStateChanged();
+    virtual void onCalculationProgress(GatSpecialFunctionExec *host, uint elapsedInMilliseconds,
+                                       uint expectedInMilliseconds);
 
 private:
+    void onSpecialFunction(QStringList const &functionDefinition); //!< GAT I/O thread.
+
     MainWindow &mainWindow_;
+    GatSpecialFunctionsDecoder decoder_; // Frame sink of the reply; decodes as it arrives.
 };
 
 
@@ -222,6 +238,8 @@ public:
 
 protected:
     virtual void onCmdStateChanged();
+    virtual void onCalculationProgress(GatSpecialFunctionExec *host, uint elapsedInMilliseconds,
+                                       uint expectedInMilliseconds);
 
 private:
     MainWindow &mainWindow_;
@@ -240,6 +258,8 @@ public:
 
 protected:
     virtual void onCmdStateChanged();
+    virtual void onCalculationProgress(GatSpecialFunctionExec *host, uint elapsedInMilliseconds,
+                                       uint expectedInMilliseconds);
 
 private:
     MainWindow &mainWindow_;
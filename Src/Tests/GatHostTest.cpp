@@ -0,0 +1,416 @@
+/*!
+    \file "GatHostTest.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Tests of GatHost against a simulated GM on a pseudo terminal (the port opens the slave like any serial device).
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatHost.hpp"
+#include "GatPktCodec.hpp"
+#include <QCoreApplication>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <pty.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+
+uint const cmdTimeoutInMilliseconds = 5000; // Far beyond any GAT deadline.
+
+
+/*!
+    \brief Simulated GM on the master side of a pseudo terminal.
+
+    Answers SQ with an idle SR, and IACQ with an IACR that echoes the request's payload (so a command can tell its
+    own reply from another's), each 'replyDelayInMilliseconds()' after the request; or, while silent, nothing.
+*/
+class FakeGm
+{
+public:
+    bool open();
+    void close();
+    QString serialDevicePathname() const { return serialDevicePathname_; }
+
+    typedef std::chrono::steady_clock clock_type;
+    typedef std::vector<clock_type::time_point> time_points_type;
+
+    void setReplyDelayInMilliseconds(uint value) { replyDelayInMilliseconds_ = value; }
+    void setSilent(bool value) { silent_ = value; }
+    uint requestCount() const { return requestCount_; }
+    bool waitForRequestCount(uint count, uint timeoutInMilliseconds);
+    time_points_type requestTimes(); //!< When each request was received (in order).
+
+    FakeGm();
+    ~FakeGm();
+
+private:
+    void run();
+    void reply(uint8_t const *request);
+
+    int masterFd_;
+    int slaveFd_; // Held open so the pseudo terminal survives the port closing it.
+    QString serialDevicePathname_;
+    std::atomic<uint> replyDelayInMilliseconds_;
+    std::atomic<bool> silent_;
+    std::atomic<uint> requestCount_;
+    time_points_type requestTimes_;
+    std::atomic<bool> stop_;
+    std::mutex guard_;
+    std::condition_variable requestReceived_;
+    std::thread thread_;
+};
+
+
+bool
+FakeGm::open()
+{
+    char slaveName[128];
+    if (0 != openpty(&masterFd_, &slaveFd_, slaveName, nullptr, nullptr)) { return false; }
+
+    termios tty;
+    if (0 != tcgetattr(slaveFd_, &tty)) { return false; }
+    cfmakeraw(&tty);
+    if (0 != tcsetattr(slaveFd_, TCSANOW, &tty)) { return false; }
+
+    serialDevicePathname_ = QString::fromLocal8Bit(slaveName);
+    stop_ = false;
+    thread_ = std::thread(&FakeGm::run, this);
+    return true;
+}
+
+
+void
+FakeGm::close()
+{
+    stop_ = true;
+    if (thread_.joinable()) { thread_.join(); }
+    if (0 <= slaveFd_) { ::close(slaveFd_); }
+    if (0 <= masterFd_) { ::close(masterFd_); }
+    slaveFd_ = masterFd_ = -1;
+}
+
+
+bool
+FakeGm::waitForRequestCount(uint count, uint timeoutInMilliseconds)
+{
+    std::unique_lock<std::mutex> lock(guard_);
+    return requestReceived_.wait_for(lock, std::chrono::milliseconds(timeoutInMilliseconds),
+                                     [this, count]() -> bool { return count <= requestCount_; });
+}
+
+
+auto
+FakeGm::requestTimes() -> time_points_type
+{
+    std::lock_guard<std::mutex> lock(guard_);
+    return requestTimes_;
+}
+
+
+void
+FakeGm::run()
+{
+    std::vector<uint8_t> received;
+    while (!stop_)
+    {
+        pollfd pollFd = { masterFd_, POLLIN, 0 };
+        if (0 >= poll(&pollFd, 1, 20)) { continue; }
+
+        uint8_t buffer[GAT_MAX_PACKET_SIZE];
+        ssize_t const byteCount = read(masterFd_, buffer, sizeof(buffer));
+        if (0 >= byteCount) { continue; }
+        clock_type::time_point const receivedAt = clock_type::now();
+        received.insert(received.end(), buffer, buffer + byteCount);
+
+        // Requests are well formed (the host framed them); answer each complete one in turn.
+        while (2 <= received.size() && received[1] <= received.size())
+        {
+            size_t const requestSize = received[1];
+            if (GatPktFrameCodec::overhead > requestSize) { received.clear(); break; }
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+                ++requestCount_;
+                requestTimes_.push_back(receivedAt);
+            }
+            requestReceived_.notify_all();
+            if (!silent_) { reply(&received[0]); }
+            received.erase(received.begin(), received.begin() + requestSize);
+        }
+    }
+}
+
+
+void
+FakeGm::reply(uint8_t const *request)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(replyDelayInMilliseconds_));
+
+    uint8_t packet[GAT_MAX_PACKET_SIZE];
+    size_t packetSize = 0;
+    uint8_t const command = request[0];
+    if (GatRqstCmd::SQ == command)
+    {
+        uint8_t const payload[] = { 0x01, 0x00, 0x00, 0x00 }; // Version 1.00, idle, no data formats.
+        packetSize = GatPktFrameCodec::encode(packet, GatPktDesc_SR::command, payload, sizeof(payload));
+    }
+    else if (GatRqstCmd::IACQ == command)
+    {
+        size_t const payloadSize = request[1] - GatPktFrameCodec::overhead;
+        packetSize = GatPktFrameCodec::encode(packet, static_cast<uint8_t>(command | 0x80),
+                                              request + GatPktFrameCodec::payloadOffset, payloadSize);
+    }
+
+    if (0 < packetSize && static_cast<ssize_t>(packetSize) != write(masterFd_, packet, packetSize))
+    {
+        fprintf(stderr, "FakeGm: write failed\n");
+    }
+}
+
+
+FakeGm::FakeGm()
+    : masterFd_(-1)
+    , slaveFd_(-1)
+    , replyDelayInMilliseconds_(5)
+    , silent_(false)
+    , requestCount_(0)
+    , stop_(true)
+{
+    // Do nothing.
+}
+
+
+FakeGm::~FakeGm()
+{
+    close();
+}
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+/*!
+    \brief Sends one IACQ with the given payload; the reply (the echo of the simulated GM) is its result.
+*/
+class GatHostEchoCmd
+    : public GatHostCmd
+{
+public:
+    virtual void begin()
+    {
+        GatHostCmd::begin();
+        sendRequest(GatRqst::IACQ_04, payload_.constData(), static_cast<uint>(payload_.size()));
+    }
+
+    QByteArray echo() const //!< Payload of the reply.
+    {
+        QByteArray const reply(lastGatOpResult());
+        return reply.mid(GatPktFrameCodec::payloadOffset, reply.size() - static_cast<int>(GatPktFrameCodec::overhead));
+    }
+
+    GatHostEchoCmd(GatHostPrivilegesForGatHostCmdInterface &host, QByteArray const &payload)
+        : GatHostCmd(host)
+        , payload_(payload)
+    {
+        // Do nothing.
+    }
+
+private:
+    QByteArray payload_;
+};
+
+
+// [----------------(120 columns)---------------> Module Code Delimiter <---------------(120 columns)----------------]
+
+
+static bool
+check(bool condition, char const *testName, char const *description)
+{
+    if (!condition) { printf("FAIL %s: %s\n", testName, description); }
+    return condition;
+}
+
+
+static bool
+runStatusQueries(GatHost &host, uint count)
+{
+    for (uint idx = 0; count > idx; ++idx)
+    {
+        GatCmdFuture const future = host.schedule(GatHost::gat_host_cmd_ptr_type(new GatHostStatusQueryCmd(host)));
+        if (!future.wait(cmdTimeoutInMilliseconds)) { return false; }
+        if (GatHostCmd::CmdState::Completed != future.result()) { return false; }
+    }
+    return true;
+}
+
+
+/*!
+    The adaptive reply timeout is a line setting, applied by the port as it opens the device: once the GM has
+    answered enough SQs the first byte deadline is tighter than the GAT deadline used when it is turned off.
+*/
+static bool
+testAdaptiveReplyTimeout()
+{
+    char const *testName = "AdaptiveReplyTimeout";
+    uint const requestSize = GatPktDesc_SQ::minSize;
+    int replyTimeout[2] = { 0, 0 }; // Off, on.
+
+    for (size_t adaptive = 0; arycap(replyTimeout) > adaptive; ++adaptive)
+    {
+        FakeGm gm;
+        if (!check(gm.open(), testName, "no pseudo terminal")) { return false; }
+
+        GatHost host;
+        GatSerialLineSettings lineSettings;
+        lineSettings.adaptiveReplyTimeout_ = 0 != adaptive;
+        host.port(0).setTransport(GatPort::Transport::TermiosEpoll);
+        host.port(0).setLineSettings(lineSettings);
+        host.startup(QStringList() << gm.serialDevicePathname());
+
+        bool const completed = runStatusQueries(host, 32);
+        host.shutdown(true); // The link layer may be read from here on (its thread has ended).
+        if (!check(completed, testName, "status query failed")) { return false; }
+
+        GatLinkLayer const &gatLinkLayer = host.port(0).gatLinkLayer();
+        if (!check(gatLinkLayer.adaptiveReplyTimeout() == lineSettings.adaptiveReplyTimeout_, testName,
+                   "line setting not applied to the link layer")) { return false; }
+        replyTimeout[adaptive] = gatLinkLayer.replyTimeoutInMilliseconds(requestSize);
+    }
+
+    if (!check(replyTimeout[1] < replyTimeout[0], testName, "adaptive timeout is not tighter")) { return false; }
+
+    printf("PASS %s (%d ms, %d ms adaptive)\n", testName, replyTimeout[0], replyTimeout[1]);
+    return true;
+}
+
+
+/*!
+    The GM must get 225 ms from the last byte of a request it does not answer before the next one, even when the
+    adaptive reply deadline is far shorter and the transport (QSerialPort) cannot tell when the request left.
+*/
+static bool
+testSilentGmGap()
+{
+    char const *testName = "SilentGmGap";
+    uint const calibrationCount = 16; // Enough replies that the adaptive deadline is the short one.
+    uint const silentCount = 4;
+    qint64 const minimumGapInMilliseconds = 225;
+
+    FakeGm gm;
+    if (!check(gm.open(), testName, "no pseudo terminal")) { return false; }
+    gm.setReplyDelayInMilliseconds(0);
+
+    GatHost host;
+    host.port(0).setTransport(GatPort::Transport::QtSerialPort);
+    host.startup(QStringList() << gm.serialDevicePathname());
+
+    bool const calibrated = runStatusQueries(host, calibrationCount);
+    uint const firstSilentRequest = gm.requestCount();
+    gm.setSilent(true);
+    bool timedOut = true;
+    for (uint idx = 0; silentCount > idx; ++idx)
+    {
+        GatCmdFuture const future = host.schedule(GatHost::gat_host_cmd_ptr_type(new GatHostStatusQueryCmd(host)));
+        timedOut = future.wait(cmdTimeoutInMilliseconds) && GatHostCmd::CmdState::Completed != future.result() &&
+                   timedOut;
+    }
+    host.shutdown(true);
+
+    if (!check(calibrated, testName, "status query failed")) { return false; }
+    if (!check(timedOut, testName, "status query to the silent GM did not fail")) { return false; }
+
+    FakeGm::time_points_type const requestTimes = gm.requestTimes();
+    if (!check(firstSilentRequest + silentCount <= requestTimes.size(), testName, "requests missing")) { return false; }
+    qint64 shortestGap = std::numeric_limits<qint64>::max();
+    for (size_t idx = firstSilentRequest + 1; requestTimes.size() > idx; ++idx)
+    {
+        qint64 const gap = std::chrono::duration_cast<std::chrono::milliseconds>(requestTimes[idx] -
+                                                                                 requestTimes[idx - 1]).count();
+        shortestGap = (std::min)(shortestGap, gap);
+    }
+    if (!check(minimumGapInMilliseconds <= shortestGap, testName,
+               "request sent too soon after a silent one")) { return false; }
+
+    printf("PASS %s (shortest gap %lld ms)\n", testName, static_cast<long long>(shortestGap));
+    return true;
+}
+
+
+/*!
+    A command canceled (through its future) while the GM is still working on its request: the next command must get
+    the reply to its own request, not the late reply to the canceled one.
+*/
+static bool
+testCancelMidRequest()
+{
+    char const *testName = "CancelMidRequest";
+
+    FakeGm gm;
+    if (!check(gm.open(), testName, "no pseudo terminal")) { return false; }
+    gm.setReplyDelayInMilliseconds(100); // Well within the GAT deadline (the reply is late, not lost).
+
+    GatHost host;
+    host.port(0).setTransport(GatPort::Transport::TermiosEpoll);
+    host.startup(QStringList() << gm.serialDevicePathname());
+
+    std::shared_ptr<GatHostEchoCmd> const first(new GatHostEchoCmd(host, "first"));
+    std::shared_ptr<GatHostEchoCmd> const second(new GatHostEchoCmd(host, "second"));
+    GatCmdFuture const firstFuture = host.schedule(first);
+    bool const requested = gm.waitForRequestCount(1, cmdTimeoutInMilliseconds);
+    firstFuture.cancel();
+    GatCmdFuture const secondFuture = host.schedule(second);
+
+    bool const firstFinished = firstFuture.wait(cmdTimeoutInMilliseconds);
+    bool const secondFinished = secondFuture.wait(cmdTimeoutInMilliseconds);
+    host.shutdown(true);
+
+    if (!check(requested, testName, "first request not received")) { return false; }
+    if (!check(firstFinished && GatHostCmd::CmdState::Canceled == firstFuture.result(), testName,
+               "first command not canceled")) { return false; }
+    if (!check(secondFinished && GatHostCmd::CmdState::Completed == secondFuture.result(), testName,
+               "second command not completed")) { return false; }
+    if (!check("second" == second->echo(), testName, "second command got the reply to the first")) { return false; }
+    if (!check(2 == gm.requestCount(), testName, "unexpected requests")) { return false; }
+
+    printf("PASS %s\n", testName);
+    return true;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+
+    int result = EXIT_SUCCESS;
+    if (!testAdaptiveReplyTimeout()) { result = EXIT_FAILURE; }
+    if (!testSilentGmGap()) { result = EXIT_FAILURE; }
+    if (!testCancelMidRequest()) { result = EXIT_FAILURE; }
+
+    return result;
+}
+
+
+/*
+    End of "GatHostTest.cpp"
+*/
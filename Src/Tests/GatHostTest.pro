@@ -0,0 +1,70 @@
+#-------------------------------------------------
+#
+# GatHost tests against a simulated GM on a pseudo terminal (console; not part of GatHost):
+# qmake && make && ./GatHostTest
+#
+#-------------------------------------------------
+
+QT       += core gui xml
+
+lessThan(QT_MAJOR_VERSION, 5): CONFIG += serialport
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets serialport
+
+TARGET = GatHostTest
+TEMPLATE = app
+CONFIG += console thread
+CONFIG -= app_bundle
+
+QMAKE_CXXFLAGS += -std=c++0x -DDEBUG
+LIBS += -pthread -lutil
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    GatHostTest.cpp \
+    ../GatHost.cpp \
+    ../GatLinkLayer.cpp \
+    ../GatBuffer.cpp \
+    ../GatCoroutine.cpp \
+    ../Defs.cpp \
+    ../GatCrc16.cpp \
+    ../GatMultipktRply.cpp \
+    ../GatSpecialFunctionExec.cpp \
+    ../GatSpecialFunctionsDecoder.cpp \
+    ../GatStatusPollPolicy.cpp \
+    ../GatStatusQueryCoalescer.cpp \
+    ../GatCalcDurationModel.cpp \
+    ../GatPkt_StatusQueryRslt_SR81.cpp \
+    ../GatPktCodec.cpp \
+    ../GatReplyTimingModel.cpp \
+    ../GatSerialLineSettings.cpp \
+    ../GatSerialLowLatency.cpp \
+    ../GatEpollReactor.cpp \
+    ../GatTermiosSerialPort.cpp \
+    ../GatTimerFd.cpp \
+    ../GatUringEngine.cpp \
+    ../GatUringSerialPort.cpp
+
+HEADERS += \
+    ../Defs.hpp \
+    ../GatHost.hpp \
+    ../GatLinkLayer.hpp \
+    ../GatBuffer.hpp \
+    ../GatCoroutine.hpp \
+    ../GatCrc16.hpp \
+    ../GatMultipktRply.hpp \
+    ../GatSpecialFunctionExec.hpp \
+    ../GatSpecialFunctionsDecoder.hpp \
+    ../GatStatusPollPolicy.hpp \
+    ../GatStatusQueryCoalescer.hpp \
+    ../GatCalcDurationModel.hpp \
+    ../GatPkt_StatusQueryRslt_SR81.hpp \
+    ../GatPktCodec.hpp \
+    ../GatReplyTimingModel.hpp \
+    ../GatSerialLineSettings.hpp \
+    ../GatSerialLowLatency.hpp \
+    ../GatEpollReactor.hpp \
+    ../GatTermiosSerialPort.hpp \
+    ../GatTimerFd.hpp \
+    ../GatUringEngine.hpp \
+    ../GatUringSerialPort.hpp
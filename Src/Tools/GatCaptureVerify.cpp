@@ -0,0 +1,91 @@
+/*!
+    \file "GatCaptureVerify.cpp"
+
+    Copyright (c) 2014 Matt Ervin / imp software (matt@impsoftware.org)
+    Formatting: 120 columns, 4 spaces per tab, spaces only (no tab characters)
+    Qt Coding Style: http://qt-project.org/wiki/Qt_Coding_Style
+    Qt Coding Conventions: http://qt-project.org/wiki/Coding-Conventions
+    Doc-tool: Doxygen (http://www.doxygen.com/)
+
+    Command line CRC verification of captured GAT traffic archives.
+
+    ((( GNU General Public License Usage )))
+    This file may be used under the terms of the GNU General Public License version 3.0 as published by
+    the Free Software Foundation and appearing in the file LICENSE included in the packaging of this file.
+    Please review the following information to ensure the GNU General Public License version 3.0 requirements
+    will be met: http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "GatCaptureVerifier.hpp"
+#include "GatCrc16.hpp"
+#include <QElapsedTimer>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+static int
+usage(char const *programName)
+{
+    fprintf(stderr, "Usage: %s [-j <threads>] <capture file>...\n"
+                    "Verifies the CRC of every GAT packet in raw serial line captures, and lists the corrupt regions.\n"
+                    "Exit status: 0 when all are intact, 1 when any is corrupt, 2 on error.\n", programName);
+    return 2;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    uint threadCount = 0; // All cores.
+    int argIdx = 1;
+    if (argc > argIdx + 1 && 0 == strcmp("-j", argv[argIdx]))
+    {
+        threadCount = static_cast<uint>(strtoul(argv[argIdx + 1], nullptr, 10));
+        argIdx += 2;
+    }
+    if (argc <= argIdx) { return usage(argv[0]); }
+
+    printf("CRC-16: %s\n", gatCrc16ImplName(gatCrc16SelectedImpl()));
+
+    int result = EXIT_SUCCESS;
+    for (; argc > argIdx; ++argIdx)
+    {
+        char const *pathname = argv[argIdx];
+        GatCaptureVerifier verifier;
+        QElapsedTimer timer;
+        timer.start();
+        if (!verifier.verifyFile(QString::fromLocal8Bit(pathname), threadCount))
+        {
+            fprintf(stderr, "%s: %s\n", pathname, verifier.errorString().toLocal8Bit().constData());
+            result = 2;
+            continue;
+        }
+        qint64 const nanoseconds = (std::max)(static_cast<qint64>(1), timer.nsecsElapsed());
+
+        GatCaptureVerifier::regions_type const &regions = verifier.corruptRegions();
+        for (GatCaptureVerifier::regions_type::const_iterator region = regions.begin();
+             regions.end() != region;
+             ++region)
+        {
+            printf("%s: offset %llu (0x%llx), %llu bytes: %s\n", pathname,
+                   static_cast<unsigned long long>(region->offset_), static_cast<unsigned long long>(region->offset_),
+                   static_cast<unsigned long long>(region->size_), GatCaptureVerifier::reasonName(region->reason_));
+        }
+        printf("%s: %llu bytes, %llu packets, %llu corrupt regions, %.3f GB/s\n", pathname,
+               static_cast<unsigned long long>(verifier.byteCount()),
+               static_cast<unsigned long long>(verifier.packetCount()),
+               static_cast<unsigned long long>(regions.size()),
+               static_cast<double>(verifier.byteCount()) / nanoseconds);
+
+        if (!regions.empty() && EXIT_SUCCESS == result) { result = EXIT_FAILURE; }
+    }
+
+    return result;
+}
+
+
+/*
+    End of "GatCaptureVerify.cpp"
+*/
@@ -0,0 +1,32 @@
+#-------------------------------------------------
+#
+# GAT capture CRC verifier (console; not part of GatHost): qmake && make && ./GatCaptureVerify <capture>...
+#
+#-------------------------------------------------
+
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = GatCaptureVerify
+TEMPLATE = app
+CONFIG += console thread
+CONFIG -= app_bundle
+
+QMAKE_CXXFLAGS += -std=c++0x -O2
+LIBS += -pthread
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    GatCaptureVerify.cpp \
+    ../GatCaptureVerifier.cpp \
+    ../GatPktCodec.cpp \
+    ../GatCrc16.cpp \
+    ../Defs.cpp
+
+HEADERS += \
+    ../Defs.hpp \
+    ../GatCaptureVerifier.hpp \
+    ../GatPktCodec.hpp \
+    ../GatCrc16.hpp